@@ -5151,7 +5151,7 @@ __ni_suse_addrconf_static(const ni_sysconfig_t *sc, ni_compat_netdev_t *compat)
 						if (ap->family != nh->gateway.ss_family)
 							continue;
 
-						if (ni_address_can_reach(ap, &nh->gateway)) {
+						if (ni_address_can_reach(ap, &nh->gateway, NULL)) {
 							matches++;
 						} else
 						if (ni_sockaddr_is_specified(&ap->peer_addr) &&
@@ -92,6 +92,9 @@ extern int		ni_bridge_del_port(ni_bridge_t *, unsigned int);
 extern int		ni_bridge_del_port_ifname(ni_bridge_t *, const char *);
 extern int		ni_bridge_del_port_ifindex(ni_bridge_t *, unsigned int);
 extern void		ni_bridge_get_port_names(const ni_bridge_t *, ni_string_array_t *);
+extern ni_bridge_port_t *ni_bridge_bind_port(ni_bridge_t *, const ni_netdev_ref_t *, const char *);
+extern ni_bool_t	ni_bridge_unbind_port(ni_bridge_t *, const ni_netdev_ref_t *, const char *);
+extern void		ni_bridge_port_set_info(ni_bridge_port_t *, const ni_bridge_port_t *);
 
 extern ni_bridge_port_t *ni_bridge_port_new(ni_bridge_t *br, const char *ifname, unsigned int ifindex);
 extern ni_bridge_port_t *ni_bridge_port_by_index(const ni_bridge_t *br, unsigned int ifindex);
@@ -152,7 +152,7 @@ struct ni_dbus_object {
 };
 
 typedef void			ni_dbus_async_callback_t(ni_dbus_object_t *proxy,
-					ni_dbus_message_t *reply);
+					ni_dbus_message_t *reply, void *user_data);
 typedef void			ni_dbus_signal_handler_t(ni_dbus_connection_t *connection,
 					ni_dbus_message_t *signal_msg,
 					void *user_data);
@@ -167,6 +167,11 @@ extern ni_dbus_object_t *	ni_dbus_server_find_object_by_handle(ni_dbus_server_t
 extern dbus_bool_t		ni_dbus_server_send_signal(ni_dbus_server_t *server, ni_dbus_object_t *object,
 					const char *interface, const char *signal_name,
 					unsigned int nargs, const ni_dbus_variant_t *args);
+extern dbus_bool_t		ni_dbus_server_send_properties_changed(ni_dbus_server_t *,
+					ni_dbus_object_t *);
+extern void			ni_dbus_server_object_invalidate(ni_dbus_object_t *);
+extern void			ni_dbus_server_enable_property_cache(ni_dbus_server_t *,
+					const ni_dbus_class_t *);
 
 extern dbus_bool_t		ni_dbus_class_is_subclass(const ni_dbus_class_t *sub, const ni_dbus_class_t *super);
 
@@ -371,6 +376,8 @@ extern ni_dbus_object_t *	ni_dbus_client_object_new_child(ni_dbus_object_t *pare
 					const char *interface,
 					void *local_data);
 extern dbus_bool_t		ni_dbus_object_refresh_children(ni_dbus_object_t *);
+extern void			ni_dbus_client_track_properties(ni_dbus_client_t *, ni_dbus_object_t *);
+extern ni_bool_t		ni_dbus_object_is_synced(const ni_dbus_object_t *);
 extern ni_dbus_object_t *	ni_dbus_object_find_child(ni_dbus_object_t *parent, const char *name);
 extern dbus_bool_t		ni_dbus_object_call_variant(const ni_dbus_object_t *,
 					const char *interface, const char *method,
@@ -382,7 +389,22 @@ extern int			ni_dbus_object_call_simple(const ni_dbus_object_t *,
 					int arg_type, void *arg_ptr,
 					int res_type, void *res_ptr);
 extern int			ni_dbus_object_call_async(ni_dbus_object_t *obj,
-					ni_dbus_async_callback_t *callback, const char *method, ...);
+					ni_dbus_async_callback_t *callback, void *user_data,
+					const char *method, ...);
+extern int			ni_dbus_object_call_variant_async(ni_dbus_object_t *,
+					const char *interface, const char *method,
+					unsigned int nargs, const ni_dbus_variant_t *args,
+					ni_dbus_async_callback_t *callback, void *user_data);
+extern ni_dbus_message_t *	ni_dbus_object_call_message_new(const ni_dbus_object_t *,
+					const char *interface, const char *method,
+					DBusError *error);
+extern dbus_bool_t		ni_dbus_object_call_message(const ni_dbus_object_t *,
+					ni_dbus_message_t *call,
+					unsigned int maxres, ni_dbus_variant_t *res,
+					DBusError *error);
+extern int			ni_dbus_object_call_message_async(ni_dbus_object_t *,
+					ni_dbus_message_t *call,
+					ni_dbus_async_callback_t *callback, void *user_data);
 
 extern ni_dbus_message_t *	ni_dbus_object_call_new(const ni_dbus_object_t *, const char *method, ...);
 extern ni_dbus_message_t *	ni_dbus_object_call_new_va(const ni_dbus_object_t *obj,
@@ -434,6 +456,8 @@ extern dbus_bool_t		ni_dbus_xml_validate_argument(const ni_dbus_method_t *, unsi
 						xml_node_t *, const ni_dbus_xml_validate_context_t *);
 extern dbus_bool_t		ni_dbus_xml_serialize_arg(const ni_dbus_method_t *, unsigned int,
 						ni_dbus_variant_t *, xml_node_t *);
+extern dbus_bool_t		ni_dbus_xml_append_arg(const ni_dbus_method_t *, unsigned int,
+						ni_dbus_message_t *, xml_node_t *);
 extern dbus_bool_t		ni_dbus_xml_method_has_return(const ni_dbus_method_t *);
 extern int			ni_dbus_serialize_return(const ni_dbus_method_t *, ni_dbus_variant_t *, xml_node_t *);
 extern void			ni_dbus_serialize_error(DBusError *, xml_node_t *);
@@ -283,6 +283,10 @@ struct ni_ethtool {
 	ni_ethtool_channels_t *		channels;
 	ni_ethtool_coalesce_t *		coalesce;
 	ni_ethtool_pause_t *		pause;
+
+	/* system data cache     */
+	unsigned int			generation;
+	unsigned int			refreshed;
 };
 
 extern ni_ethtool_t *			ni_ethtool_new(void);
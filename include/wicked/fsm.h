@@ -52,6 +52,7 @@ typedef struct ni_ifworker		ni_ifworker_t;
 typedef struct ni_fsm_event		ni_fsm_event_t;
 typedef struct ni_fsm_require		ni_fsm_require_t;
 typedef struct ni_fsm_policy		ni_fsm_policy_t;
+typedef struct ni_fsm_async_call	ni_fsm_async_call_t;
 typedef int				ni_fsm_policy_compare_fn_t(const ni_fsm_policy_t *, const ni_fsm_policy_t *);
 
 typedef struct ni_fsm_policy_array {
@@ -195,6 +196,7 @@ struct ni_ifworker {
 		ni_fsm_transition_t *action_table;
 		const ni_timer_t *timer;
 		const ni_timer_t *secondary_timer;
+		ni_fsm_async_call_t *async_call;
 
 		ni_fsm_require_t *check_state_req_list;
 
@@ -253,6 +255,11 @@ struct ni_fsm {
 	ni_ifworker_array_t	pending;
 	ni_ifworker_array_t	workers;
 	unsigned int		worker_timeout;
+
+	/* ni_fsm_schedule queues */
+	ni_ifworker_array_t	ready;
+	ni_ifworker_array_t	blocked;
+	ni_ifworker_array_t	throttled;
 	ni_bool_t		readonly;
 
 	unsigned int		timeout_count;
@@ -266,6 +273,12 @@ struct ni_fsm {
 	} process_event;
 
 	ni_fsm_policy_t *	policies;
+	ni_fsm_policy_t **	policy_index;
+
+	/* calls placed without waiting for the reply; 0 disables */
+	unsigned int		max_async_calls;
+	unsigned int		num_async_calls;
+	ni_fsm_async_call_t *	async_calls;
 
 	ni_dbus_object_t *	client_root_object;
 };
@@ -301,6 +314,7 @@ extern void			ni_fsm_policy_free(ni_fsm_policy_t *);
 extern ni_bool_t		ni_fsm_policy_update(ni_fsm_policy_t *, xml_node_t *);
 extern ni_bool_t		ni_fsm_policy_remove(ni_fsm_t *, ni_fsm_policy_t *);
 extern ni_fsm_policy_t *	ni_fsm_policy_by_name(const ni_fsm_t *, const char *);
+extern void			ni_fsm_policy_index_destroy(ni_fsm_t *);
 extern int			ni_fsm_policy_compare_weight(const ni_fsm_policy_t *, const ni_fsm_policy_t *);
 extern unsigned int		ni_fsm_policy_get_applicable_policies(const ni_fsm_t *, ni_ifworker_t *,
 						const ni_fsm_policy_t **, unsigned int);
@@ -74,6 +74,7 @@ enum {
 	NI_TRACE_IPV4		= 0x080000,
 	NI_TRACE_ROUTE		= 0x100000,
 	NI_TRACE_WPA		= 0x200000,
+	NI_TRACE_STARTUP	= 0x400000,
 };
 
 extern unsigned int	ni_debug;
@@ -112,6 +113,7 @@ extern unsigned int	ni_log_level;
 #define ni_debug_lldp(fmt, args...)		__ni_debug(NI_LOG_DEBUG, NI_TRACE_LLDP, fmt, ##args)
 #define ni_debug_timer(fmt, args...)		__ni_debug(NI_LOG_DEBUG, NI_TRACE_TIMER, fmt, ##args)
 #define ni_debug_route(fmt, args...)		__ni_debug(NI_LOG_DEBUG, NI_TRACE_ROUTE, fmt, ##args)
+#define ni_debug_startup(fmt, args...)		__ni_debug(NI_LOG_DEBUG, NI_TRACE_STARTUP, fmt, ##args)
 
 #define ni_debug_nanny				ni_debug_application
 
@@ -93,11 +93,14 @@ struct ni_route_array {
 	ni_route_t **		data;
 };
 
+struct ni_route_trie;
+
 struct ni_route_table {
 	ni_route_table_t *	next;
 
 	unsigned int		tid;
 	ni_route_array_t	routes;
+	struct ni_route_trie *	trie;		/* prefix index of routes */
 };
 
 enum {
@@ -266,6 +269,9 @@ extern void			ni_route_array_sort_rev(ni_route_array_t *);
 extern ni_route_table_t *	ni_route_table_new(unsigned int);
 extern void			ni_route_table_free(ni_route_table_t *);
 extern void			ni_route_table_clear(ni_route_table_t *);
+extern ni_route_t *		ni_route_table_remove(ni_route_table_t *, unsigned int);
+extern ni_bool_t		ni_route_table_delete(ni_route_table_t *, unsigned int);
+extern ni_route_t *		ni_route_table_lookup(ni_route_table_t *, const ni_sockaddr_t *);
 
 extern ni_bool_t		ni_route_tables_add_route(ni_route_table_t **, ni_route_t *);
 extern ni_bool_t		ni_route_tables_add_routes(ni_route_table_t **, ni_route_array_t *);
@@ -279,6 +285,7 @@ extern unsigned int		ni_route_tables_find_matches(ni_route_table_t *, const ni_r
 					ni_route_array_t *);
 
 extern ni_route_table_t *	ni_route_tables_find(ni_route_table_t *, unsigned int);
+extern ni_route_t *		ni_route_tables_lookup(ni_route_table_t *, unsigned int, const ni_sockaddr_t *);
 extern ni_bool_t		ni_route_tables_empty(const ni_route_table_t *);
 extern ni_route_table_t *	ni_route_tables_get(ni_route_table_t **, unsigned int);
 extern void			ni_route_tables_destroy(ni_route_table_t **);
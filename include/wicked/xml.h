@@ -55,7 +55,8 @@ struct xml_node {
 	uint16_t		refcount;
 	uint16_t		final : 1;
 
-	char *			name;
+	/* interned, use xml_node_set_name to change it */
+	const char *		name;
 	struct xml_node *	parent;
 
 	/* For now, we assume just a single blob of cdata */
@@ -64,7 +65,16 @@ struct xml_node {
 	ni_var_array_t		attrs;
 	struct xml_node *	children;
 
+	/* last child, number of children and lazy child name index,
+	 * maintained by xml.c */
+	struct xml_node *	last;
+	unsigned int		nchildren;
+	struct xml_node_index *	index;
+
 	xml_location_t *	location;
+
+	/* node storage of arena documents */
+	struct xml_arena *	arena;
 };
 
 typedef struct xml_node_array	xml_node_array_t;
@@ -75,6 +85,7 @@ struct xml_node_array {
 #define XML_NODE_ARRAY_INIT	{ 0, NULL }
 
 extern xml_document_t *	xml_document_read(const char *);
+extern xml_document_t *	xml_document_read_cached(const char *, const char *);
 extern xml_document_t *	xml_document_scan(FILE *, const char *location);
 extern xml_document_t *	xml_document_from_buffer(ni_buffer_t *, const char *location);
 extern xml_document_t *	xml_document_from_string(const char *, const char *location);
@@ -86,6 +97,7 @@ extern int		xml_document_uuid(const xml_document_t *, unsigned int, const ni_uui
 extern const char *	xml_document_dtd(const xml_document_t *);
 
 extern xml_document_t *	xml_document_new();
+extern xml_document_t *	xml_document_new_arena(void);
 extern xml_node_t *	xml_document_root(xml_document_t *);
 extern void		xml_document_set_root(xml_document_t *, xml_node_t *);
 extern xml_node_t *	xml_document_take_root(xml_document_t *);
@@ -110,6 +122,7 @@ extern int		xml_node_content_uuid(const xml_node_t *, unsigned int, const ni_uui
 extern int		xml_node_print_fn(const xml_node_t *, void (*)(const char *, void *), void *);
 extern int		xml_node_print_debug(const xml_node_t *, unsigned int facility);
 extern xml_node_t *	xml_node_scan(FILE *fp, const char *location);
+extern void		xml_node_set_name(xml_node_t *, const char *);
 extern void		xml_node_set_cdata(xml_node_t *, const char *);
 extern void		xml_node_set_int(xml_node_t *, int);
 extern void		xml_node_set_int64(xml_node_t *, int64_t);
@@ -32,8 +32,12 @@
 #include <wicked/wireless.h>
 #include <wicked/modem.h>
 #include "netinfo_priv.h"
+#include "appconfig.h"
+#include "util_priv.h"
 #include "udev-utils.h"
 #include "auto6.h"
+#include "timeline.h"
+#include "ovsdb.h"
 
 enum {
 	OPT_HELP,
@@ -90,9 +94,12 @@ static void		run_interface_server(void);
 static void		discover_state(ni_dbus_server_t *);
 static void		recover_state(const char *filename);
 static void		handle_interface_event(ni_netdev_t *, ni_event_t);
+static void		send_interface_event(ni_netdev_t *, ni_event_t);
+static void		event_coalesce_report(void);
 static void		handle_interface_addr_events(ni_netdev_t *, ni_event_t, const ni_address_t *);
 static void		handle_interface_prefix_events(ni_netdev_t *, ni_event_t, const ni_ipv6_ra_pinfo_t *);
 static void		handle_interface_nduseropt_events(ni_netdev_t *, ni_event_t);
+static void		invalidate_interface_object(ni_netdev_t *);
 static void		handle_rfkill_event(ni_rfkill_type_t, ni_bool_t, void *);
 static void		handle_other_event(ni_event_t);
 #ifdef MODEM
@@ -231,6 +238,8 @@ run_interface_server(void)
 {
 	ni_xs_scope_t *	schema;
 
+	ni_timeline_start();
+
 	dbus_server = ni_objectmodel_create_service();
 	if (!dbus_server)
 		ni_fatal("Cannot create server, giving up.");
@@ -245,6 +254,13 @@ run_interface_server(void)
 	if (schema == NULL)
 		ni_fatal("Cannot initialize objectmodel, giving up.");
 
+	/* netdev changes invalidate the objects, see invalidate_interface_object */
+	ni_dbus_server_enable_property_cache(dbus_server, &ni_objectmodel_netif_class);
+
+	/* monitor ovsdb to discover ovs bridges without ovs-vsctl */
+	if (ni_ovsdb_monitor_open(NULL) < 0)
+		ni_debug_application("ovsdb not available, using ovs-vsctl");
+
 	/* open global RTNL socket to listen for kernel events */
 	if (ni_server_listen_interface_events(handle_interface_event) < 0)
 		ni_fatal("unable to initialize netlink listener");
@@ -282,6 +298,9 @@ run_interface_server(void)
 	if (opt_recover_state)
 		recover_state(opt_state_file);
 
+	ni_timeline_finish();
+	ni_timeline_dump();
+
 #ifdef HAVE_SYSTEMD_SD_DAEMON_H
 	if (opt_systemd) {
 		sd_notify(0, "READY=1");
@@ -299,6 +318,8 @@ run_interface_server(void)
 			ni_fatal("ni_socket_wait failed");
 	}
 
+	event_coalesce_report();
+
 	if (opt_recover_state)
 		ni_objectmodel_save_state(opt_state_file);
 
@@ -316,6 +337,7 @@ discover_udev_netdev_state(ni_netdev_t *dev)
 	if (!dev)
 		return;
 
+	ni_timeline_begin(NI_TIMELINE_DISCOVERY);
 	if (!ni_netdev_device_is_ready(dev)) {
 		if (ni_netdev_device_always_ready(dev))
 			dev->link.ifflags |= NI_IFF_DEVICE_READY;
@@ -324,11 +346,12 @@ discover_udev_netdev_state(ni_netdev_t *dev)
 			dev->link.ifflags |= NI_IFF_DEVICE_READY;
 	}
 
-	/* query ethtool settings which are guarded by ready
-	 * flag (rules processed / already renamed by udev)
-	 * as ethtool is a query by ifname...
+	/* ethtool settings are guarded by ready flag (rules
+	 * processed / already renamed by udev) as ethtool is
+	 * a query by ifname; mark them to be fetched on use.
 	 */
-	ni_system_ethtool_refresh(dev);
+	ni_system_ethtool_invalidate(dev);
+	ni_timeline_end(NI_TIMELINE_DISCOVERY);
 }
 
 void
@@ -340,14 +363,19 @@ discover_state(ni_dbus_server_t *server)
 	ni_modem_t *modem;
 #endif
 
+	ni_timeline_begin(NI_TIMELINE_DISCOVERY);
 	nc = ni_global_state_handle(1);
+	ni_timeline_end(NI_TIMELINE_DISCOVERY);
 	if (nc == NULL)
 		ni_fatal("failed to discover interface state");
 
 	if (server) {
 		for (ifp = ni_netconfig_devlist(nc); ifp; ifp = ifp->next) {
 			discover_udev_netdev_state(ifp);
+
+			ni_timeline_begin(NI_TIMELINE_DBUS);
 			ni_objectmodel_register_netif(server, ifp, NULL);
+			ni_timeline_end(NI_TIMELINE_DBUS);
 			if (!ni_client_state_is_valid(ifp->client_state)) {
 				if (!ni_netdev_load_client_state(ifp))
 					ni_netdev_discover_client_state(ifp);
@@ -379,14 +407,192 @@ recover_state(const char *filename)
 	}
 
 	/* Recover the lease information of all interfaces. */
+	ni_timeline_begin(NI_TIMELINE_RECOVERY);
 	if (!ni_objectmodel_recover_state(filename, prefix_list)) {
+		ni_timeline_end(NI_TIMELINE_RECOVERY);
 		ni_error("unable to recover address configuration state");
 		return;
 	}
+	ni_timeline_end(NI_TIMELINE_RECOVERY);
 
 	/* FIXME: update resolver etc. */
 }
 
+/*
+ * Coalescing of device events: repeated link state events of a device
+ * within the configured window are merged, each event type is signaled
+ * once in the order of its last occurrence.
+ */
+typedef struct event_coalesce_dev	event_coalesce_dev_t;
+
+struct event_coalesce_dev {
+	event_coalesce_dev_t *	next;
+	unsigned int		ifindex;
+	const ni_timer_t *	timer;
+	unsigned int		seq[__NI_EVENT_MAX];
+};
+
+static struct {
+	event_coalesce_dev_t *	devs;
+	unsigned int		seq;
+	unsigned long		received[__NI_EVENT_MAX];
+	unsigned long		emitted[__NI_EVENT_MAX];
+} event_coalesce;
+
+static void
+event_coalesce_report(void)
+{
+	unsigned long received = 0, emitted = 0;
+	unsigned int i;
+
+	for (i = 0; i < __NI_EVENT_MAX; ++i) {
+		if (!event_coalesce.received[i] && !event_coalesce.emitted[i])
+			continue;
+
+		ni_debug_events("%s events: received %lu, emitted %lu",
+				ni_event_type_to_name(i),
+				event_coalesce.received[i],
+				event_coalesce.emitted[i]);
+		received += event_coalesce.received[i];
+		emitted  += event_coalesce.emitted[i];
+	}
+	ni_debug_events("device events: received %lu, emitted %lu", received, emitted);
+}
+
+static unsigned int
+event_coalesce_window(void)
+{
+	return ni_global.config ? ni_global.config->rtnl_event.coalesce_window : 0;
+}
+
+static ni_bool_t
+event_coalesce_type(ni_event_t event)
+{
+	switch (event) {
+	case NI_EVENT_DEVICE_CHANGE:
+	case NI_EVENT_DEVICE_UP:
+	case NI_EVENT_DEVICE_DOWN:
+	case NI_EVENT_LINK_ASSOCIATED:
+	case NI_EVENT_LINK_ASSOCIATION_LOST:
+	case NI_EVENT_LINK_SCAN_UPDATED:
+	case NI_EVENT_LINK_UP:
+	case NI_EVENT_LINK_DOWN:
+	case NI_EVENT_NETWORK_UP:
+	case NI_EVENT_NETWORK_DOWN:
+		return TRUE;
+	default:
+		return FALSE;
+	}
+}
+
+/* a client is waiting for this event, it has to pass unchanged */
+static ni_bool_t
+event_coalesce_filtered(const ni_netdev_t *dev, ni_event_t event)
+{
+	const ni_event_filter_t *efp;
+
+	for (efp = dev->event_filter; efp; efp = efp->next) {
+		if (efp->event_mask & (1 << event))
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static event_coalesce_dev_t **
+event_coalesce_find(unsigned int ifindex)
+{
+	event_coalesce_dev_t **pos, *cd;
+
+	for (pos = &event_coalesce.devs; (cd = *pos); pos = &cd->next) {
+		if (cd->ifindex == ifindex)
+			break;
+	}
+	return pos;
+}
+
+/*
+ * Send the pending events of a device and forget about it
+ */
+static void
+event_coalesce_flush(ni_netdev_t *dev, unsigned int ifindex)
+{
+	event_coalesce_dev_t **pos, *cd;
+	unsigned int i, best, count = 0, merged = 0;
+
+	pos = event_coalesce_find(ifindex);
+	if (!(cd = *pos))
+		return;
+	*pos = cd->next;
+
+	if (cd->timer)
+		ni_timer_cancel(cd->timer);
+
+	for (i = 0; i < __NI_EVENT_MAX; ++i) {
+		if (cd->seq[i])
+			merged++;
+	}
+
+	while (dev) {
+		for (best = __NI_EVENT_MAX, i = 0; i < __NI_EVENT_MAX; ++i) {
+			if (cd->seq[i] && (best == __NI_EVENT_MAX || cd->seq[i] < cd->seq[best]))
+				best = i;
+		}
+		if (best == __NI_EVENT_MAX)
+			break;
+
+		cd->seq[best] = 0;
+		send_interface_event(dev, best);
+		count++;
+	}
+
+	if (dev) {
+		ni_debug_events("%s: sent %u of %u coalesced event types", dev->name,
+				count, merged);
+	}
+	free(cd);
+}
+
+static void
+event_coalesce_timeout(void *user_data, const ni_timer_t *timer)
+{
+	event_coalesce_dev_t *cd = *event_coalesce_find((unsigned long)user_data);
+	ni_netconfig_t *nc = ni_global_state_handle(0);
+
+	if (!cd || cd->timer != timer)
+		return;
+
+	cd->timer = NULL;
+	event_coalesce_flush(nc ? ni_netdev_by_index(nc, cd->ifindex) : NULL, cd->ifindex);
+}
+
+static ni_bool_t
+event_coalesce_queue(ni_netdev_t *dev, ni_event_t event)
+{
+	unsigned int window = event_coalesce_window();
+	event_coalesce_dev_t *cd;
+
+	if (!window || !dev->link.ifindex || !event_coalesce_type(event) ||
+	    event_coalesce_filtered(dev, event)) {
+		/* keep the order of the events */
+		event_coalesce_flush(dev, dev->link.ifindex);
+		return FALSE;
+	}
+
+	if (!(cd = *event_coalesce_find(dev->link.ifindex))) {
+		cd = xcalloc(1, sizeof(*cd));
+		cd->ifindex = dev->link.ifindex;
+		cd->next = event_coalesce.devs;
+		event_coalesce.devs = cd;
+		cd->timer = ni_timer_register(window, event_coalesce_timeout,
+					(void *)(unsigned long)cd->ifindex);
+	}
+
+	if (!++event_coalesce.seq)
+		++event_coalesce.seq;
+	cd->seq[event] = event_coalesce.seq;
+	return TRUE;
+}
+
 /*
  * Handle network layer events for interface server.
  * FIXME: There should be some locking here, which prevents us from
@@ -395,14 +601,30 @@ recover_state(const char *filename)
  */
 void
 handle_interface_event(ni_netdev_t *dev, ni_event_t event)
+{
+	if (event < __NI_EVENT_MAX)
+		event_coalesce.received[event]++;
+
+	if (dbus_server) {
+		invalidate_interface_object(dev);
+		ni_auto6_on_netdev_event(dev, event);
+
+		if (!event_coalesce_queue(dev, event))
+			send_interface_event(dev, event);
+	}
+}
+
+static void
+send_interface_event(ni_netdev_t *dev, ni_event_t event)
 {
 	const ni_uuid_t *event_uuid = NULL;
 
+	if (event < __NI_EVENT_MAX)
+		event_coalesce.emitted[event]++;
+
 	if (dbus_server) {
 		ni_dbus_object_t *object;
 
-		ni_auto6_on_netdev_event(dev, event);
-
 		object = ni_objectmodel_get_netif_object(dbus_server, dev);
 		if (!object && event == NI_EVENT_DEVICE_CREATE) {
 			/* A new netif was discovered or we've created one;
@@ -459,6 +681,7 @@ handle_interface_addr_events(ni_netdev_t *dev, ni_event_t event, const ni_addres
 	ni_addrconf_lease_t *lease, *next;
 
 	ni_server_trace_interface_addr_events(dev, event, ap);
+	invalidate_interface_object(dev);
 
 	if (ap->family != AF_INET6)
 		return;
@@ -495,6 +718,7 @@ static void
 handle_interface_prefix_events(ni_netdev_t *dev, ni_event_t event, const ni_ipv6_ra_pinfo_t *pi)
 {
 	ni_server_trace_interface_prefix_events(dev, event, pi);
+	invalidate_interface_object(dev);
 	ni_auto6_on_prefix_event(dev, event, pi);
 }
 
@@ -502,9 +726,24 @@ static void
 handle_interface_nduseropt_events(ni_netdev_t *dev, ni_event_t event)
 {
 	ni_server_trace_interface_nduseropt_events(dev, event);
+	invalidate_interface_object(dev);
 	ni_auto6_on_nduseropt_events(dev, event);
 }
 
+/*
+ * The netdev changed underneath its dbus object; make sure
+ * GetManagedObjects doesn't reply with cached properties and
+ * the next event broadcasts the changed ones.
+ */
+static void
+invalidate_interface_object(ni_netdev_t *dev)
+{
+	ni_dbus_object_t *object;
+
+	if (dbus_server && (object = ni_objectmodel_get_netif_object(dbus_server, dev)))
+		ni_dbus_server_object_invalidate(object);
+}
+
 static void
 handle_other_event(ni_event_t event)
 {
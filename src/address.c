@@ -331,14 +331,30 @@ ni_address_is_noprefixroute(const ni_address_t *laddr)
 	return laddr->flags & IFA_F_NOPREFIXROUTE;
 }
 
+/*
+ * Check whether gw is on-link: in the prefix of the local address or,
+ * when route tables are given, when the longest prefix match of gw in
+ * one of the tables is a device route (without a gateway).
+ * The local address is optional to check the route tables only.
+ */
 ni_bool_t
-ni_address_can_reach(const ni_address_t *laddr, const ni_sockaddr_t *gw)
+ni_address_can_reach(const ni_address_t *laddr, const ni_sockaddr_t *gw,
+			ni_route_table_t *routes)
 {
-	if (laddr->family != gw->ss_family)
-		return FALSE;
+	ni_route_table_t *tab;
+	ni_route_t *rp;
 
 	/* if (laddr->peer_addr.ss_family != AF_UNSPEC) { ... } */
-	return ni_sockaddr_prefix_match(laddr->prefixlen, &laddr->local_addr, gw);
+	if (laddr && laddr->family == gw->ss_family &&
+	    ni_sockaddr_prefix_match(laddr->prefixlen, &laddr->local_addr, gw))
+		return TRUE;
+
+	for (tab = routes; tab; tab = tab->next) {
+		if ((rp = ni_route_table_lookup(tab, gw)) &&
+		    !ni_sockaddr_is_specified(&rp->nh.gateway))
+			return TRUE;
+	}
+	return FALSE;
 }
 
 void
@@ -72,6 +72,7 @@ typedef struct ni_config_rtnl_event {
 	 */
 	unsigned int	recv_buff_length;
 	unsigned int	mesg_buff_length;
+	unsigned int	coalesce_window;	/* msec, 0 disables */
 } ni_config_rtnl_event_t;
 
 typedef enum {
@@ -95,6 +96,10 @@ typedef struct ni_config_teamd {
 	ni_config_teamd_ctl_t	ctl;
 } ni_config_teamd_t;
 
+typedef struct ni_config_fsm {
+	unsigned int		max_async_calls;
+} ni_config_fsm_t;
+
 typedef enum {
 	NI_CONFIG_DHCP4_ROUTES_CSR,
 	NI_CONFIG_DHCP4_ROUTES_MSCSR,
@@ -197,6 +202,7 @@ typedef struct ni_config {
 
 	ni_config_bonding_t	bonding;
 	ni_config_teamd_t	teamd;
+	ni_config_fsm_t		fsm;
 } ni_config_t;
 
 extern ni_config_t *	ni_config_new();
@@ -220,6 +226,8 @@ extern ni_bool_t	ni_config_teamd_enabled(void);
 extern ni_config_teamd_ctl_t	ni_config_teamd_ctl(void);
 extern const char *	ni_config_teamd_ctl_type_to_name(ni_config_teamd_ctl_t);
 
+extern unsigned int	ni_config_fsm_max_async_calls(void);
+
 extern ni_extension_t *	ni_extension_list_find(ni_extension_t *, const char *);
 extern void		ni_extension_list_destroy(ni_extension_t **);
 extern ni_extension_t *	ni_extension_new(ni_extension_t **, const char *);
@@ -212,6 +212,91 @@ ni_bridge_del_port_ifindex(ni_bridge_t *bridge, unsigned int ifindex)
 	return -1;
 }
 
+/*
+ * Bind/unbind a port discovered via netlink by its ifindex
+ */
+ni_bridge_port_t *
+ni_bridge_bind_port(ni_bridge_t *bridge, const ni_netdev_ref_t *ref, const char *ifname)
+{
+	ni_bridge_port_t *port;
+
+	if (!bridge || !ref || !ref->index || ni_string_empty(ref->name)) {
+		ni_debug_verbose(NI_LOG_DEBUG, NI_TRACE_EVENTS,
+				"%s: bind of bridge port %s[%u] skipped -- invalid args",
+				ifname, ref ? ref->name : NULL, ref ? ref->index : 0);
+		return NULL;
+	}
+
+	if ((port = ni_bridge_port_by_index(bridge, ref->index))) {
+		if (!ni_string_eq(port->ifname, ref->name)) {
+			ni_debug_verbose(NI_LOG_DEBUG2, NI_TRACE_EVENTS,
+					"%s: rebind of bridge port %s[%u] ifname to %s",
+					ifname, port->ifname, port->ifindex, ref->name);
+			ni_string_dup(&port->ifname, ref->name);
+		}
+		return port;
+	}
+
+	port = ni_bridge_port_new(bridge, ref->name, ref->index);
+	ni_debug_verbose(NI_LOG_DEBUG2, NI_TRACE_EVENTS,
+			"%s: bound new bridge port %s[%u]",
+			ifname, port->ifname, port->ifindex);
+	return port;
+}
+
+ni_bool_t
+ni_bridge_unbind_port(ni_bridge_t *bridge, const ni_netdev_ref_t *ref, const char *ifname)
+{
+	if (!bridge || !ref || !ref->index)
+		return FALSE;
+
+	if (ni_bridge_del_port_ifindex(bridge, ref->index) < 0) {
+		ni_debug_verbose(NI_LOG_DEBUG, NI_TRACE_EVENTS,
+				"%s: unbind of bridge port %s[%u] skipped -- port not found",
+				ifname, ref->name, ref->index);
+		return FALSE;
+	}
+
+	ni_debug_verbose(NI_LOG_DEBUG2, NI_TRACE_EVENTS,
+			"%s: unbind of bridge port %s[%u] by ifindex",
+			ifname, ref->name, ref->index);
+	return TRUE;
+}
+
+/*
+ * Apply the port settings and status parsed from the port link info
+ */
+void
+ni_bridge_port_set_info(ni_bridge_port_t *port, const ni_bridge_port_t *info)
+{
+	ni_bridge_port_status_t *ps;
+	const ni_bridge_port_status_t *is;
+
+	if (!port || !info)
+		return;
+
+	port->priority = info->priority;
+	port->path_cost = info->path_cost;
+
+	ps = &port->status;
+	is = &info->status;
+	ps->priority = is->priority;
+	ps->path_cost = is->path_cost;
+	ps->state = is->state;
+	ps->port_id = is->port_id;
+	ps->port_no = is->port_no;
+	ni_string_dup(&ps->designated_root, is->designated_root);
+	ni_string_dup(&ps->designated_bridge, is->designated_bridge);
+	ps->designated_cost = is->designated_cost;
+	ps->designated_port = is->designated_port;
+	ps->change_ack = is->change_ack;
+	ps->hairpin_mode = is->hairpin_mode;
+	ps->config_pending = is->config_pending;
+	ps->hold_timer = is->hold_timer;
+	ps->message_age_timer = is->message_age_timer;
+	ps->forward_delay_timer = is->forward_delay_timer;
+}
+
 void
 ni_bridge_get_port_names(const ni_bridge_t *bridge, ni_string_array_t *names)
 {
@@ -22,6 +22,7 @@
 #include <wicked/dbus-service.h>
 
 #include "client/wicked-client.h"
+#include "util_priv.h"
 
 /*
  * Error context - this is an opaque type.
@@ -42,6 +43,8 @@ struct ni_call_error_context {
 		{ .handler = func, .config = node, .__allocated = NULL }
 
 static void	ni_call_error_context_destroy(ni_call_error_context_t *);
+static int	ni_call_error_context_handle(ni_call_error_context_t *, DBusError *,
+				const ni_dbus_service_t *, const ni_dbus_method_t *);
 
 /*
  * Create the client and return the handle of the root object
@@ -264,23 +267,15 @@ ni_call_identify_modem(const char *namespace, const xml_node_t *query)
  * Create a virtual network interface
  */
 static char *
-ni_call_device_new(const ni_dbus_service_t *service, ni_dbus_variant_t call_argv[2])
+ni_call_device_new(ni_dbus_object_t *object, const ni_dbus_service_t *service,
+			ni_dbus_message_t *call)
 {
 	ni_dbus_variant_t call_resp[1];
 	DBusError error = DBUS_ERROR_INIT;
-	ni_dbus_object_t *object = NULL;
 	char *result = NULL;
 
 	memset(call_resp, 0, sizeof(call_resp));
-	if (!(object = ni_call_get_netif_list_object())) {
-		ni_error("unable to create proxy object for %s", service->name);
-		goto failed;
-	}
-
-	if (!ni_dbus_object_call_variant(object, service->name, "newDevice",
-				2, call_argv,
-				1, call_resp,
-				&error)) {
+	if (!ni_dbus_object_call_message(object, call, 1, call_resp, &error)) {
 		ni_dbus_print_error(&error, "server refused to create interface");
 	} else {
 		const char *response;
@@ -294,7 +289,6 @@ ni_call_device_new(const ni_dbus_service_t *service, ni_dbus_variant_t call_argv
 		}
 	}
 
-failed:
 	ni_dbus_variant_destroy(&call_resp[0]);
 	dbus_error_free(&error);
 	return result;
@@ -304,31 +298,39 @@ char *
 ni_call_device_new_xml(const ni_dbus_service_t *service,
 				const char *ifname, xml_node_t *linkdef)
 {
-	ni_dbus_variant_t call_argv[2];
+	DBusError error = DBUS_ERROR_INIT;
 	const ni_dbus_method_t *method;
+	ni_dbus_object_t *object;
+	ni_dbus_message_t *call;
 	char *result = NULL;
 
-	memset(call_argv, 0, sizeof(call_argv));
+	method = ni_dbus_service_get_method(service, "newDevice");
+	ni_assert(method);
+
+	if (!(object = ni_call_get_netif_list_object())) {
+		ni_error("unable to create proxy object for %s", service->name);
+		return NULL;
+	}
+
+	call = ni_dbus_object_call_message_new(object, service->name, method->name, &error);
+	if (call == NULL) {
+		ni_dbus_print_error(&error, "%s.%s: unable to build call", service->name, method->name);
+		dbus_error_free(&error);
+		return NULL;
+	}
 
 	/* The first argument of the newDevice() call is the requested interface
 	 * name. If there's a name="..." argument on the command line, use that
 	 * (and remove it from the list of arguments) */
-	ni_dbus_variant_set_string(&call_argv[0], "");
-	if (ifname)
-		ni_dbus_variant_set_string(&call_argv[0], ifname);
-
-	method = ni_dbus_service_get_method(service, "newDevice");
-	ni_assert(method);
-
-	if (ni_dbus_xml_serialize_arg(method, 1, &call_argv[1], linkdef)) {
-		result = ni_call_device_new(service, call_argv);
+	if (ni_dbus_message_append_string(call, ifname ? ifname : "") &&
+	    ni_dbus_xml_append_arg(method, 1, call, linkdef)) {
+		result = ni_call_device_new(object, service, call);
 	} else {
 		ni_error("%s.%s: error serializing arguments",
 				service->name, method->name);
 	}
 
-	ni_dbus_variant_destroy(&call_argv[0]);
-	ni_dbus_variant_destroy(&call_argv[1]);
+	dbus_message_unref(call);
 	return result;
 }
 
@@ -351,24 +353,57 @@ ni_call_device_method_common(ni_dbus_object_t *object,
 				argc, argv,
 				1, &result,
 				&error)) {
+		rv = ni_call_error_context_handle(error_ctx, &error, service, method);
+	} else {
+		if (callback_list)
+			*callback_list = ni_objectmodel_callback_info_from_dict(&result);
+		rv = 0;
+	}
 
-		if (error_ctx && error_ctx->handler) {
-			rv = error_ctx->handler(error_ctx, &error);
-			if (rv > 0) {
-				ni_warn("Whaaah. Error context handler returns positive code. "
-					"Assuming programmer mistake");
-				rv = -rv;
-			}
-		} else {
-			ni_dbus_print_error(&error, "%s.%s() failed", service->name, method->name);
-			rv = ni_dbus_get_error(&error, NULL);
-		}
+	ni_dbus_variant_destroy(&result);
+	dbus_error_free(&error);
+	return rv;
+}
+
+/*
+ * Place a call to a device, marshalling the xml config directly into
+ * the call message. Calls ending up here take at most one argument.
+ */
+static int
+ni_call_device_method_marshal(ni_dbus_object_t *object,
+				const ni_dbus_service_t *service, const ni_dbus_method_t *method,
+				xml_node_t *config, ni_objectmodel_callback_info_t **callback_list,
+				ni_call_error_context_t *error_ctx)
+{
+	ni_dbus_variant_t result = NI_DBUS_VARIANT_INIT;
+	DBusError error = DBUS_ERROR_INIT;
+	ni_dbus_message_t *call;
+	int rv = 0;
+
+	call = ni_dbus_object_call_message_new(object, service->name, method->name, &error);
+	if (call == NULL) {
+		rv = ni_call_error_context_handle(error_ctx, &error, service, method);
+		goto out;
+	}
+
+	if (ni_dbus_xml_method_num_args(method) &&
+	    !ni_dbus_xml_append_arg(method, 0, call, config)) {
+		ni_error("%s.%s: error serializing argument", service->name, method->name);
+		rv = -NI_ERROR_CANNOT_MARSHAL;
+		goto out;
+	}
+
+	if (!ni_dbus_object_call_message(object, call, 1, &result, &error)) {
+		rv = ni_call_error_context_handle(error_ctx, &error, service, method);
 	} else {
 		if (callback_list)
 			*callback_list = ni_objectmodel_callback_info_from_dict(&result);
 		rv = 0;
 	}
 
+out:
+	if (call)
+		dbus_message_unref(call);
 	ni_dbus_variant_destroy(&result);
 	dbus_error_free(&error);
 	return rv;
@@ -380,32 +415,10 @@ ni_call_common_xml(ni_dbus_object_t *object, const ni_dbus_service_t *service, c
 			ni_call_error_handler_t *error_handler)
 {
 	ni_call_error_context_t error_context = NI_CALL_ERROR_CONTEXT_INIT(error_handler, config);
-	ni_dbus_variant_t argv[1];
-	int rv, argc;
+	int rv;
 
 retry_operation:
-	memset(argv, 0, sizeof(argv));
-	argc = 0;
-
-	/* Query the xml schema whether the call expects an argument or not.
-	 * All calls that end up here always take at most one argument, which
-	 * would be a dict built from the xml node passed in by the caller. */
-	if (ni_dbus_xml_method_num_args(method)) {
-		ni_dbus_variant_t *dict = &argv[argc++];
-
-		ni_dbus_variant_init_dict(dict);
-		if (config && !ni_dbus_xml_serialize_arg(method, 0, dict, config)) {
-			ni_error("%s.%s: error serializing argument", service->name, method->name);
-			rv = -NI_ERROR_CANNOT_MARSHAL;
-			goto out;
-		}
-	}
-
-	rv = ni_call_device_method_common(object, service, method, argc, argv, callback_list, &error_context);
-
-out:
-	while (argc--)
-		ni_dbus_variant_destroy(&argv[argc]);
+	rv = ni_call_device_method_marshal(object, service, method, config, callback_list, &error_context);
 
 	/* On the first time around, we may have run into a problem and tried to fix
 	 * it up in the error handler. For instance, a wireless passphrase or a
@@ -424,6 +437,124 @@ out:
 	return rv;
 }
 
+/*
+ * Asynchronous variant of ni_call_common_xml. The call is placed and
+ * the result is passed to the callback once the reply has arrived.
+ */
+typedef struct ni_call_async {
+	ni_dbus_object_t *		object;
+	const ni_dbus_service_t *	service;
+	const ni_dbus_method_t *	method;
+	ni_call_error_context_t		error_context;
+
+	ni_call_async_callback_t *	callback;
+	void *				user_data;
+} ni_call_async_t;
+
+static void	ni_call_common_xml_async_reply(ni_dbus_object_t *, ni_dbus_message_t *, void *);
+
+static int
+ni_call_common_xml_async_send(ni_call_async_t *call)
+{
+	DBusError error = DBUS_ERROR_INIT;
+	ni_dbus_message_t *msg;
+	int rv;
+
+	msg = ni_dbus_object_call_message_new(call->object,
+				call->service->name, call->method->name, &error);
+	if (msg == NULL) {
+		ni_dbus_print_error(&error, "%s: unable to call %s()",
+				call->object->path, call->method->name);
+		dbus_error_free(&error);
+		return -NI_ERROR_INVALID_ARGS;
+	}
+
+	if (ni_dbus_xml_method_num_args(call->method) &&
+	    !ni_dbus_xml_append_arg(call->method, 0, msg, call->error_context.config)) {
+		ni_error("%s.%s: error serializing argument",
+				call->service->name, call->method->name);
+		rv = -NI_ERROR_CANNOT_MARSHAL;
+	} else {
+		rv = ni_dbus_object_call_message_async(call->object, msg,
+				ni_call_common_xml_async_reply, call);
+	}
+
+	dbus_message_unref(msg);
+	return rv;
+}
+
+static void
+ni_call_common_xml_async_free(ni_call_async_t *call)
+{
+	ni_call_error_context_destroy(&call->error_context);
+	free(call);
+}
+
+static void
+ni_call_common_xml_async_reply(ni_dbus_object_t *proxy, ni_dbus_message_t *reply, void *user_data)
+{
+	ni_call_async_t *call = user_data;
+	ni_objectmodel_callback_info_t *callback_list = NULL;
+	ni_dbus_variant_t result = NI_DBUS_VARIANT_INIT;
+	DBusError error = DBUS_ERROR_INIT;
+	int rv = 0;
+
+	if (reply == NULL) {
+		dbus_set_error(&error, DBUS_ERROR_FAILED, "dbus: no reply");
+		rv = ni_call_error_context_handle(&call->error_context, &error,
+					call->service, call->method);
+	} else
+	if (dbus_set_error_from_message(&error, reply)) {
+		rv = ni_call_error_context_handle(&call->error_context, &error,
+					call->service, call->method);
+	} else
+	if (ni_dbus_message_get_args_variants(reply, &result, 1) < 0) {
+		ni_error("%s.%s: unable to parse response",
+				call->service->name, call->method->name);
+		rv = -NI_ERROR_CANNOT_MARSHAL;
+	} else {
+		callback_list = ni_objectmodel_callback_info_from_dict(&result);
+	}
+	ni_dbus_variant_destroy(&result);
+	dbus_error_free(&error);
+
+	/* See ni_call_common_xml: the error handler may have fixed up
+	 * the config and asks us to try again */
+	if (rv == -NI_ERROR_RETRY_OPERATION && call->error_context.config) {
+		if ((rv = ni_call_common_xml_async_send(call)) == 0)
+			return;
+	}
+
+	call->callback(rv, callback_list, call->user_data);
+	ni_call_common_xml_async_free(call);
+}
+
+int
+ni_call_common_xml_async(ni_dbus_object_t *object, const ni_dbus_service_t *service,
+			const ni_dbus_method_t *method, xml_node_t *config,
+			ni_call_error_handler_t *error_handler,
+			ni_call_async_callback_t *callback, void *user_data)
+{
+	ni_call_error_context_t error_context = NI_CALL_ERROR_CONTEXT_INIT(error_handler, config);
+	ni_call_async_t *call;
+	int rv;
+
+	if (!object || !service || !method || !callback)
+		return -NI_ERROR_INVALID_ARGS;
+
+	call = xcalloc(1, sizeof(*call));
+	call->object = object;
+	call->service = service;
+	call->method = method;
+	call->error_context = error_context;
+	call->callback = callback;
+	call->user_data = user_data;
+
+	if ((rv = ni_call_common_xml_async_send(call)) < 0)
+		ni_call_common_xml_async_free(call);
+	return rv;
+}
+
 static int
 ni_get_device_method(ni_dbus_object_t *object, const char *method_name, const ni_dbus_service_t **service_ret, const ni_dbus_method_t **method_ret)
 {
@@ -501,9 +632,8 @@ ni_call_set_client_state_scripts(ni_dbus_object_t *object, const ni_client_state
 	ni_dbus_xml_validate_context_t ctx;
 	const ni_dbus_service_t *service;
 	const ni_dbus_method_t *method;
-	ni_dbus_variant_t argv[1];
 	xml_node_t *node;
-	int rv, argc;
+	int rv;
 
 	if ((rv = ni_get_device_method(object, "setClientScripts", &service, &method)) < 0)
 		return rv;
@@ -515,24 +645,7 @@ ni_call_set_client_state_scripts(ni_dbus_object_t *object, const ni_client_state
 		return -NI_ERROR_DOCUMENT_ERROR;
 	}
 
-	argc = 0;
-	memset(argv, 0, sizeof(argv));
-	if (ni_dbus_xml_method_num_args(method)) {
-		ni_dbus_variant_t *dict = &argv[argc++];
-
-		ni_dbus_variant_init_dict(dict);
-		if (node && !ni_dbus_xml_serialize_arg(method, 0, dict, node)) {
-			ni_error("%s.%s: error serializing argument", service->name, method->name);
-			rv = -NI_ERROR_CANNOT_MARSHAL;
-			goto out;
-		}
-	}
-
-	rv = ni_call_device_method_common(object, service, method, argc, argv, NULL, NULL);
-out:
-	while (argc--)
-		ni_dbus_variant_destroy(&argv[argc]);
-	return rv;
+	return ni_call_device_method_marshal(object, service, method, node, NULL, NULL);
 }
 
 /*
@@ -610,6 +723,29 @@ ni_call_error_context_destroy(ni_call_error_context_t *error_context)
 	error_context->__allocated = NULL;
 }
 
+/*
+ * Pass a call error to the error context handler, if any
+ */
+static int
+ni_call_error_context_handle(ni_call_error_context_t *error_ctx, DBusError *error,
+			const ni_dbus_service_t *service, const ni_dbus_method_t *method)
+{
+	int rv;
+
+	if (error_ctx && error_ctx->handler) {
+		rv = error_ctx->handler(error_ctx, error);
+		if (rv > 0) {
+			ni_warn("Whaaah. Error context handler returns positive code. "
+				"Assuming programmer mistake");
+			rv = -rv;
+		}
+	} else {
+		ni_dbus_print_error(error, "%s.%s() failed", service->name, method->name);
+		rv = ni_dbus_get_error(error, NULL);
+	}
+	return rv;
+}
+
 /*
  * Count the number of times the server returns the same error code.
  * This is used by the auth info code when retrieving missing user names,
@@ -328,6 +328,7 @@ void
 ni_capture_arm_retransmit(ni_capture_t *capture)
 {
 	ni_timeout_arm(&capture->retrans.deadline, &capture->retrans.timeout);
+	ni_socket_refresh(capture->sock);
 }
 
 void
@@ -335,6 +336,7 @@ ni_capture_disarm_retransmit(ni_capture_t *capture)
 {
 	/* Clear retransmit timer, buffer, and everything else */
 	memset(&capture->retrans, 0, sizeof(capture->retrans));
+	ni_socket_refresh(capture->sock);
 }
 
 void
@@ -345,6 +347,7 @@ ni_capture_force_retransmit(ni_capture_t *capture, unsigned int delay)
 
 		ni_timer_get_time(deadline);
 		deadline->tv_sec += delay;
+		ni_socket_refresh(capture->sock);
 	}
 }
 
@@ -51,6 +51,7 @@ static ni_bool_t	ni_config_parse_sources(ni_config_t *, xml_node_t *);
 static ni_bool_t	ni_config_parse_rtnl_event(ni_config_rtnl_event_t *, xml_node_t *);
 static ni_bool_t	ni_config_parse_bonding(ni_config_bonding_t *, const xml_node_t *);
 static ni_bool_t	ni_config_parse_teamd(ni_config_teamd_t *, const xml_node_t *);
+static ni_bool_t	ni_config_parse_fsm(ni_config_fsm_t *, const xml_node_t *);
 static ni_c_binding_t *	ni_c_binding_new(ni_c_binding_t **, const char *name, const char *lib, const char *symbol);
 static const char *	ni_config_build_include(char *, size_t, const char *, const char *);
 static unsigned int	ni_config_addrconf_update_mask_all(void);
@@ -89,6 +90,7 @@ ni_config_new()
 
 	conf->rtnl_event.recv_buff_length = 1024 * 1024;
 	conf->rtnl_event.mesg_buff_length = 0;
+	conf->rtnl_event.coalesce_window = 0;
 
 	/* we enable it explicitly in wickedd only */
 	conf->teamd.enabled = FALSE;
@@ -419,6 +421,10 @@ __ni_config_parse(ni_config_t *conf, const char *filename, ni_init_appdata_callb
 		if (strcmp(child->name, "teamd") == 0) {
 			if (!ni_config_parse_teamd(&conf->teamd, child))
 				goto failed;
+		} else
+		if (strcmp(child->name, "fsm") == 0) {
+			if (!ni_config_parse_fsm(&conf->fsm, child))
+				goto failed;
 		}
 		if (cb != NULL) {
 			if (!cb(appdata, child))
@@ -1550,6 +1556,10 @@ ni_config_parse_rtnl_event(ni_config_rtnl_event_t *conf, xml_node_t *node)
 		if (ni_string_eq(child->name, "message-buffer-length")) {
 			if (ni_parse_uint(child->cdata, &conf->mesg_buff_length, 0))
 				return FALSE;
+		} else
+		if (ni_string_eq(child->name, "coalesce-window")) {
+			if (ni_parse_uint(child->cdata, &conf->coalesce_window, 0))
+				return FALSE;
 		}
 	}
 	return TRUE;
@@ -1705,6 +1715,35 @@ ni_config_parse_teamd(ni_config_teamd_t *conf, const xml_node_t *node)
 	return TRUE;
 }
 
+/*
+ * client fsm config options
+ */
+unsigned int
+ni_config_fsm_max_async_calls(void)
+{
+	return ni_global.config ? ni_global.config->fsm.max_async_calls : 0;
+}
+
+static ni_bool_t
+ni_config_parse_fsm(ni_config_fsm_t *conf, const xml_node_t *node)
+{
+	const xml_node_t *child;
+
+	if (!conf || !node)
+		return FALSE;
+
+	for (child = node->children; child; child = child->next) {
+		if (ni_string_eq(child->name, "max-async-calls")) {
+			if (ni_parse_uint(child->cdata, &conf->max_async_calls, 10) < 0) {
+				ni_error("%s: invalid <fsm><max-async-calls>%s</max-async-calls></fsm> option",
+						xml_node_location(child), child->cdata);
+				return FALSE;
+			}
+		}
+	}
+	return TRUE;
+}
+
 /*
  * Extension handling
  */
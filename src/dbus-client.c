@@ -24,11 +24,13 @@ struct ni_dbus_client {
 	char *			bus_name;
 	unsigned int		call_timeout;
 	const ni_intmap_t *	error_map;
+	ni_bool_t		track_properties;
 };
 
 struct ni_dbus_client_object {
 	ni_dbus_client_t *	client;
 	char *			default_interface;
+	ni_bool_t		synced;		/* kept up to date by PropertiesChanged */
 };
 
 
@@ -224,6 +226,99 @@ ni_dbus_client_add_signal_handler(ni_dbus_client_t *client,
 					callback, user_data);
 }
 
+/*
+ * Apply org.freedesktop.DBus.Properties.PropertiesChanged deltas
+ * to proxy objects refreshed via GetManagedObjects before.
+ * When a delta cannot be applied, the object is marked as not in
+ * sync any more and needs to be refreshed again.
+ */
+static void
+__ni_dbus_client_properties_changed(ni_dbus_connection_t *connection, ni_dbus_message_t *msg, void *user_data)
+{
+	ni_dbus_variant_t argv[3] = {
+		NI_DBUS_VARIANT_INIT, NI_DBUS_VARIANT_INIT, NI_DBUS_VARIANT_INIT
+	};
+	const char *path = dbus_message_get_path(msg);
+	const char *member = dbus_message_get_member(msg);
+	ni_dbus_object_t *root = user_data, *proxy;
+	const ni_dbus_property_t *property;
+	const ni_dbus_service_t *service;
+	ni_dbus_client_object_t *cob;
+	const char *service_name;
+	unsigned int i;
+	int argc;
+
+	if (!ni_string_eq(member, "PropertiesChanged"))
+		return;
+
+	if (!path || !ni_dbus_object_get_relative_path(root, path))
+		return;
+
+	if (!(proxy = ni_dbus_object_lookup(root, path)) || !(cob = proxy->client_object) || !cob->synced)
+		return;
+
+	argc = ni_dbus_message_get_args_variants(msg, argv, 3);
+	if (argc != 3 || !ni_dbus_variant_get_string(&argv[0], &service_name) ||
+	    !ni_dbus_variant_is_dict(&argv[1]) || !ni_dbus_variant_is_string_array(&argv[2]))
+		goto unsynced;
+
+	/* removed properties would need a reset of the local object */
+	if (argv[2].array.len)
+		goto unsynced;
+
+	if (!(service = ni_dbus_object_get_service(proxy, service_name)))
+		goto unsynced;
+
+	for (i = 0; i < argv[1].array.len; ++i) {
+		const ni_dbus_dict_entry_t *entry = &argv[1].dict_array_value[i];
+
+		/* dict properties without setter are merged key by key */
+		property = __ni_dbus_service_get_property(service->properties, entry->key);
+		if (property && !property->set)
+			goto unsynced;
+
+		__ni_dbus_object_refresh_property(proxy, service, service->properties,
+						entry->key, &entry->datum);
+	}
+
+	ni_debug_dbus("%s: applied %u %s property changes", path, argv[1].array.len, service_name);
+	goto done;
+
+unsynced:
+	ni_debug_dbus("%s: unable to apply property changes, object needs refresh", path);
+	cob->synced = FALSE;
+done:
+	for (i = 0; i < 3; ++i)
+		ni_dbus_variant_destroy(&argv[i]);
+}
+
+/*
+ * Subscribe to property change signals for objects below root
+ */
+void
+ni_dbus_client_track_properties(ni_dbus_client_t *client, ni_dbus_object_t *root)
+{
+	if (!client || !root || client->track_properties)
+		return;
+
+	ni_dbus_client_add_signal_handler(client, client->bus_name, NULL,
+					NI_DBUS_INTERFACE ".Properties",
+					__ni_dbus_client_properties_changed,
+					root);
+	client->track_properties = TRUE;
+}
+
+/*
+ * Returns true, when the proxy is a up to date copy of the object
+ */
+ni_bool_t
+ni_dbus_object_is_synced(const ni_dbus_object_t *proxy)
+{
+	ni_dbus_client_object_t *cob;
+
+	return proxy && (cob = proxy->client_object) && cob->synced;
+}
+
 /*
  * Proxy objects, and calling through proxies
  */
@@ -351,17 +446,18 @@ out:
 	return rv;
 }
 
-dbus_bool_t
-ni_dbus_object_call_variant(const ni_dbus_object_t *proxy,
+/*
+ * Build a method call message for the proxy, looking up the most specific
+ * interface providing the method unless one has been given.
+ * The caller appends the arguments.
+ */
+ni_dbus_message_t *
+ni_dbus_object_call_message_new(const ni_dbus_object_t *proxy,
 					const char *interface_name, const char *method,
-					unsigned int nargs, const ni_dbus_variant_t *args,
-					unsigned int maxres, ni_dbus_variant_t *res,
 					DBusError *error)
 {
-	ni_dbus_message_t *call = NULL, *reply = NULL;
+	ni_dbus_message_t *call;
 	ni_dbus_client_t *client;
-	dbus_bool_t rv = FALSE;
-	int nres;
 
 	if (!interface_name) {
 		const ni_dbus_service_t **pos, *service, *best = NULL;
@@ -385,7 +481,7 @@ ni_dbus_object_call_variant(const ni_dbus_object_t *proxy,
 					dbus_set_error(error, DBUS_ERROR_UNKNOWN_METHOD,
 							"%s: several dbus interfaces provide method %s",
 							proxy->path, method);
-					return FALSE;
+					return NULL;
 				}
 			}
 		}
@@ -401,30 +497,70 @@ ni_dbus_object_call_variant(const ni_dbus_object_t *proxy,
 		dbus_set_error(error, DBUS_ERROR_UNKNOWN_METHOD,
 				"%s: no registered dbus interface provides method %s",
 				proxy->path, method);
-		return FALSE;
+		return NULL;
 	}
 
 	if (!proxy || !(client = ni_dbus_object_get_client(proxy)) || !interface_name) {
 		dbus_set_error(error, DBUS_ERROR_INVALID_ARGS, "%s: bad proxy object", __FUNCTION__);
-		return FALSE;
+		return NULL;
 	}
 
 	NI_TRACE_ENTER_ARGS("%s, if=%s, method=%s", proxy->path, interface_name, method);
 	call = dbus_message_new_method_call(client->bus_name, proxy->path, interface_name, method);
 	if (call == NULL) {
 		dbus_set_error(error, DBUS_ERROR_FAILED, "%s: unable to build %s() message", __FUNCTION__, method);
-		goto out;
+		return NULL;
 	}
 
-	if (nargs && !ni_dbus_message_serialize_variants(call, nargs, args, error))
-		goto out;
+	return call;
+}
+
+static ni_dbus_message_t *
+__ni_dbus_object_call_variant_new(const ni_dbus_object_t *proxy,
+					const char *interface_name, const char *method,
+					unsigned int nargs, const ni_dbus_variant_t *args,
+					DBusError *error)
+{
+	ni_dbus_message_t *call;
+
+	call = ni_dbus_object_call_message_new(proxy, interface_name, method, error);
+	if (call == NULL)
+		return NULL;
+
+	if (nargs && !ni_dbus_message_serialize_variants(call, nargs, args, error)) {
+		dbus_message_unref(call);
+		return NULL;
+	}
+
+	return call;
+}
+
+/*
+ * Send a method call message built by ni_dbus_object_call_message_new
+ * and wait for the reply. The message is not consumed.
+ */
+dbus_bool_t
+ni_dbus_object_call_message(const ni_dbus_object_t *proxy, ni_dbus_message_t *call,
+					unsigned int maxres, ni_dbus_variant_t *res,
+					DBusError *error)
+{
+	ni_dbus_message_t *reply = NULL;
+	ni_dbus_client_t *client;
+	dbus_bool_t rv = FALSE;
+	int nres;
+
+	if (!(client = ni_dbus_object_get_client(proxy))) {
+		dbus_set_error(error, DBUS_ERROR_INVALID_ARGS, "%s: bad proxy object", __FUNCTION__);
+		return FALSE;
+	}
 
 	if ((reply = ni_dbus_client_call(client, call, error)) == NULL)
 		goto out;
 
 	nres = ni_dbus_message_get_args_variants(reply, res, maxres);
 	if (nres < 0) {
-		dbus_set_error(error, DBUS_ERROR_FAILED, "%s: unable to parse %s() response", __func__, method);
+		dbus_set_error(error, DBUS_ERROR_FAILED, "%s: unable to parse %s() response",
+				__func__, dbus_message_get_member(call));
 		goto out;
 	}
 
@@ -433,19 +569,38 @@ ni_dbus_object_call_variant(const ni_dbus_object_t *proxy,
 	rv = TRUE;
 
 out:
-	if (call)
-		dbus_message_unref(call);
 	if (reply)
 		dbus_message_unref(reply);
 	return rv;
 }
 
+dbus_bool_t
+ni_dbus_object_call_variant(const ni_dbus_object_t *proxy,
+					const char *interface_name, const char *method,
+					unsigned int nargs, const ni_dbus_variant_t *args,
+					unsigned int maxres, ni_dbus_variant_t *res,
+					DBusError *error)
+{
+	ni_dbus_message_t *call;
+	dbus_bool_t rv;
+
+	call = __ni_dbus_object_call_variant_new(proxy, interface_name, method,
+					nargs, args, error);
+	if (call == NULL)
+		return FALSE;
+
+	rv = ni_dbus_object_call_message(proxy, call, maxres, res, error);
+	dbus_message_unref(call);
+	return rv;
+}
+
 /*
  * Asynchronous dbus calls
  */
 int
 ni_dbus_object_call_async(ni_dbus_object_t *proxy,
-			ni_dbus_async_callback_t *callback, const char *method, ...)
+			ni_dbus_async_callback_t *callback, void *user_data,
+			const char *method, ...)
 {
 	ni_dbus_client_t *client = ni_dbus_object_get_client(proxy);
 	ni_dbus_message_t *call = NULL;
@@ -463,13 +618,58 @@ ni_dbus_object_call_async(ni_dbus_object_t *proxy,
 	} else {
 		rv = ni_dbus_connection_call_async(client->connection,
 			call, client->call_timeout,
-			callback, proxy);
+			callback, proxy, user_data);
 		dbus_message_unref(call);
 	}
 
 	return rv;
 }
 
+/*
+ * Asynchronous counterpart of ni_dbus_object_call_message.
+ * The callback receives the reply message, which may be an error.
+ */
+int
+ni_dbus_object_call_message_async(ni_dbus_object_t *proxy, ni_dbus_message_t *call,
+			ni_dbus_async_callback_t *callback, void *user_data)
+{
+	ni_dbus_client_t *client;
+
+	if (!(client = ni_dbus_object_get_client(proxy)))
+		return -NI_ERROR_INVALID_ARGS;
+
+	return ni_dbus_connection_call_async(client->connection,
+			call, client->call_timeout,
+			callback, proxy, user_data);
+}
+
+/*
+ * Asynchronous counterpart of ni_dbus_object_call_variant.
+ * The callback receives the reply message, which may be an error.
+ */
+int
+ni_dbus_object_call_variant_async(ni_dbus_object_t *proxy,
+			const char *interface_name, const char *method,
+			unsigned int nargs, const ni_dbus_variant_t *args,
+			ni_dbus_async_callback_t *callback, void *user_data)
+{
+	ni_dbus_message_t *call;
+	DBusError error = DBUS_ERROR_INIT;
+	int rv;
+
+	call = __ni_dbus_object_call_variant_new(proxy, interface_name, method,
+					nargs, args, &error);
+	if (call == NULL) {
+		ni_dbus_print_error(&error, "%s: unable to call %s()", proxy->path, method);
+		dbus_error_free(&error);
+		return -NI_ERROR_INVALID_ARGS;
+	}
+
+	rv = ni_dbus_object_call_message_async(proxy, call, callback, user_data);
+	dbus_message_unref(call);
+	return rv;
+}
+
 /*
  * Use ObjectManager.GetManagedObjects to retrieve (part of)
  * the server's object hierarchy
@@ -541,6 +741,8 @@ ni_dbus_object_get_managed_objects(ni_dbus_object_t *proxy, DBusError *error, ni
 			goto bad_reply;
 
 		descendant->stale = FALSE;
+		if (descendant->client_object)
+			descendant->client_object->synced = client->track_properties;
 	}
 
 	if (purge)
@@ -29,6 +29,10 @@ extern dbus_bool_t		ni_dbus_message_iter_append_value(DBusMessageIter *iter,
 					const char *signature);
 extern dbus_bool_t		ni_dbus_message_iter_append_variant(DBusMessageIter *iter,
 					const ni_dbus_variant_t *variant);
+extern dbus_bool_t		ni_dbus_message_iter_append_dict_entry(DBusMessageIter *iter,
+					const ni_dbus_dict_entry_t *entry);
+extern dbus_bool_t		ni_dbus_message_iter_append_dict(DBusMessageIter *iter,
+					const ni_dbus_dict_entry_t *dict_array, unsigned int len);
 extern dbus_bool_t		ni_dbus_message_iter_get_variant(DBusMessageIter *iter,
 					ni_dbus_variant_t *variant);
 extern dbus_bool_t		ni_dbus_message_iter_append_byte_array(DBusMessageIter *iter,
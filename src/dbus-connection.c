@@ -28,6 +28,7 @@ struct ni_dbus_async_client_call {
 	DBusPendingCall *	call;
 	ni_dbus_async_callback_t *callback;
 	ni_dbus_object_t *	proxy;
+	void *			user_data;
 };
 
 typedef struct ni_dbus_async_server_call ni_dbus_async_server_call_t;
@@ -260,7 +261,7 @@ static void
 ni_dbus_connection_add_pending(ni_dbus_connection_t *connection,
 			DBusPendingCall *call,
 			ni_dbus_async_callback_t *callback,
-			ni_dbus_object_t *proxy)
+			ni_dbus_object_t *proxy, void *user_data)
 {
 	ni_dbus_async_client_call_t *async;
 
@@ -268,6 +269,7 @@ ni_dbus_connection_add_pending(ni_dbus_connection_t *connection,
 	async->proxy = proxy;
 	async->call = call;
 	async->callback = callback;
+	async->user_data = user_data;
 
 	async->next = connection->async_client_calls;
 	connection->async_client_calls = async;
@@ -290,7 +292,7 @@ __ni_dbus_process_pending(ni_dbus_connection_t *dbc, DBusPendingCall *call)
 	for (pos = &dbc->async_client_calls; (async = *pos) != NULL; pos = &async->next) {
 		if (async->call == call) {
 			*pos = async->next;
-			async->callback(async->proxy, msg);
+			async->callback(async->proxy, msg, async->user_data);
 			__ni_dbus_async_client_call_free(async);
 			rv = 1;
 			break;
@@ -362,7 +364,8 @@ ni_dbus_connection_call(ni_dbus_connection_t *connection,
 int
 ni_dbus_connection_call_async(ni_dbus_connection_t *connection,
 			ni_dbus_message_t *call, unsigned int timeout,
-			ni_dbus_async_callback_t *callback, ni_dbus_object_t *proxy)
+			ni_dbus_async_callback_t *callback, ni_dbus_object_t *proxy,
+			void *user_data)
 {
 	DBusPendingCall *pending;
 
@@ -375,7 +378,7 @@ ni_dbus_connection_call_async(ni_dbus_connection_t *connection,
 		return -NI_ERROR_DBUS_CALL_FAILED;
 	}
 
-	ni_dbus_connection_add_pending(connection, pending, callback, proxy);
+	ni_dbus_connection_add_pending(connection, pending, callback, proxy, user_data);
 	dbus_pending_call_set_notify(pending, __ni_dbus_notify_async, connection, NULL);
 
 	return 0;
@@ -1218,6 +1218,12 @@ ni_objectmodel_send_netif_event(ni_dbus_server_t *server, ni_dbus_object_t *obje
 		return FALSE;
 	}
 
+	/* let clients update their proxy before they see the event */
+	if (ifevent != NI_EVENT_DEVICE_DELETE) {
+		ni_dbus_server_object_invalidate(object);
+		ni_dbus_server_send_properties_changed(server, object);
+	}
+
 	return __ni_objectmodel_device_event(server, object, NI_OBJECTMODEL_NETIF_INTERFACE, ifevent, uuid);
 }
 
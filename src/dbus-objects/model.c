@@ -21,6 +21,7 @@
 #include <wicked/logging.h>
 #include <wicked/xml.h>
 #include <wicked/dbus-errors.h>
+#include <wicked/dbus-service.h>
 #include "util_priv.h"
 #include "dbus-common.h"
 #include "xml-schema.h"
@@ -29,6 +30,7 @@
 #include "debug.h"
 #include "dbus-connection.h"
 #include "process.h"
+#include "timeline.h"
 
 extern ni_dbus_object_t *	ni_objectmodel_new_interface(ni_dbus_server_t *server,
 					const ni_dbus_service_t *service,
@@ -79,7 +81,9 @@ ni_xs_scope_t *
 ni_objectmodel_init(ni_dbus_server_t *server)
 {
 	if (__ni_objectmodel_schema == NULL) {
+		ni_timeline_begin(NI_TIMELINE_SCHEMA);
 		__ni_objectmodel_schema = ni_server_dbus_xml_schema();
+		ni_timeline_end(NI_TIMELINE_SCHEMA);
 		if (__ni_objectmodel_schema == NULL)
 			ni_fatal("Giving up.");
 
@@ -95,13 +99,17 @@ ni_objectmodel_init(ni_dbus_server_t *server)
 		 * the config file.
 		 */
 		if (server) {
+			ni_timeline_begin(NI_TIMELINE_DBUS);
 			ni_objectmodel_create_initial_objects(server);
+			ni_timeline_end(NI_TIMELINE_DBUS);
 
 			ni_objectmodel_register_ns_dynamic();
 		}
 
 		/* Bind all extensions */
+		ni_timeline_begin(NI_TIMELINE_EXTENSIONS);
 		ni_objectmodel_bind_extensions();
+		ni_timeline_end(NI_TIMELINE_EXTENSIONS);
 	}
 
 	return __ni_objectmodel_schema;
@@ -410,9 +418,56 @@ static ni_dbus_method_t		ni_objectmodel_netif_root_signals[] = {
 	{ NULL }
 };
 
+/*
+ * Startup timeline of the server; a dict of phases with the
+ * number of runs and the usec spent, first started and last
+ * finished relative to the server start.
+ */
+static dbus_bool_t
+ni_objectmodel_root_get_startup_timeline(const ni_dbus_object_t *object,
+				const ni_dbus_property_t *property,
+				ni_dbus_variant_t *result,
+				DBusError *error)
+{
+	const ni_timeline_stats_t *stats;
+	ni_dbus_variant_t *dict;
+	unsigned int type;
+
+	if (!ni_timeline_finished())
+		return ni_dbus_error_property_not_present(error, object->path, property->name);
+
+	ni_dbus_variant_init_dict(result);
+	ni_dbus_dict_add_uint64(result, "total", ni_timeline_total());
+	for (type = 0; type < __NI_TIMELINE_MAX; ++type) {
+		if (!(stats = ni_timeline_get_stats(type)) || !stats->count)
+			continue;
+
+		if (!(dict = ni_dbus_dict_add(result, ni_timeline_phase_name(type))))
+			return FALSE;
+
+		ni_dbus_variant_init_dict(dict);
+		ni_dbus_dict_add_uint32(dict, "count", stats->count);
+		ni_dbus_dict_add_uint64(dict, "elapsed", stats->elapsed);
+		ni_dbus_dict_add_uint64(dict, "first", stats->first);
+		ni_dbus_dict_add_uint64(dict, "last", stats->last);
+	}
+	return TRUE;
+}
+
+static ni_dbus_property_t	ni_objectmodel_netif_root_properties[] = {
+	{
+		.name		= "startupTimeline",
+		.signature	= NI_DBUS_DICT_SIGNATURE,
+		.get		= ni_objectmodel_root_get_startup_timeline,
+	},
+
+	{ NULL }
+};
+
 static ni_dbus_service_t	ni_objectmodel_netif_root_interface = {
 	.name		= NI_OBJECTMODEL_INTERFACE,
 	.signals	= ni_objectmodel_netif_root_signals,
+	.properties	= ni_objectmodel_netif_root_properties,
 };
 
 /*
@@ -11,6 +11,7 @@
 #include <wicked/logging.h>
 #include <wicked/dbus-service.h>
 #include <wicked/dbus-errors.h>
+#include "dbus-common.h"
 #include "dbus-server.h"
 #include "dbus-object.h"
 #include "dbus-dict.h"
@@ -18,8 +19,24 @@
 #include "util_priv.h"
 
 
+typedef struct ni_dbus_property_digest {
+	const ni_dbus_service_t *service;
+	char *			name;
+	uint64_t		digest;
+	ni_bool_t		seen;
+	ni_bool_t		dirty;			/* service marker only */
+} ni_dbus_property_digest_t;
+
 struct ni_dbus_server_object {
 	ni_dbus_server_t *	server;			/* back pointer at server */
+
+	/* digests of the properties clients have seen last */
+	unsigned int		digest_count;
+	ni_dbus_property_digest_t *digests;
+
+	/* interface -> properties dict GetManagedObjects replies with */
+	ni_bool_t		cached;
+	ni_dbus_variant_t	cache;
 };
 
 static const ni_dbus_class_t	dbus_root_object_class = {
@@ -29,9 +46,15 @@ static const ni_dbus_class_t	dbus_root_object_class = {
 struct ni_dbus_server {
 	ni_dbus_connection_t *	connection;
 	ni_dbus_object_t *	root_object;
+
+	/* class of objects to cache GetManagedObjects properties for */
+	const ni_dbus_class_t *	cache_class;
 };
 
 static dbus_bool_t		ni_dbus_object_register_object_manager(ni_dbus_object_t *);
+static void			__ni_dbus_server_object_record_properties(ni_dbus_object_t *,
+					const ni_dbus_service_t *, const ni_dbus_variant_t *);
+static void			__ni_dbus_server_object_drop_cache(ni_dbus_object_t *);
 static dbus_bool_t		ni_dbus_object_register_introspectable_interface(ni_dbus_object_t *);
 static const char *		__ni_dbus_server_root_path(const char *);
 static void			__ni_dbus_server_object_init(ni_dbus_object_t *object, ni_dbus_server_t *server);
@@ -106,6 +129,7 @@ __ni_dbus_server_object_init(ni_dbus_object_t *object, ni_dbus_server_t *server)
 
 		object->server_object = calloc(1, sizeof(ni_dbus_server_object_t));
 		object->server_object->server = server;
+		ni_dbus_variant_init_dict(&object->server_object->cache);
 
 		if (object->path) {
 			ni_dbus_connection_register_object(server->connection, object);
@@ -145,6 +169,10 @@ ni_dbus_server_send_signal(ni_dbus_server_t *server, ni_dbus_object_t *object,
 	if (svc && !(method = ni_dbus_service_get_signal(svc, signal_name)))
 		ni_warn("%s: unknown signal %s", __func__, signal_name);
 
+	/* the signal is about a change of this object */
+	if (!ni_string_eq(signal_name, "PropertiesChanged"))
+		__ni_dbus_server_object_drop_cache(object);
+
 	msg = dbus_message_new_signal(object->path, interface, signal_name);
 	if (msg == NULL) {
 		ni_error("%s: unable to build %s() signal message", __func__, signal_name);
@@ -189,11 +217,419 @@ __ni_dbus_server_object_destroy(ni_dbus_object_t *object)
 		ni_dbus_connection_unregister_object(server->connection, object);
 
 	if (object->server_object) {
-		free(object->server_object);
+		ni_dbus_server_object_t *sob = object->server_object;
+
+		while (sob->digest_count--)
+			ni_string_free(&sob->digests[sob->digest_count].name);
+		free(sob->digests);
+		ni_dbus_variant_destroy(&sob->cache);
+		free(sob);
 		object->server_object = NULL;
 	}
 }
 
+/*
+ * Property change tracking.
+ *
+ * When clients fetch the properties of a service the first time
+ * (GetManagedObjects, GetAll), we remember a digest of each value.
+ * Changes mark the services dirty; ni_dbus_server_send_properties_changed
+ * then gets the properties of the dirty services clients have fetched
+ * only and broadcasts the ones differing from the digests in an
+ * org.freedesktop.DBus.Properties PropertiesChanged signal, so clients
+ * can update their proxies instead of fetching the whole object again.
+ */
+#define NI_DBUS_DIGEST_INIT		0xcbf29ce484222325ULL
+#define NI_DBUS_DIGEST_PRIME		0x100000001b3ULL
+
+static uint64_t
+__ni_dbus_digest_bytes(uint64_t digest, const void *data, size_t len)
+{
+	const unsigned char *ptr = data;
+
+	while (len--) {
+		digest ^= *ptr++;
+		digest *= NI_DBUS_DIGEST_PRIME;
+	}
+	return digest;
+}
+
+static uint64_t
+__ni_dbus_digest_string(uint64_t digest, const char *str)
+{
+	return __ni_dbus_digest_bytes(digest, str ? str : "", ni_string_len(str) + 1);
+}
+
+static uint64_t
+__ni_dbus_variant_digest(uint64_t digest, const ni_dbus_variant_t *var)
+{
+	unsigned int i;
+
+	digest = __ni_dbus_digest_bytes(digest, &var->type, sizeof(var->type));
+	switch (var->type) {
+	case DBUS_TYPE_STRING:
+	case DBUS_TYPE_OBJECT_PATH:
+		return __ni_dbus_digest_string(digest, var->string_value);
+	case DBUS_TYPE_BYTE:
+		return __ni_dbus_digest_bytes(digest, &var->byte_value, sizeof(var->byte_value));
+	case DBUS_TYPE_BOOLEAN:
+		return __ni_dbus_digest_bytes(digest, &var->bool_value, sizeof(var->bool_value));
+	case DBUS_TYPE_INT16:
+	case DBUS_TYPE_UINT16:
+		return __ni_dbus_digest_bytes(digest, &var->uint16_value, sizeof(var->uint16_value));
+	case DBUS_TYPE_INT32:
+	case DBUS_TYPE_UINT32:
+		return __ni_dbus_digest_bytes(digest, &var->uint32_value, sizeof(var->uint32_value));
+	case DBUS_TYPE_INT64:
+	case DBUS_TYPE_UINT64:
+		return __ni_dbus_digest_bytes(digest, &var->uint64_value, sizeof(var->uint64_value));
+	case DBUS_TYPE_DOUBLE:
+		return __ni_dbus_digest_bytes(digest, &var->double_value, sizeof(var->double_value));
+	case DBUS_TYPE_VARIANT:
+		if (var->variant_value)
+			digest = __ni_dbus_variant_digest(digest, var->variant_value);
+		return digest;
+	case DBUS_TYPE_STRUCT:
+		for (i = 0; i < var->array.len; ++i)
+			digest = __ni_dbus_variant_digest(digest, &var->struct_value[i]);
+		return digest;
+	case DBUS_TYPE_ARRAY:
+		break;
+	default:
+		return digest;
+	}
+
+	digest = __ni_dbus_digest_bytes(digest, &var->array.element_type, sizeof(var->array.element_type));
+	digest = __ni_dbus_digest_string(digest, var->array.element_signature);
+	digest = __ni_dbus_digest_bytes(digest, &var->array.len, sizeof(var->array.len));
+	switch (var->array.element_type) {
+	case DBUS_TYPE_BYTE:
+		return __ni_dbus_digest_bytes(digest, var->byte_array_value, var->array.len);
+	case DBUS_TYPE_UINT32:
+		return __ni_dbus_digest_bytes(digest, var->uint32_array_value,
+				var->array.len * sizeof(uint32_t));
+	case DBUS_TYPE_STRING:
+	case DBUS_TYPE_OBJECT_PATH:
+		for (i = 0; i < var->array.len; ++i)
+			digest = __ni_dbus_digest_string(digest, var->string_array_value[i]);
+		return digest;
+	case DBUS_TYPE_DICT_ENTRY:
+		for (i = 0; i < var->array.len; ++i) {
+			digest = __ni_dbus_digest_string(digest, var->dict_array_value[i].key);
+			digest = __ni_dbus_variant_digest(digest, &var->dict_array_value[i].datum);
+		}
+		return digest;
+	case DBUS_TYPE_INVALID:
+		if (var->array.element_signature == NULL)
+			return digest;
+		/* fallthrough */
+	case DBUS_TYPE_VARIANT:
+		for (i = 0; i < var->array.len; ++i)
+			digest = __ni_dbus_variant_digest(digest, &var->variant_array_value[i]);
+		return digest;
+	case DBUS_TYPE_STRUCT:
+		for (i = 0; i < var->array.len; ++i)
+			digest = __ni_dbus_variant_digest(digest, &var->struct_value[i]);
+		return digest;
+	default:
+		return digest;
+	}
+}
+
+static ni_dbus_property_digest_t *
+__ni_dbus_server_object_find_digest(ni_dbus_server_object_t *sob, const ni_dbus_service_t *service,
+				const char *name, unsigned int *hint)
+{
+	ni_dbus_property_digest_t *pd;
+	unsigned int i, pos;
+
+	/* properties are usually serialized in the same order */
+	for (i = 0; i < sob->digest_count; ++i) {
+		pos = (*hint + i) % sob->digest_count;
+		pd = &sob->digests[pos];
+		if (pd->service == service && ni_string_eq(pd->name, name)) {
+			*hint = pos + 1;
+			return pd;
+		}
+	}
+	return NULL;
+}
+
+static ni_dbus_property_digest_t *
+__ni_dbus_server_object_add_digest(ni_dbus_server_object_t *sob, const ni_dbus_service_t *service,
+				const char *name)
+{
+	ni_dbus_property_digest_t *pd;
+
+	sob->digests = xrealloc(sob->digests, (sob->digest_count + 1) * sizeof(*pd));
+	pd = &sob->digests[sob->digest_count++];
+	memset(pd, 0, sizeof(*pd));
+	pd->service = service;
+	ni_string_dup(&pd->name, name);
+	return pd;
+}
+
+/*
+ * Each service clients have fetched gets an unnamed marker entry, so
+ * it is still known when it had no properties at the time.
+ */
+static ni_dbus_property_digest_t *
+__ni_dbus_server_object_find_service(ni_dbus_server_object_t *sob, const ni_dbus_service_t *service)
+{
+	unsigned int i;
+
+	for (i = 0; i < sob->digest_count; ++i) {
+		if (sob->digests[i].service == service && sob->digests[i].name == NULL)
+			return &sob->digests[i];
+	}
+	return NULL;
+}
+
+static void
+__ni_dbus_server_object_mark_dirty(ni_dbus_server_object_t *sob, const ni_dbus_service_t *service)
+{
+	unsigned int i;
+
+	for (i = 0; i < sob->digest_count; ++i) {
+		if (sob->digests[i].name == NULL && (!service || sob->digests[i].service == service))
+			sob->digests[i].dirty = TRUE;
+	}
+}
+
+/*
+ * Update the digests of a service's properties dict, returning the
+ * indices of changed dict entries and the names of properties gone.
+ */
+static unsigned int
+__ni_dbus_server_object_update_digests(ni_dbus_server_object_t *sob, const ni_dbus_service_t *service,
+				const ni_dbus_variant_t *props, unsigned int *changed,
+				ni_string_array_t *invalidated)
+{
+	ni_dbus_property_digest_t *pd;
+	unsigned int i, hint = 0, count = 0;
+	uint64_t digest;
+
+	for (i = 0; i < sob->digest_count; ++i) {
+		if (sob->digests[i].service == service)
+			sob->digests[i].seen = FALSE;
+	}
+
+	for (i = 0; i < props->array.len; ++i) {
+		const ni_dbus_dict_entry_t *entry = &props->dict_array_value[i];
+
+		digest = __ni_dbus_variant_digest(NI_DBUS_DIGEST_INIT, &entry->datum);
+		pd = __ni_dbus_server_object_find_digest(sob, service, entry->key, &hint);
+		if (!pd) {
+			pd = __ni_dbus_server_object_add_digest(sob, service, entry->key);
+			if (changed)
+				changed[count++] = i;
+		} else
+		if (pd->digest != digest) {
+			if (changed)
+				changed[count++] = i;
+		}
+		pd->digest = digest;
+		pd->seen = TRUE;
+	}
+
+	for (i = 0; i < sob->digest_count; ) {
+		pd = &sob->digests[i];
+		if (pd->service != service || pd->seen || pd->name == NULL) {
+			++i;
+			continue;
+		}
+		if (invalidated)
+			ni_string_array_append(invalidated, pd->name);
+		ni_string_free(&pd->name);
+		sob->digests[i] = sob->digests[--sob->digest_count];
+	}
+	return count;
+}
+
+static void
+__ni_dbus_server_object_send_changed(ni_dbus_object_t *object, const ni_dbus_service_t *service,
+				const ni_dbus_variant_t *props, const unsigned int *changed,
+				unsigned int count, const ni_string_array_t *invalidated)
+{
+	ni_dbus_variant_t argv[3] = {
+		NI_DBUS_VARIANT_INIT, NI_DBUS_VARIANT_INIT, NI_DBUS_VARIANT_INIT
+	};
+	unsigned int i;
+
+	ni_dbus_variant_set_string(&argv[0], service->name);
+
+	/* borrow the changed entries from the properties dict */
+	ni_dbus_variant_init_dict(&argv[1]);
+	if (count) {
+		argv[1].dict_array_value = xcalloc(count, sizeof(ni_dbus_dict_entry_t));
+		for (i = 0; i < count; ++i)
+			argv[1].dict_array_value[i] = props->dict_array_value[changed[i]];
+		argv[1].array.len = count;
+	}
+
+	ni_dbus_variant_set_string_array(&argv[2], (const char **)invalidated->data,
+						invalidated->count);
+
+	ni_debug_dbus("%s: %s properties changed: %u, invalidated: %u",
+			object->path, service->name, count, invalidated->count);
+	ni_dbus_server_send_signal(object->server_object->server, object,
+			NI_DBUS_INTERFACE ".Properties", "PropertiesChanged", 3, argv);
+
+	free(argv[1].dict_array_value);
+	argv[1].dict_array_value = NULL;
+	argv[1].array.len = 0;
+
+	for (i = 0; i < 3; ++i)
+		ni_dbus_variant_destroy(&argv[i]);
+}
+
+/*
+ * Called with the properties dict of a service we're about to hand
+ * out; the first time, remember the values as clients see them.
+ * Later on the digests are updated by the change broadcast only.
+ */
+static void
+__ni_dbus_server_object_record_properties(ni_dbus_object_t *object, const ni_dbus_service_t *service,
+				const ni_dbus_variant_t *props)
+{
+	ni_dbus_server_object_t *sob = object->server_object;
+
+	if (!sob || !object->path || !service->properties || !ni_dbus_variant_is_dict(props))
+		return;
+
+	if (!__ni_dbus_server_object_find_service(sob, service)) {
+		__ni_dbus_server_object_add_digest(sob, service, NULL);
+		__ni_dbus_server_object_update_digests(sob, service, props, NULL, NULL);
+	}
+}
+
+/*
+ * Cache of the interface -> properties dict of an object, so repeated
+ * GetManagedObjects calls do not need to invoke all property getters.
+ * It is dropped when a method is called on the object, a signal is
+ * sent or a property is set, and rebuilt lazily by the next
+ * GetManagedObjects call.
+ */
+static void
+__ni_dbus_server_object_drop_cache(ni_dbus_object_t *object)
+{
+	ni_dbus_server_object_t *sob = object->server_object;
+
+	if (sob && sob->cached) {
+		ni_dbus_variant_init_dict(&sob->cache);
+		sob->cached = FALSE;
+	}
+}
+
+/*
+ * The object changed: drop the cache and mark all services dirty
+ */
+void
+ni_dbus_server_object_invalidate(ni_dbus_object_t *object)
+{
+	__ni_dbus_server_object_drop_cache(object);
+	if (object->server_object)
+		__ni_dbus_server_object_mark_dirty(object->server_object, NULL);
+}
+
+/*
+ * The cache is off by default, as it relies on each change of the
+ * objects being signaled or invalidated explicitly. Servers enable it
+ * for the objects of a class (and its subclasses) they do this for.
+ */
+void
+ni_dbus_server_enable_property_cache(ni_dbus_server_t *server, const ni_dbus_class_t *class)
+{
+	if (server)
+		server->cache_class = class;
+}
+
+static dbus_bool_t
+__ni_dbus_server_object_cacheable(const ni_dbus_object_t *object)
+{
+	const ni_dbus_server_object_t *sob = object->server_object;
+
+	if (!sob || !sob->server->cache_class || !object->path || !object->interfaces)
+		return FALSE;
+
+	/* objects refreshing their state on each call */
+	if (object->class && object->class->refresh)
+		return FALSE;
+	return ni_dbus_class_is_subclass(object->class, sob->server->cache_class);
+}
+
+static dbus_bool_t
+__ni_dbus_server_object_build_properties(ni_dbus_object_t *object, ni_dbus_variant_t *ifdict,
+				DBusError *error)
+{
+	const ni_dbus_service_t *service;
+	unsigned int i;
+
+	ni_dbus_variant_init_dict(ifdict);
+	for (i = 0; (service = object->interfaces[i]) != NULL; ++i) {
+		ni_dbus_variant_t *propdict = ni_dbus_dict_add(ifdict, service->name);
+
+		ni_dbus_variant_init_dict(propdict);
+		if (!ni_dbus_object_get_properties_as_dict(object, service, propdict, error)) {
+			ni_dbus_variant_destroy(ifdict);
+			return FALSE;
+		}
+		__ni_dbus_server_object_record_properties(object, service, propdict);
+	}
+	return TRUE;
+}
+
+/*
+ * Broadcast the changed properties of the dirty services of an object,
+ * skipping the services no client has fetched yet.
+ */
+dbus_bool_t
+ni_dbus_server_send_properties_changed(ni_dbus_server_t *server, ni_dbus_object_t *object)
+{
+	ni_string_array_t invalidated = NI_STRING_ARRAY_INIT;
+	DBusError error = DBUS_ERROR_INIT;
+	const ni_dbus_service_t *service;
+	ni_dbus_property_digest_t *marker;
+	ni_dbus_server_object_t *sob;
+	ni_dbus_variant_t props = NI_DBUS_VARIANT_INIT;
+	unsigned int *changed, count, i;
+	dbus_bool_t rv = TRUE;
+
+	if (!object || !(sob = object->server_object) || !object->interfaces)
+		return FALSE;
+
+	if (server && sob->server != server)
+		return FALSE;
+
+	for (i = 0; (service = object->interfaces[i]) != NULL; ++i) {
+		if (!(marker = __ni_dbus_server_object_find_service(sob, service)) || !marker->dirty)
+			continue;
+
+		/* the digest updates may move the marker */
+		marker->dirty = FALSE;
+
+		ni_dbus_variant_init_dict(&props);
+		if (!ni_dbus_object_get_properties_as_dict(object, service, &props, &error)) {
+			ni_debug_dbus("%s: unable to get %s properties: %s", object->path,
+					service->name, error.message);
+			dbus_error_free(&error);
+			ni_dbus_variant_destroy(&props);
+			rv = FALSE;
+			continue;
+		}
+
+		changed = props.array.len ? xcalloc(props.array.len, sizeof(*changed)) : NULL;
+		count = __ni_dbus_server_object_update_digests(sob, service, &props, changed, &invalidated);
+		if (count || invalidated.count)
+			__ni_dbus_server_object_send_changed(object, service, &props, changed, count, &invalidated);
+
+		ni_string_array_destroy(&invalidated);
+		ni_dbus_variant_destroy(&props);
+		free(changed);
+	}
+	return rv;
+}
+
 /*
  * Register an object
  */
@@ -217,7 +653,7 @@ static const ni_dbus_service_t __ni_dbus_object_manager_interface;
 static const ni_dbus_service_t __ni_dbus_object_properties_interface;
 static const ni_dbus_service_t __ni_dbus_object_introspectable_interface;
 static dbus_bool_t		__ni_dbus_object_manager_enumerate_object(ni_dbus_object_t *,
-					ni_dbus_variant_t *dict, DBusError *);
+					DBusMessageIter *, DBusError *);
 
 dbus_bool_t
 ni_dbus_object_register_object_manager(ni_dbus_object_t *object)
@@ -264,18 +700,29 @@ __ni_dbus_object_manager_get_managed_objects(ni_dbus_object_t *object,
 		ni_dbus_message_t *reply,
 		DBusError *error)
 {
-	ni_dbus_variant_t obj_dict = NI_DBUS_VARIANT_INIT;
+	DBusMessageIter iter, iter_dict;
 	int rv = TRUE;
 
 	NI_TRACE_ENTER_ARGS("path=%s, method=%s", object->path, method->name);
 
-	ni_dbus_variant_init_dict(&obj_dict);
-	rv = __ni_dbus_object_manager_enumerate_object(object, &obj_dict, error);
-	if (rv)
-		rv = ni_dbus_message_serialize_variants(reply, 1, &obj_dict, error);
-	ni_dbus_variant_destroy(&obj_dict);
-
+	dbus_message_iter_init_append(reply, &iter);
+	if (!dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
+					DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+					DBUS_TYPE_STRING_AS_STRING
+					DBUS_TYPE_VARIANT_AS_STRING
+					DBUS_DICT_ENTRY_END_CHAR_AS_STRING,
+					&iter_dict))
+		goto nomem;
+
+	rv = __ni_dbus_object_manager_enumerate_object(object, &iter_dict, error);
+
+	if (!dbus_message_iter_close_container(&iter, &iter_dict))
+		goto nomem;
 	return rv;
+
+nomem:
+	dbus_set_error(error, DBUS_ERROR_FAILED, "unable to serialize %s reply", method->name);
+	return FALSE;
 }
 
 static ni_dbus_method_t	__ni_dbus_object_manager_methods[] = {
@@ -369,6 +816,8 @@ __ni_dbus_object_properties_getall(ni_dbus_object_t *object, const ni_dbus_metho
 	ni_dbus_variant_init_dict(&dict);
 	if (service != NULL) {
 		rv = ni_dbus_object_get_properties_as_dict(object, service, &dict, error);
+		if (rv)
+			__ni_dbus_server_object_record_properties(object, service, &dict);
 	} else {
 		unsigned int i;
 
@@ -463,6 +912,9 @@ __ni_dbus_object_properties_set(ni_dbus_object_t *object, const ni_dbus_method_t
 	/* FIXME: Verify variant against property's signature */
 
 	rv = property->update(object, property, &argv[2], error);
+	__ni_dbus_server_object_drop_cache(object);
+	if (object->server_object)
+		__ni_dbus_server_object_mark_dirty(object->server_object, service);
 	return rv;
 }
 
@@ -473,9 +925,15 @@ static ni_dbus_method_t	__ni_dbus_object_properties_methods[] = {
 	{ NULL }
 };
 
+static ni_dbus_method_t	__ni_dbus_object_properties_signals[] = {
+	{ "PropertiesChanged",	"sa{sv}as"	},
+	{ NULL }
+};
+
 static const ni_dbus_service_t __ni_dbus_object_properties_interface = {
 	.name = NI_DBUS_INTERFACE ".Properties",
 	.methods = __ni_dbus_object_properties_methods,
+	.signals = __ni_dbus_object_properties_signals,
 };
 
 static dbus_bool_t
@@ -506,22 +964,41 @@ static const ni_dbus_service_t __ni_dbus_object_introspectable_interface = {
 };
 
 dbus_bool_t
-__ni_dbus_object_manager_enumerate_object(ni_dbus_object_t *object, ni_dbus_variant_t *obj_dict, DBusError *error)
+__ni_dbus_object_manager_enumerate_object(ni_dbus_object_t *object, DBusMessageIter *iter, DBusError *error)
 {
+	ni_dbus_server_object_t *sob = object->server_object;
 	ni_dbus_object_t *child;
 	int rv = TRUE;
 
 	if (object->interfaces) {
-		ni_dbus_variant_t *ifdict = ni_dbus_dict_add(obj_dict, object->path);
-		const ni_dbus_service_t *service;
-		unsigned int i;
+		ni_dbus_dict_entry_t entry;
+		ni_dbus_variant_t ifdict = NI_DBUS_VARIANT_INIT;
 
-		ni_dbus_variant_init_dict(ifdict);
-		for (i = 0; rv && (service = object->interfaces[i]) != NULL; ++i) {
-			ni_dbus_variant_t *propdict = ni_dbus_dict_add(ifdict, service->name);
+		if (sob && sob->cached) {
+			entry.datum = sob->cache;
+		} else {
+			if (!__ni_dbus_server_object_build_properties(object, &ifdict, error))
+				return FALSE;
+
+			if (__ni_dbus_server_object_cacheable(object)) {
+				ni_dbus_variant_destroy(&sob->cache);
+				sob->cache = ifdict;
+				sob->cached = TRUE;
+				entry.datum = sob->cache;
+			} else {
+				entry.datum = ifdict;
+			}
+		}
 
-			ni_dbus_variant_init_dict(propdict);
-			rv = ni_dbus_object_get_properties_as_dict(object, service, propdict, error);
+		/* entry.datum is a shallow copy, not to destroy */
+		entry.key = object->path;
+		rv = ni_dbus_message_iter_append_dict_entry(iter, &entry);
+		if (!sob || !sob->cached)
+			ni_dbus_variant_destroy(&ifdict);
+		if (!rv) {
+			dbus_set_error(error, DBUS_ERROR_FAILED,
+					"unable to serialize properties of %s", object->path);
+			return FALSE;
 		}
 	}
 
@@ -537,7 +1014,7 @@ __ni_dbus_object_manager_enumerate_object(ni_dbus_object_t *object, ni_dbus_vari
 			continue;
 		}
 
-		rv = __ni_dbus_object_manager_enumerate_object(child, obj_dict, error);
+		rv = __ni_dbus_object_manager_enumerate_object(child, iter, error);
 	}
 
 	return rv;
@@ -629,6 +1106,10 @@ __ni_dbus_object_message(DBusConnection *conn, DBusMessage *call, void *user_dat
 			}
 		}
 
+		/* Calls on other than the standard interfaces may modify the object */
+		if (!ni_dbus_get_standard_service(svc->name))
+			ni_dbus_server_object_invalidate(object);
+
 		/* If the object has a refresh function, call it now */
 		if (object->class && object->class->refresh
 		 && !object->class->refresh(object)) {
@@ -42,6 +42,8 @@ static dbus_bool_t	ni_dbus_serialize_xml_array(xml_node_t *, const ni_xs_type_t
 static dbus_bool_t	ni_dbus_serialize_xml_dict(xml_node_t *, const ni_xs_type_t *, ni_dbus_variant_t *);
 static dbus_bool_t	ni_dbus_serialize_xml_bitmask(const xml_node_t *, const ni_xs_scalar_info_t *, unsigned long *);
 static dbus_bool_t	ni_dbus_serialize_xml_bitmap(const xml_node_t *, const ni_xs_scalar_info_t *, unsigned long *);
+static dbus_bool_t	ni_dbus_marshal_xml(xml_node_t *, const ni_xs_type_t *, DBusMessageIter *);
+static dbus_bool_t	ni_dbus_marshal_xml_variant(xml_node_t *, const ni_xs_type_t *, DBusMessageIter *);
 static dbus_bool_t	ni_dbus_deserialize_xml(const ni_dbus_variant_t *, const ni_xs_type_t *, xml_node_t *);
 static dbus_bool_t	ni_dbus_deserialize_xml_scalar(const ni_dbus_variant_t *, const ni_xs_type_t *, xml_node_t *);
 static dbus_bool_t	ni_dbus_deserialize_xml_struct(const ni_dbus_variant_t *, const ni_xs_type_t *, xml_node_t *);
@@ -300,6 +302,27 @@ ni_dbus_xml_serialize_arg(const ni_dbus_method_t *method, unsigned int narg,
 	return ni_dbus_serialize_xml(node, xs_type, var);
 }
 
+/*
+ * Append the XML rep of an argument directly to a dbus call message.
+ * Without a node, an empty dict is appended.
+ */
+dbus_bool_t
+ni_dbus_xml_append_arg(const ni_dbus_method_t *method, unsigned int narg,
+					ni_dbus_message_t *msg, xml_node_t *node)
+{
+	ni_xs_type_t *xs_type;
+	DBusMessageIter iter;
+
+	if (!(xs_type = ni_dbus_xml_get_argument_type(method, narg)))
+		return FALSE;
+
+	dbus_message_iter_init_append(msg, &iter);
+	if (node == NULL || xs_type->class == NI_XS_TYPE_VOID)
+		return ni_dbus_message_iter_append_dict(&iter, NULL, 0);
+
+	return ni_dbus_marshal_xml(node, xs_type, &iter);
+}
+
 xml_node_t *
 ni_dbus_xml_deserialize_arguments(const ni_dbus_method_t *method,
 				unsigned int num_vars, const ni_dbus_variant_t *vars,
@@ -1334,6 +1357,303 @@ ni_dbus_deserialize_xml_union(const ni_dbus_variant_t *var, const ni_xs_type_t *
 	return ni_dbus_deserialize_xml(child, child_type, node);
 }
 
+/*
+ * Marshal an XML tree directly into a dbus message, producing the
+ * same wire format as ni_dbus_serialize_xml and appending the result,
+ * but without building an intermediate variant tree.
+ */
+
+/* The signature of what ni_dbus_marshal_xml appends for this node */
+static dbus_bool_t
+ni_dbus_xml_signature(xml_node_t *node, const ni_xs_type_t *type, char *sigbuf, size_t buflen)
+{
+	ni_xs_scalar_info_t *scalar_info;
+	ni_xs_array_info_t *array_info;
+	const ni_xs_type_t *child_type;
+	size_t len;
+
+	switch (type->class) {
+	case NI_XS_TYPE_SCALAR:
+		/* flags are encoded as a BYTE */
+		scalar_info = ni_xs_scalar_info(type);
+		if (scalar_info->type == DBUS_TYPE_INVALID) {
+			snprintf(sigbuf, buflen, "%s", DBUS_TYPE_BYTE_AS_STRING);
+			return TRUE;
+		}
+		break;
+
+	case NI_XS_TYPE_ARRAY:
+		array_info = ni_xs_array_info(type);
+		if (array_info->notation) {
+			snprintf(sigbuf, buflen, "%s", DBUS_TYPE_ARRAY_AS_STRING DBUS_TYPE_BYTE_AS_STRING);
+			return TRUE;
+		}
+		break;
+
+	case NI_XS_TYPE_DICT:
+		break;
+
+	case NI_XS_TYPE_UNION:
+		if (!(child_type = __ni_dbus_xml_union_type(node, type, NULL)) || buflen < 4)
+			return FALSE;
+
+		sigbuf[0] = DBUS_STRUCT_BEGIN_CHAR;
+		sigbuf[1] = DBUS_TYPE_STRING;
+		sigbuf[2] = '\0';
+		if (child_type->class != NI_XS_TYPE_VOID &&
+		    !ni_dbus_xml_signature(node, child_type, sigbuf + 2, buflen - 3))
+			return FALSE;
+
+		len = strlen(sigbuf);
+		sigbuf[len++] = DBUS_STRUCT_END_CHAR;
+		sigbuf[len] = '\0';
+		return TRUE;
+
+	default:
+		return FALSE;
+	}
+
+	if (buflen < sizeof(NI_DBUS_DICT_SIGNATURE))
+		return FALSE;
+	return __ni_xs_type_to_dbus_signature(type, sigbuf, buflen) != NULL;
+}
+
+static dbus_bool_t
+ni_dbus_marshal_xml_scalar(xml_node_t *node, const ni_xs_type_t *type, DBusMessageIter *iter,
+				const char *signature)
+{
+	ni_xs_scalar_info_t *scalar_info = ni_xs_scalar_info(type);
+	ni_dbus_variant_t var = NI_DBUS_VARIANT_INIT;
+	dbus_bool_t rv;
+
+	/* Plain strings are appended as they are, without a copy */
+	if (scalar_info->type == DBUS_TYPE_STRING && node->cdata &&
+	    !scalar_info->constraint.enums &&
+	    !scalar_info->constraint.bitmap &&
+	    !scalar_info->constraint.bitmask) {
+		DBusMessageIter iter_val;
+
+		if (signature == NULL)
+			return dbus_message_iter_append_basic(iter, DBUS_TYPE_STRING, &node->cdata);
+
+		if (!dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT,
+					DBUS_TYPE_STRING_AS_STRING, &iter_val))
+			return FALSE;
+		if (!dbus_message_iter_append_basic(&iter_val, DBUS_TYPE_STRING, &node->cdata)) {
+			dbus_message_iter_abandon_container(iter, &iter_val);
+			return FALSE;
+		}
+		return dbus_message_iter_close_container(iter, &iter_val);
+	}
+
+	rv = ni_dbus_serialize_xml_scalar(node, type, &var) &&
+		ni_dbus_message_iter_append_value(iter, &var, signature);
+	ni_dbus_variant_destroy(&var);
+	return rv;
+}
+
+static dbus_bool_t
+ni_dbus_marshal_xml_array(xml_node_t *node, const ni_xs_type_t *type, DBusMessageIter *iter)
+{
+	ni_xs_array_info_t *array_info = ni_xs_array_info(type);
+	ni_xs_type_t *element_type = array_info->element_type;
+	DBusMessageIter iter_array;
+	char sigbuf[32];
+	xml_node_t *child;
+
+	if (array_info->notation) {
+		unsigned char *data = NULL;
+		unsigned int len = 0;
+		dbus_bool_t rv;
+
+		if (!ni_dbus_serialize_byte_array_notation(node, array_info, &data, &len)) {
+			free(data);
+			return FALSE;
+		}
+		rv = ni_dbus_message_iter_append_byte_array(iter, data, len);
+		free(data);
+		return rv;
+	}
+
+	if (element_type->class == NI_XS_TYPE_SCALAR) {
+		ni_xs_scalar_info_t *scalar_info = ni_xs_scalar_info(element_type);
+
+		if (scalar_info->type == DBUS_TYPE_INVALID)
+			goto not_implemented;
+	} else
+	if (element_type->class != NI_XS_TYPE_DICT)
+		goto not_implemented;
+
+	if (!__ni_xs_type_to_dbus_signature(element_type, sigbuf, sizeof(sigbuf)) ||
+	    !dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, sigbuf, &iter_array))
+		return FALSE;
+
+	for (child = node->children; child; child = child->next) {
+		if (element_type->class == NI_XS_TYPE_SCALAR) {
+			ni_dbus_variant_t var = NI_DBUS_VARIANT_INIT;
+			dbus_bool_t rv;
+
+			if (child->cdata == NULL) {
+				ni_error("%s: NULL array element",
+						xml_node_location(child));
+				goto failed;
+			}
+
+			if (sigbuf[0] == DBUS_TYPE_STRING || sigbuf[0] == DBUS_TYPE_OBJECT_PATH) {
+				rv = dbus_message_iter_append_basic(&iter_array, sigbuf[0], &child->cdata);
+			} else
+			if (ni_dbus_variant_parse(&var, child->cdata, sigbuf)) {
+				rv = ni_dbus_message_iter_append_value(&iter_array, &var, NULL);
+			} else {
+				ni_error("%s: syntax error in array element", __func__);
+				rv = FALSE;
+			}
+			ni_dbus_variant_destroy(&var);
+			if (!rv)
+				goto failed;
+		} else
+		if (!ni_dbus_marshal_xml(child, element_type, &iter_array)) {
+			ni_error("%s: failed to serialize array element", xml_node_location(child));
+			goto failed;
+		}
+	}
+
+	return dbus_message_iter_close_container(iter, &iter_array);
+
+failed:
+	dbus_message_iter_abandon_container(iter, &iter_array);
+	return FALSE;
+
+not_implemented:
+	ni_error("%s: arrays of type %s not implemented yet",
+			xml_node_location(node), ni_xs_type_to_dbus_signature(element_type));
+	return FALSE;
+}
+
+static dbus_bool_t
+ni_dbus_marshal_xml_dict(xml_node_t *node, const ni_xs_type_t *type, DBusMessageIter *iter)
+{
+	ni_xs_dict_info_t *dict_info = ni_xs_dict_info(type);
+	DBusMessageIter iter_array, iter_entry;
+	xml_node_t *child;
+
+	if (!dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY,
+					      DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+					      DBUS_TYPE_STRING_AS_STRING
+					      DBUS_TYPE_VARIANT_AS_STRING
+					      DBUS_DICT_ENTRY_END_CHAR_AS_STRING,
+					      &iter_array))
+		return FALSE;
+
+	for (child = node->children; child; child = child->next) {
+		const ni_xs_type_t *child_type = ni_xs_dict_info_find(dict_info, child->name);
+
+		if (child_type == NULL) {
+			ni_warn("%s: ignoring unknown dict element \"%s\"", __func__, child->name);
+			continue;
+		}
+
+		if (!dbus_message_iter_open_container(&iter_array, DBUS_TYPE_DICT_ENTRY, NULL, &iter_entry))
+			goto failed;
+
+		if (!dbus_message_iter_append_basic(&iter_entry, DBUS_TYPE_STRING, &child->name)
+		 || !ni_dbus_marshal_xml_variant(child, child_type, &iter_entry)) {
+			dbus_message_iter_abandon_container(&iter_array, &iter_entry);
+			goto failed;
+		}
+
+		if (!dbus_message_iter_close_container(&iter_array, &iter_entry))
+			goto failed;
+	}
+
+	return dbus_message_iter_close_container(iter, &iter_array);
+
+failed:
+	dbus_message_iter_abandon_container(iter, &iter_array);
+	return FALSE;
+}
+
+static dbus_bool_t
+ni_dbus_marshal_xml_union(xml_node_t *node, const ni_xs_type_t *type, DBusMessageIter *iter)
+{
+	const ni_xs_type_t *child_type;
+	DBusMessageIter iter_struct;
+	const char *kind;
+
+	child_type = __ni_dbus_xml_union_type(node, type, &kind);
+	if (child_type == NULL)
+		return FALSE;
+
+	if (!dbus_message_iter_open_container(iter, DBUS_TYPE_STRUCT, NULL, &iter_struct))
+		return FALSE;
+
+	if (!dbus_message_iter_append_basic(&iter_struct, DBUS_TYPE_STRING, &kind) ||
+	    (child_type->class != NI_XS_TYPE_VOID &&
+	     !ni_dbus_marshal_xml(node, child_type, &iter_struct))) {
+		dbus_message_iter_abandon_container(iter, &iter_struct);
+		return FALSE;
+	}
+
+	return dbus_message_iter_close_container(iter, &iter_struct);
+}
+
+static dbus_bool_t
+ni_dbus_marshal_xml(xml_node_t *node, const ni_xs_type_t *type, DBusMessageIter *iter)
+{
+	switch (type->class) {
+	case NI_XS_TYPE_VOID:
+		return TRUE;
+
+	case NI_XS_TYPE_SCALAR:
+		return ni_dbus_marshal_xml_scalar(node, type, iter, NULL);
+
+	case NI_XS_TYPE_STRUCT:
+		ni_error("%s: structs not implemented yet", __func__);
+		return FALSE;
+
+	case NI_XS_TYPE_UNION:
+		return ni_dbus_marshal_xml_union(node, type, iter);
+
+	case NI_XS_TYPE_ARRAY:
+		return ni_dbus_marshal_xml_array(node, type, iter);
+
+	case NI_XS_TYPE_DICT:
+		return ni_dbus_marshal_xml_dict(node, type, iter);
+
+	default:
+		ni_error("unsupported xml type class %u", type->class);
+		return FALSE;
+	}
+}
+
+/*
+ * Marshal a dict member, wrapped into a VARIANT
+ */
+static dbus_bool_t
+ni_dbus_marshal_xml_variant(xml_node_t *node, const ni_xs_type_t *type, DBusMessageIter *iter)
+{
+	DBusMessageIter iter_val;
+	char sigbuf[64];
+
+	if (type->class == NI_XS_TYPE_SCALAR)
+		return ni_dbus_marshal_xml_scalar(node, type, iter, DBUS_TYPE_VARIANT_AS_STRING);
+
+	if (!ni_dbus_xml_signature(node, type, sigbuf, sizeof(sigbuf))) {
+		ni_error("%s: cannot marshal element <%s>", xml_node_location(node), node->name);
+		return FALSE;
+	}
+
+	if (!dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT, sigbuf, &iter_val))
+		return FALSE;
+
+	if (!ni_dbus_marshal_xml(node, type, &iter_val)) {
+		dbus_message_iter_abandon_container(iter, &iter_val);
+		return FALSE;
+	}
+
+	return dbus_message_iter_close_container(iter, &iter_val);
+}
+
 /*
  * Get the dbus signature of a dbus-xml type
  */
@@ -1741,9 +1741,10 @@ void
 ni_dhcp4_apply_routes(ni_addrconf_lease_t *lease, ni_route_array_t *routes)
 {
 	ni_route_array_t temp = NI_ROUTE_ARRAY_INIT;
+	ni_route_table_t *onlink = NULL;
 	ni_route_t *rp, *r;
 	ni_address_t *ap;
-	unsigned int i, j;
+	unsigned int i;
 
 	if (!lease || !routes)
 		return;
@@ -1755,6 +1756,7 @@ ni_dhcp4_apply_routes(ni_addrconf_lease_t *lease, ni_route_array_t *routes)
 		if (ni_sockaddr_is_specified(&rp->nh.gateway))
 			continue;
 		ni_route_array_append(&temp, ni_route_ref(rp));
+		ni_route_tables_add_route(&onlink, ni_route_ref(rp));
 	}
 
 	/* now the routes with a gateway - add a
@@ -1769,22 +1771,13 @@ ni_dhcp4_apply_routes(ni_addrconf_lease_t *lease, ni_route_array_t *routes)
 
 		/* just add, when gateway is on the same net as IP */
 		for (ap = lease->addrs; !added && ap; ap = ap->next) {
-			if (!ni_address_can_reach(ap, &rp->nh.gateway))
+			if (!ni_address_can_reach(ap, &rp->nh.gateway, NULL))
 				continue;
 			ni_route_array_append(&temp, ni_route_ref(rp));
 			added = TRUE;
 		}
 		/* or there is a device route allowing to reach it */
-		for (j = 0; !added && j < temp.count; ++j) {
-			if (!(r = temp.data[j]))
-				continue;
-			if (ni_sockaddr_is_specified(&r->nh.gateway))
-				continue;
-
-			if (!ni_sockaddr_prefix_match(r->prefixlen,
-						&r->destination,
-						&rp->nh.gateway))
-				continue;
+		if (!added && ni_address_can_reach(NULL, &rp->nh.gateway, onlink)) {
 			ni_route_array_append(&temp, ni_route_ref(rp));
 			added = TRUE;
 		}
@@ -1795,10 +1788,13 @@ ni_dhcp4_apply_routes(ni_addrconf_lease_t *lease, ni_route_array_t *routes)
 			r = ni_route_create(len * 8, &rp->nh.gateway, NULL, 0, NULL);
 			ni_route_array_append(&temp, r);
 			ni_route_array_append(&temp, ni_route_ref(rp));
+			if (r)
+				ni_route_tables_add_route(&onlink, ni_route_ref(r));
 		}
 	}
 	ni_route_tables_add_routes(&lease->routes, &temp);
 	ni_route_array_destroy(&temp);
+	ni_route_tables_destroy(&onlink);
 }
 
 /*
@@ -48,6 +48,10 @@ __ni_system_ethernet_refresh(ni_netdev_t *dev)
 	if (!ni_netdev_device_is_ready(dev) || !dev->link.ifindex)
 		return;
 
+	/* The permanent address does not change, query it once */
+	if (dev->ethernet && dev->ethernet->permanent_address.len)
+		return;
+
 	/* A permanent address is not strictly ethernet specific,
 	 * we just don't query it along with ethtool options as
 	 * most (virtual) devices provide all-zeroes hw-address.
@@ -3636,13 +3636,39 @@ ni_ethtool_refresh(ni_netdev_t *dev)
 	return TRUE;
 }
 
+/*
+ * The ethtool data of system devices is fetched lazily: events which
+ * may change it bump the generation only and the data is re-fetched
+ * on next access when it has been refreshed in another generation.
+ */
+void
+ni_system_ethtool_invalidate(ni_netdev_t *dev)
+{
+	ni_ethtool_t *ethtool;
+
+	if (!dev || !(ethtool = ni_netdev_get_ethtool(dev)))
+		return;
+
+	ethtool->generation++;
+}
+
 void
 ni_system_ethtool_refresh(ni_netdev_t *dev)
 {
+	ni_ethtool_t *ethtool;
+
 	if (!ni_netdev_device_is_ready(dev) || !dev->link.ifindex)
 		return;
 
-	ni_ethtool_refresh(dev);
+	if (!(ethtool = dev->ethtool) || ethtool->refreshed == ethtool->generation)
+		return;
+
+	ni_debug_verbose(NI_LOG_DEBUG2, NI_TRACE_IFCONFIG,
+			"%s: refreshing ethtool data (generation %u)",
+			dev->name, ethtool->generation);
+
+	if (ni_ethtool_refresh(dev))
+		ethtool->refreshed = ethtool->generation;
 }
 
 int
@@ -3653,7 +3679,10 @@ ni_system_ethtool_setup(ni_netconfig_t *nc, ni_netdev_t *dev, const ni_netdev_t
 	if (!ni_netdev_device_is_ready(dev) || !dev->link.ifindex)
 		return -1;
 
-	if (!dev->ethtool && !ni_ethtool_refresh(dev))
+	if (!dev->ethtool)
+		ni_system_ethtool_invalidate(dev);
+	ni_system_ethtool_refresh(dev);
+	if (!dev->ethtool)
 		return -1;
 
 	ref.name = dev->name;
@@ -3668,7 +3697,7 @@ ni_system_ethtool_setup(ni_netconfig_t *nc, ni_netdev_t *dev, const ni_netdev_t
 		ni_ethtool_set_channels(&ref, dev->ethtool, cfg->ethtool->channels);
 		ni_ethtool_set_coalesce(&ref, dev->ethtool, cfg->ethtool->coalesce);
 		ni_ethtool_set_pause(&ref, dev->ethtool, cfg->ethtool->pause);
-		ni_ethtool_refresh(dev);
+		ni_system_ethtool_invalidate(dev);
 	}
 	return 0;
 }
@@ -40,6 +40,7 @@ struct ni_ifcondition {
 			ni_ifcondition_t *right;
 		} terms;
 		const ni_dbus_class_t *	class;
+		ni_wireless_ssid_t *	essid;
 		char *			string;
 		unsigned int		uint;
 	} args;
@@ -79,8 +80,10 @@ struct ni_fsm_policy_action {
 	/* An xml policy may specify the node it
 	 * applies to by a path, which is a bit like a very
 	 * simple xpath, like /foo/bar/baz.
+	 * The path is split into its element names once.
 	 */
 	char *				xpath;
+	ni_string_array_t		xpath_names;
 	ni_bool_t			final;
 
 	/* Templates can create one or more devices */
@@ -92,6 +95,18 @@ struct ni_fsm_policy_action {
 	} create;
 };
 
+/*
+ * Document transformed by a policy alone, keyed by the hash of the
+ * config and the policy generation (seq) it has been made with.
+ */
+#define NI_FSM_POLICY_MEMO_SIZE		32
+
+typedef struct ni_fsm_policy_memo {
+	unsigned int			seq;
+	ni_uuid_t			input;
+	xml_node_t *			result;
+} ni_fsm_policy_memo_t;
+
 /*
  * Opaque policy object
  */
@@ -105,6 +120,10 @@ struct ni_fsm_policy {
 	ni_fsm_policy_t **		pprev;
 	ni_fsm_policy_t *		next;
 
+	/* chain in the fsm policy name index */
+	ni_fsm_policy_t **		index_pprev;
+	ni_fsm_policy_t *		index_next;
+
 	unsigned int			seq;
 
 	ni_fsm_policy_type_t		type;
@@ -118,10 +137,15 @@ struct ni_fsm_policy {
 
 	ni_fsm_policy_action_t *	create_action;
 	ni_fsm_policy_action_t *	actions;
+
+	/* Documents recently transformed by this policy alone,
+	 * in the slot given by the config hash. */
+	ni_fsm_policy_memo_t		memo[NI_FSM_POLICY_MEMO_SIZE];
 };
 
 
 static void			ni_fsm_policy_reset(ni_fsm_policy_t *);
+static void			ni_fsm_policy_memo_reset(ni_fsm_policy_t *);
 static void			ni_fsm_policy_destroy(ni_fsm_policy_t *);
 static ni_ifcondition_t *	ni_fsm_policy_conditions_from_xml(xml_node_t *);
 static ni_bool_t		ni_ifcondition_check(const ni_ifcondition_t *, const ni_fsm_t *, ni_ifworker_t *);
@@ -164,6 +188,81 @@ ni_fsm_policy_list_unlink(ni_fsm_policy_t *policy)
 	policy->next = NULL;
 }
 
+/*
+ * The first applicability check of a policy is the comparison of
+ * its name to the policy name derived from the worker name. The fsm
+ * hashes its policies by name, so a lookup only has to evaluate the
+ * <match> conditions of the policies carrying this name.
+ */
+#define NI_FSM_POLICY_INDEX_SIZE	1024
+
+static unsigned int
+ni_fsm_policy_index_hash(const char *name)
+{
+	unsigned int hash = 5381;
+
+	while (name && *name)
+		hash = ((hash << 5) + hash) ^ (unsigned char)*name++;
+
+	return hash % NI_FSM_POLICY_INDEX_SIZE;
+}
+
+static inline ni_fsm_policy_t *
+ni_fsm_policy_index_lookup(const ni_fsm_t *fsm, const char *name)
+{
+	if (!fsm->policy_index || !name)
+		return NULL;
+	return fsm->policy_index[ni_fsm_policy_index_hash(name)];
+}
+
+static void
+ni_fsm_policy_index_insert(ni_fsm_t *fsm, ni_fsm_policy_t *policy)
+{
+	ni_fsm_policy_t **list;
+
+	if (!fsm->policy_index)
+		fsm->policy_index = xcalloc(NI_FSM_POLICY_INDEX_SIZE, sizeof(ni_fsm_policy_t *));
+
+	list = &fsm->policy_index[ni_fsm_policy_index_hash(policy->name)];
+	policy->index_pprev = list;
+	policy->index_next = *list;
+	if (policy->index_next)
+		policy->index_next->index_pprev = &policy->index_next;
+	*list = policy;
+}
+
+static inline void
+ni_fsm_policy_index_unlink(ni_fsm_policy_t *policy)
+{
+	ni_fsm_policy_t **pprev, *next;
+
+	pprev = policy->index_pprev;
+	next = policy->index_next;
+	if (pprev)
+		*pprev = next;
+	if (next)
+		next->index_pprev = pprev;
+	policy->index_pprev = NULL;
+	policy->index_next = NULL;
+}
+
+void
+ni_fsm_policy_index_destroy(ni_fsm_t *fsm)
+{
+	ni_fsm_policy_t *policy;
+	unsigned int i;
+
+	if (!fsm || !fsm->policy_index)
+		return;
+
+	for (i = 0; i < NI_FSM_POLICY_INDEX_SIZE; ++i) {
+		while ((policy = fsm->policy_index[i]))
+			ni_fsm_policy_index_unlink(policy);
+	}
+	free(fsm->policy_index);
+	fsm->policy_index = NULL;
+}
+
 /*
  * Destructor for policy objects
  */
@@ -174,6 +273,7 @@ ni_fsm_policy_free(ni_fsm_policy_t *policy)
 		ni_assert(policy->refcount);
 		policy->refcount--;
 		if (policy->refcount == 0) {
+			ni_fsm_policy_index_unlink(policy);
 			ni_fsm_policy_list_unlink(policy);
 			ni_fsm_policy_destroy(policy);
 			free(policy);
@@ -193,6 +293,7 @@ ni_fsm_policy_destroy(ni_fsm_policy_t *policy)
 static void
 ni_fsm_policy_reset(ni_fsm_policy_t *policy)
 {
+	ni_fsm_policy_memo_reset(policy);
 	if (policy->match) {
 		ni_ifcondition_free(policy->match);
 		policy->match = NULL;
@@ -428,6 +529,7 @@ ni_fsm_policy_new(ni_fsm_t *fsm, const char *name, xml_node_t *node)
 	}
 
 	ni_fsm_policy_list_insert(&fsm->policies, policy);
+	ni_fsm_policy_index_insert(fsm, policy);
 	return policy;
 }
 
@@ -487,6 +589,7 @@ ni_fsm_policy_remove(ni_fsm_t *fsm, ni_fsm_policy_t *policy)
 			 * force remove if in fsm list,
 			 * even it is not the last ref.
 			 */
+			ni_fsm_policy_index_unlink(cur);
 			ni_fsm_policy_list_unlink(cur);
 			ni_fsm_policy_free(cur);
 			return TRUE;
@@ -596,24 +699,13 @@ ni_fsm_policy_weight(const ni_fsm_policy_t *policy)
 }
 
 /*
- * Check whether policy applies to this ifworker
+ * Check whether policy applies to this ifworker, once its name
+ * matched the policy name of the worker
  */
 static ni_bool_t
-ni_fsm_policy_applicable(const ni_fsm_t *fsm, ni_fsm_policy_t *policy, ni_ifworker_t *w)
+ni_fsm_policy_applicable_named(const ni_fsm_t *fsm, ni_fsm_policy_t *policy, ni_ifworker_t *w)
 {
 	xml_node_t *node;
-	char *pname;
-
-	if (!policy || !w)
-		return FALSE;
-
-	/* 1st match check -ifworker to policy name comparison */
-	pname = ni_ifpolicy_name_from_ifname(w->name);
-	if (!ni_string_eq(policy->name, pname)) {
-		ni_string_free(&pname);
-		return FALSE;
-	}
-	ni_string_free(&pname);
 
 	/* 2nd match check - ifworker  to config name comparison */
 	if (!xml_node_is_empty(w->config.node) &&
@@ -645,6 +737,26 @@ ni_fsm_policy_applicable(const ni_fsm_t *fsm, ni_fsm_policy_t *policy, ni_ifwork
 	return TRUE;
 }
 
+/*
+ * Check whether policy applies to this ifworker
+ */
+static ni_bool_t
+ni_fsm_policy_applicable(const ni_fsm_t *fsm, ni_fsm_policy_t *policy, ni_ifworker_t *w)
+{
+	ni_bool_t rv;
+	char *pname;
+
+	if (!policy || !w)
+		return FALSE;
+
+	/* 1st match check -ifworker to policy name comparison */
+	pname = ni_ifpolicy_name_from_ifname(w->name);
+	rv = ni_string_eq(policy->name, pname);
+	ni_string_free(&pname);
+
+	return rv && ni_fsm_policy_applicable_named(fsm, policy, w);
+}
+
 /*
  * Compare the weight of two policies.
  * Returns < 0 if a's weight is smaller than that of b, etc.
@@ -680,13 +792,19 @@ ni_fsm_policy_get_applicable_policies(const ni_fsm_t *fsm, ni_ifworker_t *w,
 {
 	unsigned int count = 0;
 	ni_fsm_policy_t *policy;
+	char *pname;
 
 	if (!w) {
 		ni_error("unable to get applicable policy for non-existing device");
 		return 0;
 	}
 
-	for (policy = fsm->policies; policy; policy = policy->next) {
+	pname = ni_ifpolicy_name_from_ifname(w->name);
+	policy = ni_fsm_policy_index_lookup(fsm, pname);
+	for ( ; policy; policy = policy->index_next) {
+		if (!ni_string_eq(policy->name, pname))
+			continue;
+
 		if (!ni_ifpolicy_name_is_valid(policy->name)) {
 			ni_error("policy with invalid name %s", policy->name);
 			continue;
@@ -702,11 +820,12 @@ ni_fsm_policy_get_applicable_policies(const ni_fsm_t *fsm, ni_ifworker_t *w,
 			continue;
 		}
 
-		if (ni_fsm_policy_applicable(fsm, policy, w)) {
+		if (ni_fsm_policy_applicable_named(fsm, policy, w)) {
 			if (count < max)
 				result[count++] = policy;
 		}
 	}
+	ni_string_free(&pname);
 
 	qsort(result, count, sizeof(result[0]), ni_fsm_policy_compare);
 	return count;
@@ -716,10 +835,23 @@ ni_bool_t
 ni_fsm_exists_applicable_policy(const ni_fsm_t *fsm, ni_fsm_policy_t *list, ni_ifworker_t *w)
 {
 	ni_fsm_policy_t *policy;
+	ni_bool_t rv = FALSE;
+	char *pname;
 
 	if (!list || !w)
 		return FALSE;
 
+	if (fsm && list == fsm->policies) {
+		pname = ni_ifpolicy_name_from_ifname(w->name);
+		policy = ni_fsm_policy_index_lookup(fsm, pname);
+		for ( ; policy && !rv; policy = policy->index_next) {
+			if (ni_string_eq(policy->name, pname))
+				rv = ni_fsm_policy_applicable_named(fsm, policy, w);
+		}
+		ni_string_free(&pname);
+		return rv;
+	}
+
 	for (policy = list; policy; policy = policy->next) {
 		if (ni_fsm_policy_applicable(fsm, policy, w))
 			return TRUE;
@@ -776,33 +908,91 @@ ni_fsm_exists_applicable_policy(const ni_fsm_t *fsm, ni_fsm_policy_t *list, ni_i
  *	policy with a greater "weight" attribute potentially overwrites
  *	changes made by a policy with lower weight.
  */
+static xml_node_t *
+ni_fsm_policy_apply_actions(const ni_fsm_policy_t *policy, xml_node_t *node)
+{
+	ni_fsm_policy_action_t *action;
+
+	for (action = policy->actions; action && node; action = action->next) {
+		switch (action->type) {
+		case NI_IFPOLICY_ACTION_MERGE:
+			node = ni_fsm_policy_action_xml_merge(action, node);
+			break;
+
+		case NI_IFPOLICY_ACTION_REPLACE:
+			node = ni_fsm_policy_action_xml_replace(action, node);
+			break;
+
+		default:
+			continue;
+		}
+	}
+
+	return node;
+}
+
+/*
+ * Nanny transforms the same documents with the same policy on every
+ * recheck; remember the results to return a copy of them as long as
+ * neither the policy nor the document changed.
+ */
+static void
+ni_fsm_policy_memo_reset(ni_fsm_policy_t *policy)
+{
+	ni_fsm_policy_memo_t *memo;
+	unsigned int i;
+
+	for (i = 0; i < NI_FSM_POLICY_MEMO_SIZE; ++i) {
+		memo = &policy->memo[i];
+		xml_node_free(memo->result);
+		memset(memo, 0, sizeof(*memo));
+	}
+}
+
+static xml_node_t *
+ni_fsm_policy_apply_actions_memo(ni_fsm_policy_t *policy, xml_node_t *node)
+{
+	ni_fsm_policy_memo_t *memo;
+	ni_uuid_t input;
+
+	if (xml_node_hash(node, NI_HASHCTX_MD5, &input, sizeof(input)) < 0)
+		return ni_fsm_policy_apply_actions(policy, node);
+
+	/* direct mapped: when more configs than slots are transformed
+	 * in turn, only the colliding ones evict each other */
+	memo = &policy->memo[input.words[0] % NI_FSM_POLICY_MEMO_SIZE];
+	if (memo->result && memo->seq == policy->seq && ni_uuid_equal(&memo->input, &input)) {
+		xml_node_free(node);
+		return xml_node_clone(memo->result, NULL);
+	}
+
+	if ((node = ni_fsm_policy_apply_actions(policy, node))) {
+		xml_node_free(memo->result);
+		memo->seq = policy->seq;
+		memo->input = input;
+		memo->result = xml_node_clone(node, NULL);
+	}
+	return node;
+}
+
 xml_node_t *
 ni_fsm_policy_transform_document(xml_node_t *node, ni_fsm_policy_t * const *policies, unsigned int count)
 {
 	unsigned int i = 0;
 
+	/* The final flags set by a policy are not part of the memo;
+	 * only a single policy transformation can be taken from it. */
+	if (count == 1 && policies[0] && node && !node->final)
+		return ni_fsm_policy_apply_actions_memo(policies[0], node);
+
 	/* Apply policies in order of decreasing weight */
 	for (i = count; i--; ) {
 		const ni_fsm_policy_t *policy = policies[i];
-		ni_fsm_policy_action_t *action;
 
 		if (!policy)
 			continue;
 
-		for (action = policy->actions; action && node; action = action->next) {
-			switch (action->type) {
-			case NI_IFPOLICY_ACTION_MERGE:
-				node = ni_fsm_policy_action_xml_merge(action, node);
-				break;
-
-			case NI_IFPOLICY_ACTION_REPLACE:
-				node = ni_fsm_policy_action_xml_replace(action, node);
-				break;
-
-			default:
-				continue;
-			}
-		}
+		node = ni_fsm_policy_apply_actions(policy, node);
 	}
 
 	return node;
@@ -831,8 +1021,10 @@ ni_fsm_policy_action_new(ni_fsm_policy_action_type_t type, xml_node_t *node, ni_
 		*list = action;
 
 	if (type == NI_IFPOLICY_ACTION_MERGE || type == NI_IFPOLICY_ACTION_REPLACE) {
-		if ((attr = xml_node_get_attr(node, "path")) != NULL)
+		if ((attr = xml_node_get_attr(node, "path")) != NULL) {
 			ni_string_dup(&action->xpath, attr);
+			ni_string_split(&action->xpath_names, attr, "/", 0);
+		}
 		if ((attr = xml_node_get_attr(node, "final")) != NULL) {
 			if (!strcasecmp(attr, "true") || !strcmp(attr, "1"))
 				action->final = TRUE;
@@ -906,6 +1098,7 @@ ni_fsm_policy_action_free(ni_fsm_policy_action_t *action)
 {
 	if (action->xpath)
 		ni_string_free(&action->xpath);
+	ni_string_array_destroy(&action->xpath_names);
 
 	if (action->type == NI_IFPOLICY_ACTION_CREATE) {
 		ni_fsm_template_input_t *input;
@@ -971,10 +1164,10 @@ ni_fsm_policy_action_xml_lookup_next(xml_node_t *node, const char *name, xml_nod
 }
 
 static xml_node_array_t *
-ni_fsm_policy_action_xml_lookup(xml_node_t *node, const char *path)
+ni_fsm_policy_action_xml_lookup(xml_node_t *node, const ni_string_array_t *path)
 {
 	xml_node_array_t *cur;
-	char *copy, *name;
+	unsigned int n;
 
 	if (node->final) {
 		ni_error("%s: called with XML element that's marked final", __func__);
@@ -984,8 +1177,8 @@ ni_fsm_policy_action_xml_lookup(xml_node_t *node, const char *path)
 	cur = xml_node_array_new();
 	xml_node_array_append(cur, node);
 
-	copy = strdup(path);
-	for (name = strtok(copy, "/"); name && cur->count; name = strtok(NULL, "/")) {
+	for (n = 0; n < path->count && cur->count; ++n) {
+		const char *name = path->data[n];
 		xml_node_array_t *next;
 		unsigned int i;
 
@@ -1000,7 +1193,6 @@ ni_fsm_policy_action_xml_lookup(xml_node_t *node, const char *path)
 		cur = next;
 	}
 
-	free(copy);
 	return cur;
 }
 
@@ -1030,7 +1222,7 @@ ni_fsm_policy_action_xml_merge(const ni_fsm_policy_action_t *action, xml_node_t
 		return node;
 	}
 
-	nodes = ni_fsm_policy_action_xml_lookup(node, action->xpath);
+	nodes = ni_fsm_policy_action_xml_lookup(node, &action->xpath_names);
 	if (nodes == NULL)
 		return NULL;
 
@@ -1070,7 +1262,7 @@ ni_fsm_policy_action_xml_replace(const ni_fsm_policy_action_t *action, xml_node_
 		return xml_node_clone_ref(action->data);
 	}
 
-	nodes = ni_fsm_policy_action_xml_lookup(node, action->xpath);
+	nodes = ni_fsm_policy_action_xml_lookup(node, &action->xpath_names);
 	if (nodes == NULL)
 		return NULL;
 
@@ -1270,6 +1462,12 @@ ni_ifcondition_free_args_string(ni_ifcondition_t *cond)
 	ni_string_free(&cond->args.string);
 }
 static void
+ni_ifcondition_free_args_essid(ni_ifcondition_t *cond)
+{
+	free(cond->args.essid);
+	cond->args.essid = NULL;
+}
+static void
 ni_ifcondition_free_args_reference(ni_ifcondition_t *cond)
 {
 	ni_ifcondition_free(cond->args.ref);
@@ -1667,11 +1865,7 @@ ni_fsm_policy_match_device_alias_check(const ni_ifcondition_t *cond, const ni_fs
 static ni_bool_t
 ni_fsm_policy_match_device_ifindex_check(const ni_ifcondition_t *cond, const ni_fsm_t *fsm, ni_ifworker_t *w)
 {
-	unsigned int ifindex;
-
-	if (ni_parse_uint(cond->args.string, &ifindex, 10) < 0 || !ifindex)
-		return FALSE;
-	return ni_ifworker_match_netdev_ifindex(w, ifindex);
+	return ni_ifworker_match_netdev_ifindex(w, cond->args.uint);
 }
 
 static ni_ifcondition_t *
@@ -1684,7 +1878,14 @@ ni_ifcondition_device_element(xml_node_t *node, const char *name)
 		return ni_ifcondition_new_cdata(ni_fsm_policy_match_device_alias_check, node);
 	}
 	if (ni_string_eq(name, "ifindex")) {
-		return ni_ifcondition_new_cdata(ni_fsm_policy_match_device_ifindex_check, node);
+		unsigned int ifindex;
+
+		if (ni_parse_uint(node->cdata, &ifindex, 10) < 0 || !ifindex) {
+			ni_error("%s: invalid device ifindex \"%s\"",
+					xml_node_location(node), node->cdata);
+			return NULL;
+		}
+		return ni_ifcondition_new_uint(ni_fsm_policy_match_device_ifindex_check, ifindex);
 	}
 	ni_error("%s: unknown device condition <%s>", xml_node_location(node), name);
 	return NULL;
@@ -1966,9 +2167,9 @@ ni_ifcondition_reference(xml_node_t *node)
 static ni_bool_t
 ni_fsm_policy_match_wireless_essid_check(const ni_ifcondition_t *cond, const ni_fsm_t *fsm, ni_ifworker_t *w)
 {
+	ni_wireless_ssid_t *ssid = cond->args.essid;
 	ni_netdev_t *dev;
 	ni_wireless_t *wireless;
-	ni_wireless_ssid_t ssid;
 	ni_wireless_bss_t *bss;
 	ni_stringbuf_t sbuf = NI_STRINGBUF_INIT_DYNAMIC;
 
@@ -1978,17 +2179,13 @@ ni_fsm_policy_match_wireless_essid_check(const ni_ifcondition_t *cond, const ni_
 	if (!(bss = wireless->scan.bsss))
 		return FALSE;
 
-	if (!ni_wireless_ssid_parse(&ssid, cond->args.string))
-		return FALSE;
-
-
 	for (; bss; bss = bss->next) {
-		if (!ni_wireless_ssid_eq(&ssid, &bss->ssid))
+		if (!ni_wireless_ssid_eq(ssid, &bss->ssid))
 			continue;
 
 		if (ni_debug_guard(NI_LOG_DEBUG2, NI_TRACE_IFCONFIG)) {
 			ni_trace("%s - ssid `%s` MATCH - bssid:%s age:%u signal:%hd",
-					__func__, ni_wireless_ssid_print(&ssid, &sbuf),
+					__func__, ni_wireless_ssid_print(ssid, &sbuf),
 					ni_link_address_print(&bss->bssid),
 					bss->age, bss->signal );
 			ni_stringbuf_destroy(&sbuf);
@@ -2004,6 +2201,7 @@ ni_ifcondition_wireless_element(xml_node_t *node, const char *name)
 {
 	if (ni_string_eq(name, "essid")) {
 		ni_wireless_ssid_t essid;
+		ni_ifcondition_t *cond;
 
 		if (!ni_wireless_ssid_parse(&essid, node->cdata)) {
 			ni_error("%s: cannot parse essid \"%s\"",
@@ -2011,7 +2209,11 @@ ni_ifcondition_wireless_element(xml_node_t *node, const char *name)
 			return NULL;
 		}
 
-		return ni_ifcondition_new_cdata(ni_fsm_policy_match_wireless_essid_check, node);
+		cond = ni_ifcondition_new(ni_fsm_policy_match_wireless_essid_check);
+		cond->free = ni_ifcondition_free_args_essid;
+		cond->args.essid = xcalloc(1, sizeof(essid));
+		*cond->args.essid = essid;
+		return cond;
 	}
 
 	ni_error("%s: unknown wireless condition <%s>", xml_node_location(node), name);
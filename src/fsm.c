@@ -69,6 +69,10 @@ static inline void		ni_ifworker_update_client_state_config(ni_ifworker_t *w);
 static void			ni_ifworker_update_client_state_scripts(ni_ifworker_t *w);
 static void			ni_fsm_events_destroy(ni_fsm_event_t **);
 static void			ni_fsm_process_event(ni_fsm_t *, ni_fsm_event_t *);
+static void			ni_fsm_async_calls_detach(ni_fsm_t *);
+static void			ni_fsm_schedule_enqueue(ni_fsm_t *, ni_ifworker_t *);
+static void			ni_fsm_schedule_changed(ni_fsm_t *, ni_ifworker_t *);
+static void			ni_fsm_schedule_unthrottle(ni_fsm_t *);
 
 
 ni_fsm_t *
@@ -78,6 +82,7 @@ ni_fsm_new(void)
 
 	fsm = calloc(1, sizeof(*fsm));
 	fsm->readonly = FALSE;
+	fsm->max_async_calls = ni_config_fsm_max_async_calls();
 
 	ni_fsm_user_prompt_fn = ni_fsm_user_prompt_default;
 	return fsm;
@@ -86,9 +91,14 @@ ni_fsm_new(void)
 void
 ni_fsm_free(ni_fsm_t *fsm)
 {
+	ni_fsm_async_calls_detach(fsm);
+	ni_ifworker_array_destroy(&fsm->ready);
+	ni_ifworker_array_destroy(&fsm->blocked);
+	ni_ifworker_array_destroy(&fsm->throttled);
 	ni_fsm_events_destroy(&fsm->events);
 	ni_ifworker_array_destroy(&fsm->pending);
 	ni_ifworker_array_destroy(&fsm->workers);
+	ni_fsm_policy_index_destroy(fsm);
 	free(fsm);
 }
 
@@ -178,17 +188,37 @@ ni_fsm_events_unblock(ni_fsm_t *fsm)
 void
 ni_fsm_process_events(ni_fsm_t *fsm)
 {
-	ni_fsm_event_t *ev;
+	ni_fsm_event_t *ev, *deferred = NULL;
+	ni_ifworker_t *w;
 
 	while ((ev = fsm->events)) {
 		fsm->events = ev->next;
 
+		/* Keep the events of workers waiting for the reply to an
+		 * async call -- they may refer to its callbacks. */
+		w = ni_fsm_ifworker_by_object_path(fsm, ev->object_path);
+		if (w && w->fsm.async_call) {
+			ni_debug_events("%s: defer event signal %s until call reply",
+					w->name, ni_objectmodel_event_to_signal(ev->event_type));
+			ev->next = NULL;
+			ni_fsm_events_append(&deferred, ev);
+			continue;
+		}
+
+		ni_ifworker_get(w);
 		ni_fsm_events_block(fsm);
 		ni_fsm_process_event(fsm, ev);
 		ni_fsm_events_unblock(fsm);
 
+		/* the event may unblock the worker and its dependents */
+		if (w || (w = ni_ifworker_get(ni_fsm_ifworker_by_object_path(fsm, ev->object_path)))) {
+			ni_fsm_schedule_changed(fsm, w);
+			ni_ifworker_release(w);
+		}
+
 		ni_fsm_event_free(ev);
 	}
+	fsm->events = deferred;
 }
 
 /*
@@ -326,6 +356,7 @@ __ni_ifworker_reset_action_table(ni_ifworker_t *w)
 		ni_fsm_require_list_destroy(&action->require.list);
 		ni_ifworker_cancel_callbacks(w, &action->callbacks);
 	}
+	w->fsm.async_call = NULL;
 	w->fsm.wait_for = NULL;
 	w->fsm.next_action = w->fsm.action_table;
 }
@@ -560,6 +591,7 @@ static void
 __ni_ifworker_done(ni_ifworker_t *w)
 {
 	w->done = TRUE;
+	w->fsm.async_call = NULL;
 
 	ni_ifworker_cancel_secondary_timeout(w);
 	ni_ifworker_cancel_timeout(w);
@@ -663,6 +695,8 @@ static void
 ni_fsm_timer_call(void *user_data, const ni_timer_t *timer)
 {
 	ni_fsm_timer_ctx_t *tcx = user_data;
+	ni_ifworker_t *w;
+	ni_fsm_t *fsm;
 
 	if (!timer || !tcx || !tcx->fsm || !tcx->worker || !tcx->timeout_fn) {
 		ni_error("BUG: fsm worker timer call with invalid %s",
@@ -670,8 +704,14 @@ ni_fsm_timer_call(void *user_data, const ni_timer_t *timer)
 		return;
 	}
 
+	fsm = tcx->fsm;
+	w = ni_ifworker_get(tcx->worker);
+
 	tcx->timeout_fn(timer, tcx);
 	ni_fsm_timer_ctx_free(tcx);
+
+	ni_fsm_schedule_changed(fsm, w);
+	ni_ifworker_release(w);
 }
 
 static inline const ni_timer_t *
@@ -3387,6 +3427,9 @@ ni_fsm_destroy_worker(ni_fsm_t *fsm, ni_ifworker_t *w)
 		ni_ifworker_release(w);
 		return;
 	}
+	ni_ifworker_array_remove(&fsm->ready, w);
+	ni_ifworker_array_remove(&fsm->blocked, w);
+	ni_ifworker_array_remove(&fsm->throttled, w);
 
 	ni_ifworker_device_delete(w);
 
@@ -4012,8 +4055,9 @@ ni_fsm_recv_new_netif(ni_fsm_t *fsm, ni_dbus_object_t *object, ni_bool_t refresh
 	ni_ifworker_t *found = NULL;
 	ni_bool_t renamed = FALSE;
 
-	/* note: dev is a not yet reference counted object->handle */
-	if (dev == NULL || dev->name == NULL || refresh) {
+	/* note: dev is a not yet reference counted object->handle;
+	 * a refresh is not needed while property changes are applied */
+	if (dev == NULL || dev->name == NULL || (refresh && !ni_dbus_object_is_synced(object))) {
 		/* keep dev, but wipe out its content (properties) */
 		if (dev)
 			ni_netdev_reset(dev);
@@ -4719,6 +4763,228 @@ ni_ifworker_update_from_request(ni_ifworker_t *w, const char *service, const cha
 	}
 }
 
+/*
+ * Process the result of a call placed for a transition binding.
+ * Returns 0 to continue with the next binding, > 0 when an ignored
+ * failure completes the transition and < 0 when the worker failed.
+ */
+static int
+ni_ifworker_common_call_result(ni_ifworker_t *w, ni_fsm_transition_t *action,
+				const char *service, const char *method, int rv,
+				ni_objectmodel_callback_info_t *callback_list,
+				unsigned int *count)
+{
+	ni_ifworker_update_from_request(w, service, method, rv, callback_list);
+	if (rv < 0) {
+		if (action->common.may_fail) {
+			ni_error("[ignored] %s: call to %s.%s() failed: %s", w->name,
+					service, method, ni_strerror(rv));
+			ni_ifworker_set_state(w, action->next_state);
+			return 1;
+		}
+		ni_ifworker_fail(w, "call to %s.%s() failed: %s", service, method, ni_strerror(rv));
+		return rv;
+	}
+
+	if (callback_list) {
+		ni_debug_application("%s: adding callback for %s.%s()", w->name, service, method);
+		ni_ifworker_add_callbacks(action, callback_list, w->name);
+		(*count)++;
+	}
+	return 0;
+}
+
+static void
+ni_ifworker_common_call_done(ni_ifworker_t *w, ni_fsm_transition_t *action, unsigned int count)
+{
+	/* Reset wait_for if there are no callbacks ... */
+	if (count == 0) {
+		/* ... unless this action requires ACK via event */
+		if (action->next_state != NI_FSM_STATE_DEVICE_DOWN) {
+			ni_ifworker_set_state(w, action->next_state);
+			w->fsm.wait_for = NULL;
+		}
+	}
+}
+
+/*
+ * Asynchronous transition calls.
+ * The bindings of the action are called one after the other, but
+ * without blocking the fsm while waiting for the replies. The worker
+ * keeps waiting for the action, so ni_fsm_schedule leaves it alone
+ * and proceeds with other workers meanwhile.
+ */
+struct ni_fsm_async_call {
+	ni_fsm_async_call_t *	next;
+
+	ni_fsm_t *		fsm;
+	ni_ifworker_t *		worker;
+	ni_fsm_transition_t *	action;
+
+	unsigned int		binding;
+	unsigned int		count;
+	char *			service;
+	char *			method;
+};
+
+static void			ni_ifworker_async_call_reply(int, ni_objectmodel_callback_info_t *, void *);
+
+static ni_fsm_async_call_t *
+ni_fsm_async_call_new(ni_fsm_t *fsm, ni_ifworker_t *w, ni_fsm_transition_t *action)
+{
+	ni_fsm_async_call_t *call;
+
+	call = xcalloc(1, sizeof(*call));
+	call->fsm = fsm;
+	call->worker = ni_ifworker_get(w);
+	call->action = action;
+
+	call->next = fsm->async_calls;
+	fsm->async_calls = call;
+	w->fsm.async_call = call;
+	return call;
+}
+
+static void
+ni_fsm_async_call_free(ni_fsm_async_call_t *call)
+{
+	ni_fsm_async_call_t **pos, *cur;
+
+	if (call->fsm) {
+		for (pos = &call->fsm->async_calls; (cur = *pos); pos = &cur->next) {
+			if (cur == call) {
+				*pos = cur->next;
+				break;
+			}
+		}
+	}
+	if (call->worker->fsm.async_call == call)
+		call->worker->fsm.async_call = NULL;
+	ni_ifworker_release(call->worker);
+
+	ni_string_free(&call->service);
+	ni_string_free(&call->method);
+	free(call);
+}
+
+static void
+ni_fsm_async_calls_detach(ni_fsm_t *fsm)
+{
+	ni_fsm_async_call_t *call;
+
+	/* the pending replies are discarded on arrival */
+	while ((call = fsm->async_calls)) {
+		fsm->async_calls = call->next;
+		call->next = NULL;
+		call->fsm = NULL;
+		if (call->worker->fsm.async_call == call)
+			call->worker->fsm.async_call = NULL;
+	}
+	fsm->num_async_calls = 0;
+}
+
+/*
+ * Place the call for the next binding. Returns 0 when a call is in
+ * flight, > 0 when the transition is complete and < 0 on failure.
+ */
+static int
+ni_ifworker_async_call_next(ni_fsm_async_call_t *call)
+{
+	ni_ifworker_t *w = call->worker;
+	ni_fsm_transition_t *action = call->action;
+	int rv;
+
+	for (; call->binding < action->num_bindings; ++call->binding) {
+		ni_fsm_transition_bind_t *bind = &action->binding[call->binding];
+
+		if (!bind->method || !bind->service)
+			continue;
+
+		if (bind->skip_call)
+			continue;
+
+		ni_string_dup(&call->service, bind->service->name);
+		ni_string_dup(&call->method, bind->method->name);
+
+		ni_debug_application("%s: calling %s.%s() asynchronously", w->name,
+				call->service, call->method);
+
+		rv = ni_call_common_xml_async(w->object, bind->service, bind->method,
+				bind->config, ni_ifworker_error_handler,
+				ni_ifworker_async_call_reply, call);
+		if (rv == 0) {
+			call->fsm->num_async_calls++;
+			return 0;
+		}
+
+		rv = ni_ifworker_common_call_result(w, action, call->service, call->method,
+				rv, NULL, &call->count);
+		if (rv)
+			return rv;
+	}
+
+	ni_ifworker_common_call_done(w, action, call->count);
+	return 1;
+}
+
+static void
+ni_ifworker_async_call_reply(int result, ni_objectmodel_callback_info_t *callback_list, void *user_data)
+{
+	ni_fsm_async_call_t *call = user_data;
+	ni_ifworker_t *w = call->worker;
+	ni_fsm_t *fsm = call->fsm;
+	int rv;
+
+	if (fsm && fsm->num_async_calls) {
+		fsm->num_async_calls--;
+		ni_fsm_schedule_unthrottle(fsm);
+	}
+
+	if (!fsm || w->fsm.async_call != call || w->fsm.wait_for != call->action) {
+		ni_debug_application("%s: discarding stale reply to %s.%s()", w->name,
+				call->service, call->method);
+		while (callback_list) {
+			ni_objectmodel_callback_info_t *cb = callback_list;
+
+			callback_list = cb->next;
+			ni_objectmodel_callback_info_free(cb);
+		}
+		ni_fsm_async_call_free(call);
+		return;
+	}
+
+	ni_ifworker_get(w);
+	ni_fsm_events_block(fsm);
+
+	rv = ni_ifworker_common_call_result(w, call->action, call->service, call->method,
+			result, callback_list, &call->count);
+	if (rv == 0) {
+		call->binding++;
+		rv = ni_ifworker_async_call_next(call);
+	}
+	if (rv != 0)
+		ni_fsm_async_call_free(call);
+
+	ni_fsm_process_events(fsm);
+	ni_fsm_events_unblock(fsm);
+
+	ni_fsm_schedule_changed(fsm, w);
+	ni_ifworker_release(w);
+}
+
+static int
+ni_ifworker_do_common_call_async(ni_fsm_t *fsm, ni_ifworker_t *w, ni_fsm_transition_t *action)
+{
+	ni_fsm_async_call_t *call;
+	int rv;
+
+	call = ni_fsm_async_call_new(fsm, w, action);
+	if ((rv = ni_ifworker_async_call_next(call)) != 0)
+		ni_fsm_async_call_free(call);
+
+	return rv < 0 ? rv : 0;
+}
+
 static int
 ni_ifworker_do_common_call(ni_fsm_t *fsm, ni_ifworker_t *w, ni_fsm_transition_t *action)
 {
@@ -4728,6 +4994,9 @@ ni_ifworker_do_common_call(ni_fsm_t *fsm, ni_ifworker_t *w, ni_fsm_transition_t
 	/* Initially, enable waiting for this action */
 	w->fsm.wait_for = action;
 
+	if (fsm->max_async_calls)
+		return ni_ifworker_do_common_call_async(fsm, w, action);
+
 	for (i = 0; i < action->num_bindings; ++i) {
 		ni_fsm_transition_bind_t *bind = &action->binding[i];
 		ni_objectmodel_callback_info_t *callback_list = NULL;
@@ -4747,41 +5016,16 @@ ni_ifworker_do_common_call(ni_fsm_t *fsm, ni_ifworker_t *w, ni_fsm_transition_t
 
 		rv = ni_call_common_xml(w->object, bind->service, bind->method, bind->config,
 				&callback_list, ni_ifworker_error_handler);
-		ni_ifworker_update_from_request(w, service, method, rv, callback_list);
-		if (rv < 0) {
-			if (action->common.may_fail) {
-				ni_error("[ignored] %s: call to %s.%s() failed: %s", w->name,
-						service, method, ni_strerror(rv));
-				ni_ifworker_set_state(w, action->next_state);
-				ni_string_free(&service);
-				ni_string_free(&method);
-				return 0;
-			}
-			ni_ifworker_fail(w, "call to %s.%s() failed: %s", service, method, ni_strerror(rv));
-			ni_string_free(&service);
-			ni_string_free(&method);
-			return rv;
-		}
-
-		if (callback_list) {
-			ni_debug_application("%s: adding callback for %s.%s()", w->name, service, method);
-			ni_ifworker_add_callbacks(action, callback_list, w->name);
-			count++;
-		}
+		rv = ni_ifworker_common_call_result(w, action, service, method,
+				rv, callback_list, &count);
 
 		ni_string_free(&service);
 		ni_string_free(&method);
+		if (rv)
+			return rv < 0 ? rv : 0;
 	}
 
-	/* Reset wait_for if there are no callbacks ... */
-	if (count == 0) {
-		/* ... unless this action requires ACK via event */
-		if (action->next_state != NI_FSM_STATE_DEVICE_DOWN) {
-			ni_ifworker_set_state(w, action->next_state);
-			w->fsm.wait_for = NULL;
-		}
-	}
-
+	ni_ifworker_common_call_done(w, action, count);
 	return 0;
 }
 
@@ -5115,6 +5359,7 @@ do_it_again:
 
 	/* FIXME: Add <require> targets from the interface document */
 
+	ni_fsm_schedule_enqueue(fsm, w);
 	return 0;
 }
 
@@ -5153,125 +5398,222 @@ ni_fsm_schedule_bind_methods(ni_fsm_t *fsm, ni_ifworker_t *w)
 	return 0;
 }
 
-unsigned int
-ni_fsm_schedule(ni_fsm_t *fsm)
+/*
+ * Scheduling of the workers.
+ * Workers are checked when they are put on the ready queue: when their
+ * transitions have been set up, after they have been processed, when
+ * an event, callback or timeout arrived for them or when a worker they
+ * depend on changed. Workers whose dependencies are not satisfied are
+ * parked as blocked until one of the workers they wait for changed.
+ */
+static void
+ni_fsm_schedule_enqueue(ni_fsm_t *fsm, ni_ifworker_t *w)
 {
-	unsigned int i, waiting, nrequested;
+	if (!fsm || !w)
+		return;
 
-	while (1) {
-		int made_progress = 0;
+	ni_ifworker_array_remove(&fsm->blocked, w);
+	if (ni_ifworker_array_index(&fsm->ready, w) < 0)
+		ni_ifworker_array_append(&fsm->ready, w);
+}
 
-		for (i = 0; i < fsm->workers.count; ++i) {
-			ni_ifworker_t *w = fsm->workers.data[i];
-			ni_fsm_transition_t *action;
-			unsigned int prev_state;
-			int rv;
+static ni_ifworker_t *
+ni_fsm_schedule_dequeue(ni_fsm_t *fsm)
+{
+	ni_ifworker_t *w;
 
-			ni_ifworker_get(w);
+	if (!fsm->ready.count)
+		return NULL;
 
-			if (w->pending)
-				goto release;
+	w = ni_ifworker_get(fsm->ready.data[0]);
+	ni_ifworker_array_remove_index(&fsm->ready, 0);
+	return w;
+}
 
-			if (ni_ifworker_complete(w)) {
-				ni_ifworker_cancel_secondary_timeout(w);
-				ni_ifworker_cancel_timeout(w);
-				goto release;
-			}
+static void
+ni_fsm_schedule_block(ni_fsm_t *fsm, ni_ifworker_array_t *queue, ni_ifworker_t *w)
+{
+	if (ni_ifworker_array_index(queue, w) < 0)
+		ni_ifworker_array_append(queue, w);
+}
 
-			if (!w->kickstarted)
-				w->kickstarted = TRUE;
-
-			/* We requested a change that takes time (such as acquiring
-			 * a DHCP lease). Wait for a notification from wickedd */
-			if (w->fsm.wait_for) {
-				ni_debug_application("%s: state=%s want=%s, wait-for=%s", w->name,
-					ni_ifworker_state_name(w->fsm.state),
-					ni_ifworker_state_name(w->target_state),
-					ni_ifworker_state_name(w->fsm.wait_for->next_state));
-				goto release;
-			}
+/*
+ * Whether the pending transition of w may be waiting for cw
+ */
+static ni_bool_t
+ni_ifworker_waits_for_worker(ni_ifworker_t *w, const ni_ifworker_t *cw)
+{
+	ni_ifworker_check_state_req_check_t *check;
+	ni_ifworker_check_state_req_t *csr;
+	ni_fsm_transition_t *action;
+	ni_fsm_require_t *req;
 
-			action = w->fsm.next_action;
-			if (action->next_state == NI_FSM_STATE_NONE)
-				w->fsm.state = w->target_state;
+	if (w == cw || !(action = w->fsm.next_action))
+		return TRUE;
 
-			if (w->fsm.state == w->target_state) {
-				ni_ifworker_success(w);
-				made_progress = 1;
-				goto release;
-			}
+	for (req = action->require.list; req; req = req->next) {
+		/* we can't tell on what other requirements depend */
+		if (!(csr = ni_ifworker_check_state_req_cast(req)))
+			return TRUE;
 
-			ni_debug_application("%s: state=%s want=%s, next transition is %s -> %s", w->name,
-				ni_ifworker_state_name(w->fsm.state),
-				ni_ifworker_state_name(w->target_state),
-				ni_ifworker_state_name(w->fsm.next_action->from_state),
-				ni_ifworker_state_name(w->fsm.next_action->next_state));
-
-			if (!action->bound) {
-				ni_ifworker_fail(w, "failed to bind services and methods for %s()",
-						action->common.method_name);
-				goto release;
-			}
+		for (check = csr->check; check; check = check->next) {
+			if (!check->worker || check->worker == cw)
+				return TRUE;
+		}
+	}
+	return FALSE;
+}
 
-			if (!ni_ifworker_check_dependencies(fsm, w, action)) {
-				ni_debug_application("%s: defer action (pending dependencies)", w->name);
-				goto release;
-			}
+static void
+ni_fsm_schedule_changed(ni_fsm_t *fsm, ni_ifworker_t *cw)
+{
+	unsigned int i;
 
-			ni_ifworker_cancel_secondary_timeout(w);
+	if (!fsm || !cw)
+		return;
 
-			prev_state = w->fsm.state;
-			ni_fsm_events_block(fsm);
+	ni_fsm_schedule_enqueue(fsm, cw);
 
-			rv = action->call_func(fsm, w, action);
-			if (w->fsm.next_action)
-				w->fsm.next_action++;
+	for (i = 0; i < fsm->blocked.count; ) {
+		ni_ifworker_t *w = fsm->blocked.data[i];
 
-			if (rv >= 0) {
-				made_progress = 1;
+		if (ni_ifworker_waits_for_worker(w, cw)) {
+			ni_fsm_schedule_enqueue(fsm, w);
+		} else {
+			i++;
+		}
+	}
+}
 
-				if (w->fsm.wait_for) {
-					ni_debug_application("%s: waiting for event in state %s",
-						w->name, ni_ifworker_state_name(w->fsm.state));
-				} else {
-					ni_debug_application("%s: successfully transitioned from %s to %s",
-							w->name,
-							ni_ifworker_state_name(prev_state),
-							ni_ifworker_state_name(w->fsm.state));
-				}
-			} else
-			if (!w->failed) {
-				/* The fsm action should really have marked this
-				 * as a failure. shame on the lazy programmer. */
-				ni_ifworker_fail(w, "failed to transition from %s to %s",
-						ni_ifworker_state_name(prev_state),
-						ni_ifworker_state_name(action->next_state));
-			}
+static void
+ni_fsm_schedule_unthrottle(ni_fsm_t *fsm)
+{
+	unsigned int n = fsm->num_async_calls;
 
-			ni_fsm_process_events(fsm);
-			ni_fsm_events_unblock(fsm);
-release:
-			ni_ifworker_release(w);
+	while (fsm->throttled.count && n++ < fsm->max_async_calls) {
+		ni_ifworker_t *w = ni_ifworker_get(fsm->throttled.data[0]);
 
-			ni_dbus_objects_garbage_collect();
-		}
+		ni_ifworker_array_remove_index(&fsm->throttled, 0);
+		ni_fsm_schedule_enqueue(fsm, w);
+		ni_ifworker_release(w);
+	}
+}
 
-		if (!made_progress)
-			break;
+static void
+ni_fsm_schedule_worker(ni_fsm_t *fsm, ni_ifworker_t *w)
+{
+	ni_fsm_transition_t *action;
+	unsigned int prev_state;
+	int rv;
 
-		/* If all the requested workers are done (eg because they failed)
-		 * do not wait for any of the subordinate device which might still be
-		 * in the middle of being set up.
-		 */
-		for (i = nrequested = 0; i < fsm->workers.count; ++i) {
-			ni_ifworker_t *w = fsm->workers.data[i];
+	/* it may have been dropped from the fsm meanwhile */
+	if (ni_ifworker_array_index(&fsm->workers, w) < 0)
+		return;
+
+	if (w->pending)
+		return;
+
+	if (ni_ifworker_complete(w)) {
+		ni_ifworker_cancel_secondary_timeout(w);
+		ni_ifworker_cancel_timeout(w);
+		return;
+	}
+
+	if (!w->kickstarted)
+		w->kickstarted = TRUE;
+
+	/* We requested a change that takes time (such as acquiring
+	 * a DHCP lease). Wait for a notification from wickedd */
+	if (w->fsm.wait_for) {
+		ni_debug_application("%s: state=%s want=%s, wait-for=%s", w->name,
+			ni_ifworker_state_name(w->fsm.state),
+			ni_ifworker_state_name(w->target_state),
+			ni_ifworker_state_name(w->fsm.wait_for->next_state));
+		return;
+	}
+
+	action = w->fsm.next_action;
+	if (action->next_state == NI_FSM_STATE_NONE)
+		w->fsm.state = w->target_state;
+
+	if (w->fsm.state == w->target_state) {
+		ni_ifworker_success(w);
+		ni_fsm_schedule_changed(fsm, w);
+		return;
+	}
+
+	ni_debug_application("%s: state=%s want=%s, next transition is %s -> %s", w->name,
+		ni_ifworker_state_name(w->fsm.state),
+		ni_ifworker_state_name(w->target_state),
+		ni_ifworker_state_name(w->fsm.next_action->from_state),
+		ni_ifworker_state_name(w->fsm.next_action->next_state));
 
-			if (!ni_ifworker_complete(w))
-				nrequested++;
+	if (!action->bound) {
+		ni_ifworker_fail(w, "failed to bind services and methods for %s()",
+				action->common.method_name);
+		ni_fsm_schedule_changed(fsm, w);
+		return;
+	}
+
+	if (!ni_ifworker_check_dependencies(fsm, w, action)) {
+		ni_debug_application("%s: defer action (pending dependencies)", w->name);
+		ni_fsm_schedule_block(fsm, &fsm->blocked, w);
+		return;
+	}
+
+	if (fsm->max_async_calls && fsm->num_async_calls >= fsm->max_async_calls) {
+		ni_debug_application("%s: defer action (%u calls in flight)",
+				w->name, fsm->num_async_calls);
+		ni_fsm_schedule_block(fsm, &fsm->throttled, w);
+		return;
+	}
+
+	ni_ifworker_cancel_secondary_timeout(w);
+
+	prev_state = w->fsm.state;
+	ni_fsm_events_block(fsm);
+
+	rv = action->call_func(fsm, w, action);
+	if (w->fsm.next_action)
+		w->fsm.next_action++;
+
+	if (rv >= 0) {
+		if (w->fsm.wait_for) {
+			ni_debug_application("%s: waiting for event in state %s",
+				w->name, ni_ifworker_state_name(w->fsm.state));
+		} else {
+			ni_debug_application("%s: successfully transitioned from %s to %s",
+					w->name,
+					ni_ifworker_state_name(prev_state),
+					ni_ifworker_state_name(w->fsm.state));
 		}
+	} else
+	if (!w->failed) {
+		/* The fsm action should really have marked this
+		 * as a failure. shame on the lazy programmer. */
+		ni_ifworker_fail(w, "failed to transition from %s to %s",
+				ni_ifworker_state_name(prev_state),
+				ni_ifworker_state_name(action->next_state));
+	}
 
-		if (nrequested == 0)
-			break;
+	ni_fsm_process_events(fsm);
+	ni_fsm_events_unblock(fsm);
+
+	/* proceed with the next transition and wake up its dependents */
+	ni_fsm_schedule_changed(fsm, w);
+}
+
+unsigned int
+ni_fsm_schedule(ni_fsm_t *fsm)
+{
+	unsigned int i, waiting, nrequested;
+	ni_ifworker_t *w;
+
+	while ((w = ni_fsm_schedule_dequeue(fsm)) != NULL) {
+		ni_fsm_schedule_worker(fsm, w);
+		ni_ifworker_release(w);
+
+		ni_dbus_objects_garbage_collect();
 	}
 
 	for (i = waiting = nrequested = 0; i < fsm->workers.count; ++i) {
@@ -5826,6 +6168,8 @@ ni_fsm_create_client(ni_fsm_t *fsm)
 					interface_state_change_signal,
 					fsm);
 
+	ni_dbus_client_track_properties(client, fsm->client_root_object);
+
 	return client;
 }
 
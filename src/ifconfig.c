@@ -139,10 +139,8 @@ static int	__ni_rtnl_link_delete(const ni_netdev_t *);
 static int	__ni_rtnl_link_add_port_up(const ni_netdev_t *, const char *, unsigned int);
 static int	__ni_rtnl_link_add_slave_down(const ni_netdev_t *, const char *, unsigned int);
 
-static int	__ni_rtnl_send_deladdr(ni_netdev_t *, const ni_address_t *);
-static int	__ni_rtnl_send_newaddr(ni_netdev_t *, const ni_address_t *, int);
-static int	__ni_rtnl_send_delroute(ni_netdev_t *, ni_route_t *);
-static int	__ni_rtnl_send_newroute(ni_netdev_t *, ni_route_t *, int);
+static struct nl_msg *	__ni_rtnl_deladdr_msg(ni_netdev_t *, const ni_address_t *);
+static struct nl_msg *	__ni_rtnl_delroute_msg(ni_netdev_t *, ni_route_t *);
 static int	__ni_rtnl_send_newrule(const ni_rule_t *, int);
 static int	__ni_rtnl_send_delrule(const ni_rule_t *);
 
@@ -471,6 +469,8 @@ ni_system_interface_link_change(ni_netdev_t *dev, const ni_netdev_req_t *req)
 int
 __ni_system_interface_flush_addrs(ni_netconfig_t *nc, ni_netdev_t *dev)
 {
+	ni_nl_batch_t *batch;
+	struct nl_msg *msg;
 	ni_address_t *ap;
 
 	 if (!dev || (!nc && !(nc = ni_global_state_handle(0))))
@@ -478,9 +478,13 @@ __ni_system_interface_flush_addrs(ni_netconfig_t *nc, ni_netdev_t *dev)
 
 	 /* TODO: ni_rtnl_query_addr_info + del without to parse */
 	__ni_system_refresh_interface_addrs(nc, dev);
+	batch = ni_nl_batch_new();
 	for (ap = dev->addrs; ap; ap = ap->next) {
-		__ni_rtnl_send_deladdr(dev, ap);
+		if ((msg = __ni_rtnl_deladdr_msg(dev, ap)))
+			ni_nl_batch_add(batch, msg);
 	}
+	ni_nl_batch_commit(batch);
+	ni_nl_batch_free(batch);
 	__ni_system_refresh_interface_addrs(nc, dev);
 	return dev->addrs == NULL ? 0 : 1;
 }
@@ -489,6 +493,8 @@ int
 __ni_system_interface_flush_routes(ni_netconfig_t *nc, ni_netdev_t *dev)
 {
 	ni_route_table_t *tab;
+	ni_nl_batch_t *batch;
+	struct nl_msg *msg;
 	ni_route_t *rp;
 	 unsigned int i;
 
@@ -497,13 +503,17 @@ __ni_system_interface_flush_routes(ni_netconfig_t *nc, ni_netdev_t *dev)
 
 	 /* TODO: ni_rtnl_query_route_info + del without to parse */
 	 __ni_system_refresh_interface_routes(nc, dev);
+	 batch = ni_nl_batch_new();
 	 for (tab = dev->routes; tab; tab = tab->next) {
 		 for (i = 0; i < tab->routes.count; ++i) {
 			if (!(rp = tab->routes.data[i]))
 				continue;
-			__ni_rtnl_send_delroute(dev, rp);
+			if ((msg = __ni_rtnl_delroute_msg(dev, rp)))
+				ni_nl_batch_add(batch, msg);
 		}
 	 }
+	 ni_nl_batch_commit(batch);
+	 ni_nl_batch_free(batch);
 	 __ni_system_refresh_interface_routes(nc, dev);
 	 return dev->routes == NULL ? 0 : 1;
 }
@@ -4548,14 +4558,13 @@ __ni_netdev_address_in_list(ni_address_t *list, const ni_address_t *ap)
 	return NULL;
 }
 
-static int
-__ni_rtnl_send_newaddr(ni_netdev_t *dev, const ni_address_t *ap, int flags)
+static struct nl_msg *
+__ni_rtnl_newaddr_msg(ni_netdev_t *dev, const ni_address_t *ap, int flags)
 {
 	ni_stringbuf_t buf = NI_STRINGBUF_INIT_DYNAMIC;
 	unsigned int omit = IFA_F_TENTATIVE|IFA_F_DADFAILED;
 	struct ifaddrmsg ifa;
 	struct nl_msg *msg;
-	int err;
 
 	ni_debug_ifconfig("%s(%s, %s %s)", __FUNCTION__, dev->name,
 			flags & NLM_F_REPLACE ? "replace " :
@@ -4634,29 +4643,31 @@ __ni_rtnl_send_newaddr(ni_netdev_t *dev, const ni_address_t *ap, int flags)
 			goto nla_put_failure;
 	}
 
-	if ((err = ni_nl_talk(msg, NULL)) && abs(err) != NLE_EXIST) {
-		ni_error("%s(%s/%u): ni_nl_talk failed [%s]", __func__,
-				ni_sockaddr_print(&ap->local_addr),
-				ap->prefixlen,  nl_geterror(err));
-		goto failed;
-	}
-
-	nlmsg_free(msg);
-	return 0;
+	return msg;
 
 nla_put_failure:
 	ni_error("failed to encode netlink attr");
-failed:
 	nlmsg_free(msg);
-	return -1;
+	return NULL;
 }
 
 static int
-__ni_rtnl_send_deladdr(ni_netdev_t *dev, const ni_address_t *ap)
+__ni_rtnl_newaddr_result(const ni_address_t *ap, int err)
+{
+	if (err && abs(err) != NLE_EXIST) {
+		ni_error("%s(%s/%u): ni_nl_talk failed [%s]", __func__,
+				ni_sockaddr_print(&ap->local_addr),
+				ap->prefixlen,  nl_geterror(err));
+		return -1;
+	}
+	return 0;
+}
+
+static struct nl_msg *
+__ni_rtnl_deladdr_msg(ni_netdev_t *dev, const ni_address_t *ap)
 {
 	struct ifaddrmsg ifa;
 	struct nl_msg *msg;
-	int err;
 
 	ni_debug_ifconfig("%s(%s/%u)", __FUNCTION__, ni_sockaddr_print(&ap->local_addr), ap->prefixlen);
 
@@ -4680,33 +4691,35 @@ __ni_rtnl_send_deladdr(ni_netdev_t *dev, const ni_address_t *ap)
 			goto nla_put_failure;
 	}
 
-	if ((err = ni_nl_talk(msg, NULL)) < 0) {
+	return msg;
+
+nla_put_failure:
+	ni_error("failed to encode netlink attr");
+	nlmsg_free(msg);
+	return NULL;
+}
+
+static int
+__ni_rtnl_deladdr_result(const ni_address_t *ap, int err)
+{
+	if (err < 0) {
 		ni_error("%s(%s/%u): rtnl_talk failed: %s", __func__,
 				ni_sockaddr_print(&ap->local_addr),
 				ap->prefixlen,  nl_geterror(err));
-		goto failed;
+		return -1;
 	}
-
-	nlmsg_free(msg);
 	return 0;
-
-nla_put_failure:
-	ni_error("failed to encode netlink attr");
-failed:
-	nlmsg_free(msg);
-	return -1;
 }
 
 /*
  * Add a static route
  */
-static int
-__ni_rtnl_send_newroute(ni_netdev_t *dev, ni_route_t *rp, int flags)
+static struct nl_msg *
+__ni_rtnl_newroute_msg(ni_netdev_t *dev, ni_route_t *rp, int flags)
 {
 	ni_stringbuf_t buf = NI_STRINGBUF_INIT_DYNAMIC;
 	struct rtmsg rt;
 	struct nl_msg *msg;
-	int err;
 
 	ni_debug_ifconfig("%s(%s%s)", __FUNCTION__,
 			flags & NLM_F_REPLACE ? "replace " :
@@ -4892,31 +4905,34 @@ __ni_rtnl_send_newroute(ni_netdev_t *dev, ni_route_t *rp, int flags)
 		nla_nest_end(msg, mxrta);
 	}
 
-	if ((err = ni_nl_talk(msg, NULL)) && abs(err) != NLE_EXIST) {
-		ni_stringbuf_t buf = NI_STRINGBUF_INIT_DYNAMIC;
-		ni_error("%s(%s): ni_nl_talk failed [%s]", __FUNCTION__,
-				ni_route_print(&buf, rp),  nl_geterror(err));
-		ni_stringbuf_destroy(&buf);
-		goto failed;
-	}
-
-	nlmsg_free(msg);
-	return 0;
+	return msg;
 
 nla_put_failure:
 	ni_error("failed to encode netlink attr");
 failed:
 	nlmsg_free(msg);
-	return -NI_ERROR_CANNOT_CONFIGURE_ROUTE;
+	return NULL;
 }
 
 static int
-__ni_rtnl_send_delroute(ni_netdev_t *dev, ni_route_t *rp)
+__ni_rtnl_newroute_result(const ni_route_t *rp, int err)
+{
+	if (err && abs(err) != NLE_EXIST) {
+		ni_stringbuf_t buf = NI_STRINGBUF_INIT_DYNAMIC;
+		ni_error("%s(%s): ni_nl_talk failed [%s]", __FUNCTION__,
+				ni_route_print(&buf, rp),  nl_geterror(err));
+		ni_stringbuf_destroy(&buf);
+		return -NI_ERROR_CANNOT_CONFIGURE_ROUTE;
+	}
+	return 0;
+}
+
+static struct nl_msg *
+__ni_rtnl_delroute_msg(ni_netdev_t *dev, ni_route_t *rp)
 {
 	ni_stringbuf_t buf = NI_STRINGBUF_INIT_DYNAMIC;
 	struct rtmsg rt;
 	struct nl_msg *msg;
-	int err;
 
 	ni_debug_ifconfig("%s(%s)", __FUNCTION__, ni_route_print(&buf, rp));
 	ni_stringbuf_destroy(&buf);
@@ -4946,22 +4962,26 @@ __ni_rtnl_send_delroute(ni_netdev_t *dev, ni_route_t *rp)
 
 	NLA_PUT_U32(msg, RTA_OIF, dev->link.ifindex);
 
-	if ((err = ni_nl_talk(msg, NULL)) < 0) {
+	return msg;
+
+nla_put_failure:
+	ni_error("failed to encode netlink attr");
+	nlmsg_free(msg);
+	return NULL;
+}
+
+static int
+__ni_rtnl_delroute_result(const ni_route_t *rp, int err)
+{
+	if (err < 0) {
+		ni_stringbuf_t buf = NI_STRINGBUF_INIT_DYNAMIC;
 		ni_error("%s(%s): rtnl_talk failed[%d]: %s", __func__,
 				ni_route_print(&buf, rp),
 				err, nl_geterror(err));
 		ni_stringbuf_destroy(&buf);
-		goto failed;
+		return -1;
 	}
-
-	nlmsg_free(msg);
 	return 0;
-
-nla_put_failure:
-	ni_error("failed to encode netlink attr");
-failed:
-	nlmsg_free(msg);
-	return -1;
 }
 
 static int
@@ -5449,6 +5469,17 @@ ni_address_updater_arp_send(ni_addrconf_updater_t *updater, ni_netdev_t *dev)
 	return FALSE;
 }
 
+/*
+ * Address changes queued into a netlink batch, applied to
+ * our address state once the kernel acknowledged them.
+ */
+typedef struct __ni_netdev_addr_op {
+	ni_address_t *		ap;
+	ni_address_t *		new_addr;
+	int			del;
+	int			add;
+} __ni_netdev_addr_op_t;
+
 static int
 __ni_netdev_update_addrs(ni_netdev_t *dev,
 				const ni_addrconf_lease_t *old_lease,
@@ -5460,6 +5491,10 @@ __ni_netdev_update_addrs(ni_netdev_t *dev,
 	ni_address_updater_t *au;
 	unsigned int family = AF_UNSPEC;
 	ni_address_t *ap, *next;
+	__ni_netdev_addr_op_t *ops, *op;
+	unsigned int nops, n;
+	ni_nl_batch_t *batch;
+	struct nl_msg *msg;
 	unsigned int minprio;
 	int rv;
 
@@ -5484,6 +5519,10 @@ __ni_netdev_update_addrs(ni_netdev_t *dev,
 		return -1;
 	}
 
+	ops = xcalloc(NI_ADDRCONF_UPDATER_MAX_ADDR_CHANGES, sizeof(*ops));
+	batch = ni_nl_batch_new();
+	nops = 0;
+
 	for (ap = dev->addrs; ap; ap = next) {
 		ni_address_t *new_addr;
 
@@ -5560,35 +5599,64 @@ __ni_netdev_update_addrs(ni_netdev_t *dev,
 					dev->name,
 					ni_sockaddr_print(&ap->local_addr), ap->prefixlen);
 
-			if (replace < 0)
-				__ni_rtnl_send_deladdr(dev, ap);
+			op = &ops[nops++];
+			op->ap = ap;
+			op->new_addr = new_addr;
+			op->del = op->add = -1;
 
-			if (!ni_address_lft_is_valid(new_addr, NULL))
-				continue;
+			if (replace < 0 && (msg = __ni_rtnl_deladdr_msg(dev, ap)))
+				op->del = ni_nl_batch_add(batch, msg);
 
-			if ((rv = __ni_rtnl_send_newaddr(dev, new_addr, NLM_F_REPLACE)) < 0)
+			if (!ni_address_lft_is_valid(new_addr, NULL))
 				continue;
 
-			new_addr->owner = new_lease->type;
-			ni_address_copy(ap, new_addr);
+			if ((msg = __ni_rtnl_newaddr_msg(dev, new_addr, NLM_F_REPLACE)))
+				op->add = ni_nl_batch_add(batch, msg);
 		} else {
 			if (max_changes == 0)
 				break;
 			else max_changes--;
 
-			if ((rv = __ni_rtnl_send_deladdr(dev, ap)) < 0)
-				continue;
+			op = &ops[nops++];
+			op->ap = ap;
+			op->new_addr = NULL;
+			op->add = -1;
+			op->del = -1;
+
+			if ((msg = __ni_rtnl_deladdr_msg(dev, ap)))
+				op->del = ni_nl_batch_add(batch, msg);
 		}
 	}
 
-	if (max_changes == 0)
+	/* Send the deletes and replaces with as few syscalls as possible */
+	ni_nl_batch_commit(batch);
+	for (n = 0; n < nops; ++n) {
+		op = &ops[n];
+
+		if (op->del >= 0)
+			__ni_rtnl_deladdr_result(op->ap, ni_nl_batch_error(batch, op->del));
+
+		if (op->add < 0 || __ni_rtnl_newaddr_result(op->new_addr,
+					ni_nl_batch_error(batch, op->add)) < 0)
+			continue;
+
+		op->new_addr->owner = new_lease->type;
+		ni_address_copy(op->ap, op->new_addr);
+	}
+	ni_nl_batch_free(batch);
+
+	if (max_changes == 0 ||
+	    (family == AF_INET && ni_address_updater_arp_send(updater, dev))) {
+		free(ops);
 		return 1;
+	}
 
 	/* Loop over all addresses in the configuration and create
 	 * those that don't exist yet.
 	 */
-	if (family == AF_INET && ni_address_updater_arp_send(updater, dev))
-		return 1;
+	batch = ni_nl_batch_new();
+	nops = 0;
+	rv = 0;
 
 	for (ap = new_lease ? new_lease->addrs : NULL ; ap; ap = ap->next) {
 		unsigned int count = 0;
@@ -5620,13 +5688,37 @@ __ni_netdev_update_addrs(ni_netdev_t *dev,
 				ap->prefixlen);
 
 		__ni_netdev_addr_complete(dev, ap);
-		if ((rv = __ni_rtnl_send_newaddr(dev, ap, NLM_F_CREATE)) < 0)
-			return rv;
+		if (!(msg = __ni_rtnl_newaddr_msg(dev, ap, NLM_F_CREATE))) {
+			rv = -1;
+			break;
+		}
+
+		op = &ops[nops++];
+		op->ap = NULL;
+		op->new_addr = ap;
+		op->del = -1;
+		op->add = ni_nl_batch_add(batch, msg);
+	}
+
+	ni_nl_batch_commit(batch);
+	for (n = 0; n < nops; ++n) {
+		op = &ops[n];
+		ap = op->new_addr;
+
+		if (__ni_rtnl_newaddr_result(ap, ni_nl_batch_error(batch, op->add)) < 0) {
+			rv = -1;
+			continue;
+		}
 
 		ap->owner = new_lease->type;
 
 		ni_arp_notify_add_address(&au->notify, ap);
 	}
+	ni_nl_batch_free(batch);
+	free(ops);
+
+	if (rv < 0)
+		return rv;
 
 	if (family == AF_INET && ni_address_updater_arp_send(updater, dev))
 		return 1;
@@ -5695,6 +5787,53 @@ __ni_skip_conflicting_route(ni_netconfig_t *nc, ni_netdev_t *our_dev,
 	return NULL;
 }
 
+/*
+ * Route changes queued into a netlink batch
+ */
+typedef struct __ni_netdev_route_op {
+	ni_route_t *		rp;
+	ni_route_t *		new_route;
+	int			index;
+} __ni_netdev_route_op_t;
+
+typedef struct __ni_netdev_route_ops {
+	unsigned int		count;
+	__ni_netdev_route_op_t *data;
+} __ni_netdev_route_ops_t;
+
+#define NI_NETDEV_ROUTE_OPS_CHUNK	16
+
+static void
+__ni_netdev_route_ops_add(__ni_netdev_route_ops_t *ops, ni_route_t *rp,
+				ni_route_t *new_route, int index)
+{
+	__ni_netdev_route_op_t *op;
+
+	if ((ops->count % NI_NETDEV_ROUTE_OPS_CHUNK) == 0) {
+		size_t size = ops->count + NI_NETDEV_ROUTE_OPS_CHUNK;
+
+		ops->data = xrealloc(ops->data, size * sizeof(*op));
+	}
+	op = &ops->data[ops->count++];
+	op->rp = rp;
+	op->new_route = new_route;
+	op->index = index;
+}
+
+static ni_bool_t
+__ni_netdev_route_ops_conflict(const __ni_netdev_route_ops_t *ops, const ni_route_t *rp)
+{
+	const ni_route_t *rp2;
+	unsigned int i;
+
+	for (i = 0; i < ops->count; ++i) {
+		rp2 = ops->data[i].rp;
+		if (rp->table == rp2->table && ni_route_equal_destination(rp, rp2))
+			return TRUE;
+	}
+	return FALSE;
+}
+
 static int
 __ni_netdev_update_routes(ni_netconfig_t *nc, ni_netdev_t *dev,
 				const ni_addrconf_lease_t *old_lease,
@@ -5705,8 +5844,12 @@ __ni_netdev_update_routes(ni_netconfig_t *nc, ni_netdev_t *dev,
 	unsigned int family = AF_UNSPEC;
 	ni_route_table_t *tab, *cfg_tab;
 	ni_route_t *rp, *new_route;
+	__ni_netdev_route_ops_t ops = { 0, NULL };
+	__ni_netdev_route_op_t *op;
+	ni_nl_batch_t *batch, *retry;
+	struct nl_msg *msg;
 	unsigned int minprio, i;
-	int rv = 0;
+	int rv = 0, err;
 
 	do {
 		__ni_global_seqno++;
@@ -5725,6 +5868,7 @@ __ni_netdev_update_routes(ni_netconfig_t *nc, ni_netdev_t *dev,
 	 * We need to mimic the kernel's matching behavior when modifying
 	 * the configuration of existing routes.
 	 */
+	batch = ni_nl_batch_new();
 	for (tab = dev->routes; tab; tab = tab->next) {
 		for (i = 0; i < tab->routes.count; ++i) {
 			if ((rp = tab->routes.data[i]) == NULL)
@@ -5779,32 +5923,76 @@ __ni_netdev_update_routes(ni_netconfig_t *nc, ni_netdev_t *dev,
 			}
 
 			if (new_route != NULL) {
-				if (__ni_rtnl_send_newroute(dev, new_route, NLM_F_REPLACE) >= 0) {
-					ni_debug_ifconfig("%s: successfully updated existing route %s",
-							dev->name, ni_route_print(&buf, rp));
-					ni_stringbuf_destroy(&buf);
-					new_route->owner = new_lease->type;
-					new_route->seq = __ni_global_seqno;
-					ni_netconfig_route_add(nc, new_route, dev);
-
-					continue;
-				}
-
-				ni_error("%s: failed to update route %s",
-					dev->name, ni_route_print(&buf, rp));
-				ni_stringbuf_destroy(&buf);
+				msg = __ni_rtnl_newroute_msg(dev, new_route, NLM_F_REPLACE);
+				__ni_netdev_route_ops_add(&ops, rp, new_route,
+						msg ? ni_nl_batch_add(batch, msg) : -1);
+				continue;
 			}
 
 			ni_debug_ifconfig("%s: trying to delete existing route %s",
 					dev->name, ni_route_print(&buf, rp));
 			ni_stringbuf_destroy(&buf);
 
-			if ((__ni_rtnl_send_delroute(dev, rp)) < 0) {
-				continue;
-			}
+			if ((msg = __ni_rtnl_delroute_msg(dev, rp)))
+				__ni_netdev_route_ops_add(&ops, rp, NULL, ni_nl_batch_add(batch, msg));
 		}
 	}
 
+	/* Deletes of routes we failed to replace have to be built
+	 * before the successful ones are merged into our tables. */
+	ni_nl_batch_commit(batch);
+	retry = ni_nl_batch_new();
+	for (i = 0; i < ops.count; ++i) {
+		op = &ops.data[i];
+		err = op->index >= 0 ? ni_nl_batch_error(batch, op->index) : -NLE_INVAL;
+
+		if (!op->new_route) {
+			__ni_rtnl_delroute_result(op->rp, err);
+			op->index = -1;
+			continue;
+		}
+		if (op->index >= 0 && __ni_rtnl_newroute_result(op->new_route, err) >= 0)
+			continue;
+
+		ni_error("%s: failed to update route %s",
+			dev->name, ni_route_print(&buf, op->rp));
+		ni_stringbuf_destroy(&buf);
+
+		ni_debug_ifconfig("%s: trying to delete existing route %s",
+				dev->name, ni_route_print(&buf, op->rp));
+		ni_stringbuf_destroy(&buf);
+
+		if ((msg = __ni_rtnl_delroute_msg(dev, op->rp)))
+			op->index = ni_nl_batch_add(retry, msg);
+		else
+			op->index = -1;
+		op->new_route = NULL;
+	}
+	for (i = 0; i < ops.count; ++i) {
+		op = &ops.data[i];
+		if (!op->new_route)
+			continue;
+
+		ni_debug_ifconfig("%s: successfully updated existing route %s",
+				dev->name, ni_route_print(&buf, op->rp));
+		ni_stringbuf_destroy(&buf);
+		op->new_route->owner = new_lease->type;
+		op->new_route->seq = __ni_global_seqno;
+		ni_netconfig_route_add(nc, op->new_route, dev);
+	}
+	ni_nl_batch_free(batch);
+
+	ni_nl_batch_commit(retry);
+	for (i = 0; i < ops.count; ++i) {
+		op = &ops.data[i];
+		if (!op->new_route && op->index >= 0)
+			__ni_rtnl_delroute_result(op->rp, ni_nl_batch_error(retry, op->index));
+	}
+	ni_nl_batch_free(retry);
+
+	batch = ni_nl_batch_new();
+	ops.count = 0;
+
 	/* Loop over all tables and routes in the configuration
 	 * and create those that don't exist yet.
 	 */
@@ -5819,20 +6007,41 @@ __ni_netdev_update_routes(ni_netconfig_t *nc, ni_netdev_t *dev,
 			if (__ni_skip_conflicting_route(nc, dev, new_lease, rp))
 				continue;
 
+			/* not in our tables before the batch is committed */
+			if (__ni_netdev_route_ops_conflict(&ops, rp))
+				continue;
+
 			ni_debug_ifconfig("%s: adding new %s:%s lease route %s",
 					ni_addrfamily_type_to_name(new_lease->family),
 					ni_addrconf_type_to_name(new_lease->type),
 					dev->name, ni_route_print(&buf, rp));
 			ni_stringbuf_destroy(&buf);
 
-			if ((rv = __ni_rtnl_send_newroute(dev, rp, NLM_F_CREATE)) < 0)
-				continue;
+			msg = __ni_rtnl_newroute_msg(dev, rp, NLM_F_CREATE);
+			__ni_netdev_route_ops_add(&ops, rp, NULL,
+					msg ? ni_nl_batch_add(batch, msg) : -1);
+		}
+	}
+
+	ni_nl_batch_commit(batch);
+	for (i = 0; i < ops.count; ++i) {
+		op = &ops.data[i];
+		rp = op->rp;
 
-			rp->owner = new_lease->type;
-			rp->seq = __ni_global_seqno;
-			ni_netconfig_route_add(nc, rp, dev);
+		if (op->index < 0) {
+			rv = -NI_ERROR_CANNOT_CONFIGURE_ROUTE;
+			continue;
 		}
+		err = ni_nl_batch_error(batch, op->index);
+		if ((rv = __ni_rtnl_newroute_result(rp, err)) < 0)
+			continue;
+
+		rp->owner = new_lease->type;
+		rp->seq = __ni_global_seqno;
+		ni_netconfig_route_add(nc, rp, dev);
 	}
+	ni_nl_batch_free(batch);
+	free(ops.data);
 
 	return rv;
 }
@@ -27,6 +27,7 @@
 #include "sysfs.h"
 #include "kernel.h"
 #include "appconfig.h"
+#include "teamd.h"
 
 #ifndef NI_ND_OPT_RDNSS_INFORMATION
 #define NI_ND_OPT_RDNSS_INFORMATION	25	/* RFC 5006 */
@@ -55,10 +56,64 @@ struct ni_nd_opt_dnssl_info_p
 	unsigned char	nd_opt_dnssl_list[];
 };
 
+/*
+ * Latest name of a link within a batch of received events;
+ * the name is NULL when the last event was a deletion.
+ */
+typedef struct ni_rtevent_ifname
+{
+	unsigned int	ifindex;
+	unsigned int	pos;
+	const char *	name;
+} ni_rtevent_ifname_t;
+
+/*
+ * Messages read from the socket until it would block or the receive
+ * pool is full; they are processed once the batch is complete to be
+ * able to look ahead. The messages point into the receive pool.
+ */
+typedef struct ni_rtevent_msg
+{
+	const struct sockaddr_nl *	sender;
+	struct nlmsghdr *		nlh;
+} ni_rtevent_msg_t;
+
+typedef struct ni_rtevent_batch
+{
+	unsigned int		count;
+	ni_rtevent_msg_t *	data;
+
+	unsigned int		nnames;
+	ni_rtevent_ifname_t *	names;
+} ni_rtevent_batch_t;
+
+#define NI_RTEVENT_BATCH_CHUNK		64
+
+/*
+ * Buffers to receive many datagrams with one recvmmsg call
+ */
+typedef struct ni_rtevent_pool
+{
+	unsigned int		vlen;
+	unsigned int		used;
+	size_t			size;
+	unsigned char *		data;
+	struct mmsghdr *	msgs;
+	struct iovec *		iovs;
+	struct sockaddr_nl *	addrs;
+} ni_rtevent_pool_t;
+
+#define NI_RTEVENT_POOL_VLEN		64
+#define NI_RTEVENT_POOL_MSGSIZE		(32 * 1024)
+#define NI_RTEVENT_POOL_MSGSIZE_MAX	(1024 * 1024)
+#define NI_RTEVENT_RECV_BUFF_MAX	(64 * 1024 * 1024)
+
 typedef struct ni_rtevent_handle
 {
 	struct nl_sock *nlsock;
 	ni_uint_array_t	groups;
+	ni_rtevent_batch_t batch;
+	ni_rtevent_pool_t pool;
 } ni_rtevent_handle_t;
 
 /*
@@ -66,6 +121,17 @@ typedef struct ni_rtevent_handle
  */
 static ni_socket_t *	__ni_rtevent_sock;
 
+/*
+ * The batch currently processed, used to resolve link names
+ */
+static const ni_rtevent_batch_t *	__ni_rtevent_current_batch;
+
+/*
+ * Buffer sizes grown after overruns, used when the socket is reopened
+ */
+static unsigned int	__ni_rtevent_recv_buff_len;
+static unsigned int	__ni_rtevent_mesg_buff_len;
+
 static int	__ni_rtevent_process(ni_netconfig_t *, const struct sockaddr_nl *, struct nlmsghdr *);
 static int	__ni_rtevent_newlink(ni_netconfig_t *, const struct sockaddr_nl *, struct nlmsghdr *);
 static int	__ni_rtevent_dellink(ni_netconfig_t *, const struct sockaddr_nl *, struct nlmsghdr *);
@@ -260,6 +326,49 @@ __ni_netdev_process_events(ni_netconfig_t *nc, ni_netdev_t *dev, unsigned int ol
 }
 
 
+/*
+ * Resolve the current name of a link. The events in the read buffer
+ * often carry an already obsolete name, so we use the name from the
+ * latest event about the link in the batch and query the kernel only
+ * when the batch does not contain any.
+ */
+static int
+__ni_rtevent_ifname_cmp(const void *a, const void *b)
+{
+	const ni_rtevent_ifname_t *n1 = a;
+	const ni_rtevent_ifname_t *n2 = b;
+
+	if (n1->ifindex != n2->ifindex)
+		return n1->ifindex < n2->ifindex ? -1 : 1;
+	if (n1->pos != n2->pos)
+		return n1->pos < n2->pos ? -1 : 1;
+	return 0;
+}
+
+static const char *
+__ni_rtevent_ifname(unsigned int ifindex, char *namebuf)
+{
+	const ni_rtevent_batch_t *batch = __ni_rtevent_current_batch;
+	const ni_rtevent_ifname_t *found;
+	unsigned int lo, hi, mid;
+
+	if (batch && batch->nnames) {
+		lo = 0;
+		hi = batch->nnames;
+		while (lo < hi) {
+			mid = lo + (hi - lo) / 2;
+			found = &batch->names[mid];
+			if (found->ifindex == ifindex)
+				return found->name;
+			if (found->ifindex < ifindex)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+	}
+	return if_indextoname(ifindex, namebuf);
+}
+
 /*
  * Process NEWLINK event
  */
@@ -270,17 +379,20 @@ __ni_rtevent_newlink(ni_netconfig_t *nc, const struct sockaddr_nl *nladdr, struc
 	ni_netdev_t *dev, *old;
 	struct ifinfomsg *ifi;
 	struct nlattr *nla;
-	char *ifname = NULL;
+	const char *ifname = NULL;
 	int old_flags = 0;
 
 	if (!(ifi = ni_rtnl_ifinfomsg(h, RTM_NEWLINK)))
 		return -1;
 
-	if (ifi->ifi_family == AF_BRIDGE)
+	if (ifi->ifi_family == AF_BRIDGE) {
+		if ((dev = ni_netdev_by_index(nc, ifi->ifi_index)))
+			__ni_netdev_process_newlink_bridge_port(dev, h, ifi, nc);
 		return 0;
+	}
 
 	old = ni_netdev_by_index(nc, ifi->ifi_index);
-	ifname = if_indextoname(ifi->ifi_index, namebuf);
+	ifname = __ni_rtevent_ifname(ifi->ifi_index, namebuf);
 	if (!ifname) {
 		/*
 		 * device (index) does not exists any more;
@@ -302,7 +414,7 @@ __ni_rtevent_newlink(ni_netconfig_t *nc, const struct sockaddr_nl *nladdr, struc
 		if (!ni_string_eq(old->name, ifname)) {
 			ni_debug_events("%s[%u]: device renamed to %s",
 					old->name, old->link.ifindex, ifname);
-			ni_string_dup(&old->name, ifname);
+			ni_netconfig_device_rename(nc, old, ifname);
 			__ni_netdev_event(nc, old, NI_EVENT_DEVICE_RENAME);
 		}
 		dev = old;
@@ -340,9 +452,9 @@ __ni_rtevent_newlink(ni_netconfig_t *nc, const struct sockaddr_nl *nladdr, struc
 			 * Just update the name of the conflicting device in advance too
 			 * and when the interface does not exist any more, emit events.
 			 */
-			char *current = if_indextoname(conflict->link.ifindex, namebuf);
+			const char *current = __ni_rtevent_ifname(conflict->link.ifindex, namebuf);
 			if (current) {
-				ni_string_dup(&conflict->name, current);
+				ni_netconfig_device_rename(nc, conflict, current);
 				__ni_netdev_event(nc, conflict, NI_EVENT_DEVICE_RENAME);
 			} else {
 				unsigned int ifflags = conflict->link.ifflags;
@@ -398,6 +510,8 @@ __ni_rtevent_dellink(ni_netconfig_t *nc, const struct sockaddr_nl *nladdr, struc
 		dev->deleted = 1;
 		__ni_netdev_process_events(nc, dev, old_flags);
 		ni_client_state_drop(dev->link.ifindex);
+		if (dev->link.type == NI_IFTYPE_TEAM)
+			ni_teamd_client_drop(dev->name);
 		ni_netconfig_device_remove(nc, dev);
 	}
 
@@ -487,6 +601,8 @@ __ni_rtevent_newaddr(ni_netconfig_t *nc, const struct sockaddr_nl *nladdr, struc
 	if (dev == NULL)
 		return 0;
 
+	ni_netconfig_digest_unset_addrs(nc, dev->link.ifindex);
+
 	/*
 	 * Here we just get a const pointer (=what we need)
 	 * to the address stored in the list...
@@ -512,6 +628,8 @@ __ni_rtevent_deladdr(ni_netconfig_t *nc, const struct sockaddr_nl *nladdr, struc
 	if (dev == NULL)
 		return 0;
 
+	ni_netconfig_digest_unset_addrs(nc, dev->link.ifindex);
+
 	if (__ni_rtnl_parse_newaddr(dev->link.ifflags, h, ifa, &tmp) < 0) {
 		ni_error("Problem parsing %s message for %s", dev->name,
 				ni_rtnl_msg_type_to_name(h->nlmsg_type, NULL));
@@ -899,67 +1017,346 @@ __ni_rtevent_nduseropt(ni_netconfig_t *nc, const struct sockaddr_nl *nladdr, str
 }
 
 /*
- * Receive events from netlink socket and generate events.
+ * Batch of received event messages
  */
-static int
-__ni_rtevent_process_cb(struct nl_msg *msg, void *ptr)
+static void
+__ni_rtevent_batch_append(ni_rtevent_batch_t *batch, const struct sockaddr_nl *sender,
+				struct nlmsghdr *nlh)
+{
+	ni_rtevent_msg_t *msg;
+
+	if ((batch->count % NI_RTEVENT_BATCH_CHUNK) == 0) {
+		size_t size = batch->count + NI_RTEVENT_BATCH_CHUNK;
+
+		batch->data = xrealloc(batch->data, size * sizeof(*batch->data));
+	}
+	msg = &batch->data[batch->count++];
+	msg->sender = sender;
+	msg->nlh = nlh;
+}
+
+static void
+__ni_rtevent_batch_reset(ni_rtevent_batch_t *batch)
+{
+	batch->count = 0;
+	batch->nnames = 0;
+}
+
+static void
+__ni_rtevent_batch_destroy(ni_rtevent_batch_t *batch)
 {
-	const struct sockaddr_nl *sender = nlmsg_get_src(msg);
+	__ni_rtevent_batch_reset(batch);
+	free(batch->data);
+	batch->data = NULL;
+	free(batch->names);
+	batch->names = NULL;
+}
+
+/*
+ * Collect the latest link name per ifindex in the batch
+ */
+static void
+__ni_rtevent_batch_index_names(ni_rtevent_batch_t *batch)
+{
+	ni_rtevent_ifname_t *names;
+	struct ifinfomsg *ifi;
 	struct nlmsghdr *nlh;
-	ni_netconfig_t *nc;
+	struct nlattr *nla;
+	unsigned int i, n;
+
+	free(batch->names);
+	batch->names = names = xcalloc(batch->count + 1, sizeof(*names));
+
+	for (n = i = 0; i < batch->count; ++i) {
+		nlh = batch->data[i].nlh;
+		switch (nlh->nlmsg_type) {
+		case RTM_NEWLINK:
+			if (!(ifi = ni_rtnl_ifinfomsg(nlh, RTM_NEWLINK)))
+				continue;
+			nla = nlmsg_find_attr(nlh, sizeof(*ifi), IFLA_IFNAME);
+			if (!nla || !nla_len(nla) || !memchr(nla_data(nla), '\0', nla_len(nla)))
+				continue;
+			names[n].name = nla_get_string(nla);
+			break;
+		case RTM_DELLINK:
+			if (!(ifi = ni_rtnl_ifinfomsg(nlh, RTM_DELLINK)))
+				continue;
+			/* port removal from a bridge, not a link deletion */
+			if (ifi->ifi_family == AF_BRIDGE)
+				continue;
+			names[n].name = NULL;
+			break;
+		default:
+			continue;
+		}
+		names[n].ifindex = ifi->ifi_index;
+		names[n].pos = i;
+		n++;
+	}
 
-	if ((nc = ni_global_state_handle(0)) == NULL)
-		return NL_SKIP;
+	if (n > 1)
+		qsort(names, n, sizeof(*names), __ni_rtevent_ifname_cmp);
 
-	if (sender->nl_pid != 0) {
-		ni_error("ignoring rtnetlink event message from PID %u",
-			sender->nl_pid);
-		return NL_SKIP;
+	/* keep the latest entry per ifindex only */
+	for (batch->nnames = i = 0; i < n; ++i) {
+		if (i + 1 < n && names[i + 1].ifindex == names[i].ifindex)
+			continue;
+		names[batch->nnames++] = names[i];
 	}
+}
+
+static void
+__ni_rtevent_process_msg(ni_netconfig_t *nc, const ni_rtevent_msg_t *msg)
+{
+	struct nlmsghdr *nlh = msg->nlh;
 
-	nlh = nlmsg_hdr(msg);
-	if (__ni_rtevent_process(nc, sender, nlh) < 0) {
+	if (__ni_rtevent_process(nc, msg->sender, nlh) < 0) {
 		ni_debug_events("ignoring %s rtnetlink event",
 			ni_rtnl_msg_type_to_name(nlh->nlmsg_type, "unknown"));
-		return NL_SKIP;
 	}
+}
 
-	return NL_OK;
+static void
+__ni_rtevent_batch_process(ni_rtevent_batch_t *batch)
+{
+	ni_netconfig_t *nc;
+	unsigned int i;
+
+	if (!batch->count)
+		return;
+
+	if ((nc = ni_global_state_handle(0)) != NULL) {
+		__ni_rtevent_batch_index_names(batch);
+		__ni_rtevent_current_batch = batch;
+		for (i = 0; i < batch->count; ++i)
+			__ni_rtevent_process_msg(nc, &batch->data[i]);
+		__ni_rtevent_current_batch = NULL;
+	}
+	__ni_rtevent_batch_reset(batch);
+}
+
+/*
+ * Receive pool handling
+ */
+static void
+__ni_rtevent_pool_destroy(ni_rtevent_pool_t *pool)
+{
+	free(pool->data);
+	free(pool->msgs);
+	free(pool->iovs);
+	free(pool->addrs);
+	memset(pool, 0, sizeof(*pool));
+}
+
+static void
+__ni_rtevent_pool_init(ni_rtevent_pool_t *pool, size_t size)
+{
+	unsigned int i;
+
+	__ni_rtevent_pool_destroy(pool);
+
+	pool->vlen  = NI_RTEVENT_POOL_VLEN;
+	pool->size  = NLMSG_ALIGN(size);
+	pool->data  = xcalloc(pool->vlen, pool->size);
+	pool->msgs  = xcalloc(pool->vlen, sizeof(*pool->msgs));
+	pool->iovs  = xcalloc(pool->vlen, sizeof(*pool->iovs));
+	pool->addrs = xcalloc(pool->vlen, sizeof(*pool->addrs));
+
+	for (i = 0; i < pool->vlen; ++i) {
+		pool->iovs[i].iov_base = pool->data + i * pool->size;
+		pool->iovs[i].iov_len  = pool->size;
+	}
+}
+
+static int
+__ni_rtevent_pool_recv(ni_rtevent_pool_t *pool, int fd)
+{
+	unsigned int i, vlen = pool->vlen - pool->used;
+	struct mmsghdr *msgs = pool->msgs + pool->used;
+	int n;
+
+	for (i = 0; i < vlen; ++i) {
+		struct msghdr *mh = &msgs[i].msg_hdr;
+
+		memset(&msgs[i], 0, sizeof(msgs[i]));
+		mh->msg_name = &pool->addrs[pool->used + i];
+		mh->msg_namelen = sizeof(pool->addrs[0]);
+		mh->msg_iov = &pool->iovs[pool->used + i];
+		mh->msg_iovlen = 1;
+	}
+
+#ifdef HAVE_RECVMMSG
+	n = recvmmsg(fd, msgs, vlen, MSG_DONTWAIT, NULL);
+#else
+	n = recvmsg(fd, &msgs[0].msg_hdr, MSG_DONTWAIT);
+	if (n >= 0) {
+		msgs[0].msg_len = n;
+		n = 1;
+	}
+#endif
+	return n;
+}
+
+/*
+ * Queue the messages of the received datagrams to the batch;
+ * returns FALSE when a datagram did not fit into its buffer.
+ */
+static ni_bool_t
+__ni_rtevent_pool_parse(ni_rtevent_pool_t *pool, ni_rtevent_batch_t *batch,
+			unsigned int first, unsigned int count)
+{
+	const struct sockaddr_nl *sender;
+	struct nlmsghdr *nlh;
+	ni_bool_t complete = TRUE;
+	unsigned int i, len;
+
+	for (i = first; i < first + count; ++i) {
+		sender = &pool->addrs[i];
+		if (pool->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+			ni_error("rtnetlink event message truncated to %zu bytes",
+					pool->size);
+			complete = FALSE;
+			continue;
+		}
+		if (sender->nl_pid != 0) {
+			ni_error("ignoring rtnetlink event message from PID %u",
+				sender->nl_pid);
+			continue;
+		}
+
+		len = pool->msgs[i].msg_len;
+		nlh = pool->iovs[i].iov_base;
+		for ( ; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+			switch (nlh->nlmsg_type) {
+			case NLMSG_NOOP:
+			case NLMSG_DONE:
+			case NLMSG_ERROR:
+			case NLMSG_OVERRUN:
+				continue;
+			default:
+				__ni_rtevent_batch_append(batch, sender, nlh);
+				break;
+			}
+		}
+	}
+	return complete;
+}
+
+/*
+ * Grow the buffers for the socket we reopen after an overrun
+ */
+static void
+__ni_rtevent_grow_recv_buff(int fd)
+{
+	unsigned int len = 0;
+	socklen_t optlen = sizeof(len);
+
+	/* the kernel reports the doubled (accounting) size */
+	if (getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &len, &optlen) == 0)
+		len /= 2;
+
+	if (len < __ni_rtevent_recv_buff_len)
+		len = __ni_rtevent_recv_buff_len;
+	if (len >= NI_RTEVENT_RECV_BUFF_MAX)
+		return;
+
+	__ni_rtevent_recv_buff_len = len ? len * 2 : 1024 * 1024;
+	if (__ni_rtevent_recv_buff_len > NI_RTEVENT_RECV_BUFF_MAX)
+		__ni_rtevent_recv_buff_len = NI_RTEVENT_RECV_BUFF_MAX;
+
+	ni_note("increasing netlink event receive buffer to %u bytes after overrun",
+			__ni_rtevent_recv_buff_len);
+}
+
+static void
+__ni_rtevent_grow_mesg_buff(const ni_rtevent_pool_t *pool)
+{
+	if (pool->size >= NI_RTEVENT_POOL_MSGSIZE_MAX)
+		return;
+
+	__ni_rtevent_mesg_buff_len = pool->size * 2;
+	ni_note("increasing netlink event message buffer to %u bytes",
+			__ni_rtevent_mesg_buff_len);
 }
 
 static ni_bool_t	__ni_rtevent_restart(ni_socket_t *sock);
 
+/*
+ * Restart the listener and catch up with the events lost meanwhile
+ */
+static void
+__ni_rtevent_recover(ni_socket_t *sock)
+{
+	ni_netconfig_t *nc;
+
+	if (!__ni_rtevent_restart(sock)) {
+		ni_error("unable to restart rtnetlink event listener");
+		return;
+	}
+	ni_note("restarted rtnetlink event listener");
+
+	if (!(nc = ni_global_state_handle(0)) || !ni_netconfig_devlist(nc))
+		return;
+
+	if (__ni_system_resync(nc) < 0)
+		ni_error("unable to resync with the kernel after rtnetlink event loss");
+}
+
 
 /*
- * Receive netlink message and trigger processing by callback
+ * Drain the netlink socket with as few syscalls as possible
+ * and process the received messages in batches.
  */
 static void
 __ni_rtevent_receive(ni_socket_t *sock)
 {
 	ni_rtevent_handle_t *handle = sock->user_data;
-	int ret;
+	ni_rtevent_pool_t *pool;
+	ni_bool_t complete = TRUE;
+	int n, err = 0;
 
-	if (handle && handle->nlsock) {
-		do {
-			ret = nl_recvmsgs_default(handle->nlsock);
-		} while (ret == NLE_SUCCESS || ret == -NLE_INTR);
+	if (!handle || !handle->nlsock)
+		return;
 
-		switch (ret) {
-		case NLE_SUCCESS:
-		case -NLE_AGAIN:
+	pool = &handle->pool;
+	for (;;) {
+		n = __ni_rtevent_pool_recv(pool, sock->__fd);
+		if (n < 0) {
+			if ((err = errno) == EINTR)
+				continue;
 			break;
-
-		default:
-			ni_error("rtnetlink event receive error: %s (%m)",
-					nl_geterror(ret));
-			if (__ni_rtevent_restart(sock)) {
-				ni_note("restarted rtnetlink event listener");
-			} else {
-				ni_error("unable to restart rtnetlink event listener");
-			}
+		}
+		if (n == 0)
 			break;
+
+		if (!__ni_rtevent_pool_parse(pool, &handle->batch, pool->used, n))
+			complete = FALSE;
+		pool->used += n;
+
+		/* the pool is full, process before we reuse the buffers */
+		if (pool->used >= pool->vlen) {
+			__ni_rtevent_batch_process(&handle->batch);
+			pool->used = 0;
 		}
 	}
+
+	/* process the queued events before any error recovery */
+	__ni_rtevent_batch_process(&handle->batch);
+	pool->used = 0;
+
+	if (err == ENOBUFS) {
+		ni_error("rtnetlink event receive buffer overrun");
+		__ni_rtevent_grow_recv_buff(sock->__fd);
+		__ni_rtevent_recover(sock);
+	} else
+	if (err && err != EAGAIN && err != EWOULDBLOCK) {
+		ni_error("rtnetlink event receive error: %s", strerror(err));
+		__ni_rtevent_recover(sock);
+	} else
+	if (!complete) {
+		__ni_rtevent_grow_mesg_buff(pool);
+		__ni_rtevent_recover(sock);
+	}
 }
 
 /*
@@ -993,6 +1390,8 @@ __ni_rtevent_handle_free(ni_rtevent_handle_t *handle)
 			handle->nlsock = NULL;
 		}
 		ni_uint_array_destroy(&handle->groups);
+		__ni_rtevent_batch_destroy(&handle->batch);
+		__ni_rtevent_pool_destroy(&handle->pool);
 		free(handle);
 	}
 }
@@ -1024,12 +1423,16 @@ __ni_rtevent_join_group(ni_rtevent_handle_t *handle, unsigned int group)
 static void
 __ni_rtevent_sock_error_handler(ni_socket_t *sock)
 {
-	ni_error("poll error on rtnetlink event socket: %m");
-	if (__ni_rtevent_restart(sock)) {
-		ni_note("restarted rtnetlink event listener");
+	socklen_t len = sizeof(int);
+	int err = 0;
+
+	if (getsockopt(sock->__fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == ENOBUFS) {
+		ni_error("rtnetlink event receive buffer overrun");
+		__ni_rtevent_grow_recv_buff(sock->__fd);
 	} else {
-		ni_error("unable to restart rtnetlink event listener");
+		ni_error("poll error on rtnetlink event socket: %m");
 	}
+	__ni_rtevent_recover(sock);
 }
 
 static void
@@ -1041,13 +1444,17 @@ __ni_rtevent_sock_release_data(void *user_data)
 static unsigned int
 __ni_rtevent_config_recv_buff_len(void)
 {
-	return ni_global.config ? ni_global.config->rtnl_event.recv_buff_length : 0;
+	unsigned int len = ni_global.config ? ni_global.config->rtnl_event.recv_buff_length : 0;
+
+	return max_t(unsigned int, len, __ni_rtevent_recv_buff_len);
 }
 
 static unsigned int
 __ni_rtevent_config_mesg_buff_len(void)
 {
-	return ni_global.config ? ni_global.config->rtnl_event.mesg_buff_length : 0;
+	unsigned int len = ni_global.config ? ni_global.config->rtnl_event.mesg_buff_length : 0;
+
+	return max_t(unsigned int, len, __ni_rtevent_mesg_buff_len);
 }
 
 static ni_socket_t *
@@ -1070,13 +1477,6 @@ __ni_rtevent_sock_open(void)
 		return NULL;
 	}
 
-	/*
-	 * Modify the callback for processing valid messages...
-	 * We may pass some kind of data (event filter?) too...
-	 */
-	nl_socket_modify_cb(handle->nlsock, NL_CB_VALID, NL_CB_CUSTOM,
-				__ni_rtevent_process_cb, NULL);
-
 	/* Required to receive async event notifications */
 	nl_socket_disable_seq_check(handle->nlsock);
 
@@ -1109,14 +1509,12 @@ __ni_rtevent_sock_open(void)
 		}
 	}
 	if (mesg_buff_len) {
-		if (nl_socket_set_msg_buf_size(handle->nlsock, mesg_buff_len)) {
-			ni_warn("Unable to set netlink event message buffer to %u bytes",
-					mesg_buff_len);
-		} else {
-			ni_info("Using netlink event message buffer of %u bytes",
-					mesg_buff_len);
-		}
+		ni_info("Using netlink event message buffer of %u bytes",
+				mesg_buff_len);
+	} else {
+		mesg_buff_len = NI_RTEVENT_POOL_MSGSIZE;
 	}
+	__ni_rtevent_pool_init(&handle->pool, mesg_buff_len);
 
 	sock->user_data	= handle;
 	sock->receive	= __ni_rtevent_receive;
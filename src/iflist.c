@@ -69,7 +69,7 @@ static int		__ni_netdev_process_newroute(ni_netdev_t *, struct nlmsghdr *,
 					struct rtmsg *, ni_netconfig_t *);
 static int		__ni_netdev_process_newrule(struct nlmsghdr *, struct fib_rule_hdr *,
 					ni_netconfig_t *);
-static int		__ni_discover_bridge(ni_netdev_t *);
+static int		__ni_discover_bridge(ni_netdev_t *, struct nlattr **);
 static int		__ni_discover_bond(ni_netdev_t *, struct nlattr **, ni_netconfig_t *);
 static int		__ni_discover_addrconf(ni_netdev_t *);
 static int		__ni_discover_infiniband(ni_netdev_t *, ni_netconfig_t *);
@@ -99,16 +99,18 @@ struct ni_rtnl_query {
 };
 
 /*
- * Query netlink for all relevant information
+ * Query netlink for all relevant information; the ifindex and table
+ * filters are applied by the kernel when it supports strict checks.
  */
 static inline int
-__ni_rtnl_query(struct ni_rtnl_info *qr, int af, int type)
+__ni_rtnl_query_filter(struct ni_rtnl_info *qr, int af, int type,
+			unsigned int ifindex, unsigned int table)
 {
 	int rv;
 
 	ni_nlmsg_list_init(&qr->nlmsg_list);
 retry:
-	rv = ni_nl_dump_store(af, type, &qr->nlmsg_list);
+	rv = ni_nl_dump_store_filter(af, type, ifindex, table, &qr->nlmsg_list);
 	switch (rv) {
 	case NLE_SUCCESS:
 		qr->entry = qr->nlmsg_list.head;
@@ -123,6 +125,12 @@ retry:
 	return rv;
 }
 
+static inline int
+__ni_rtnl_query(struct ni_rtnl_info *qr, int af, int type)
+{
+	return __ni_rtnl_query_filter(qr, af, type, 0, 0);
+}
+
 static inline struct nlmsghdr *
 __ni_rtnl_info_next(struct ni_rtnl_info *qr)
 {
@@ -154,8 +162,8 @@ ni_rtnl_query(struct ni_rtnl_query *q, unsigned int ifindex, unsigned int family
 
 	if (__ni_rtnl_query(&q->link_info, AF_UNSPEC, RTM_GETLINK) < 0
 	 || (family != AF_INET && __ni_rtnl_query(&q->ipv6_info, AF_INET6, RTM_GETLINK) < 0)
-	 || __ni_rtnl_query(&q->addr_info, family, RTM_GETADDR) < 0
-	 || __ni_rtnl_query(&q->route_info, family, RTM_GETROUTE) < 0) {
+	 || __ni_rtnl_query_filter(&q->addr_info, family, RTM_GETADDR, ifindex, 0) < 0
+	 || __ni_rtnl_query_filter(&q->route_info, family, RTM_GETROUTE, ifindex, 0) < 0) {
 		ni_rtnl_query_destroy(q);
 		return -1;
 	}
@@ -235,7 +243,7 @@ ni_rtnl_query_addr_info(struct ni_rtnl_query *q, unsigned int ifindex, unsigned
 	memset(q, 0, sizeof(*q));
 	q->ifindex = ifindex;
 
-	if (__ni_rtnl_query(&q->addr_info, family, RTM_GETADDR) < 0) {
+	if (__ni_rtnl_query_filter(&q->addr_info, family, RTM_GETADDR, ifindex, 0) < 0) {
 		ni_rtnl_query_destroy(q);
 		return -1;
 	}
@@ -262,11 +270,11 @@ ni_rtnl_query_next_addr_info(struct ni_rtnl_query *q, struct nlmsghdr **hp)
 }
 
 static int
-ni_rtnl_query_route_info(struct ni_rtnl_query *q, unsigned int family)
+ni_rtnl_query_route_info(struct ni_rtnl_query *q, unsigned int ifindex, unsigned int family)
 {
 	memset(q, 0, sizeof(*q));
 
-	if (__ni_rtnl_query(&q->route_info, family, RTM_GETROUTE) < 0) {
+	if (__ni_rtnl_query_filter(&q->route_info, family, RTM_GETROUTE, ifindex, 0) < 0) {
 		ni_rtnl_query_destroy(q);
 		return -1;
 	}
@@ -365,15 +373,15 @@ ni_route_tables_reset_seq(ni_route_table_t *tab)
 }
 
 static void
-ni_route_array_drop_by_seq(ni_netconfig_t *nc, ni_route_array_t *routes, unsigned int seq)
+ni_route_table_drop_by_seq(ni_netconfig_t *nc, ni_route_table_t *tab, unsigned int seq)
 {
 	unsigned int i;
 	ni_route_t *rp;
 
-	for (i = 0; i < routes->count; ) {
-		rp = routes->data[i];
+	for (i = 0; i < tab->routes.count; ) {
+		rp = tab->routes.data[i];
 		if (rp->seq != seq) {
-			if (ni_route_array_remove(routes, i) == rp) {
+			if (ni_route_table_remove(tab, i) == rp) {
 				ni_netconfig_route_del(nc, rp, NULL);
 				ni_route_free(rp);
 				continue;
@@ -387,7 +395,75 @@ static void
 ni_route_tables_drop_by_seq(ni_netconfig_t *nc, ni_route_table_t *tab, unsigned int seq)
 {
 	for ( ; tab; tab = tab->next)
-		ni_route_array_drop_by_seq(nc, &tab->routes, seq);
+		ni_route_table_drop_by_seq(nc, tab, seq);
+}
+
+static void
+ni_address_list_reset_family_seq(ni_address_t *addrs, unsigned int family)
+{
+	ni_address_t *ap;
+
+	for (ap = addrs; ap; ap = ap->next) {
+		if (ap->family == family)
+			ap->seq = 0;
+	}
+}
+
+static void
+ni_address_list_drop_family_by_seq(ni_address_t **tail, unsigned int family, unsigned int seq)
+{
+	ni_address_t *ap;
+
+	while ((ap = *tail)) {
+		if (ap->family == family && ap->seq != seq) {
+			*tail = ap->next;
+			ni_address_free(ap);
+		} else {
+			tail = &ap->next;
+		}
+	}
+}
+
+static void
+ni_route_tables_reset_table_seq(ni_route_table_t *tab, unsigned int family, unsigned int table)
+{
+	unsigned int i;
+	ni_route_t *rp;
+
+	for ( ; tab; tab = tab->next) {
+		if (tab->tid != table)
+			continue;
+
+		for (i = 0; i < tab->routes.count; ++i) {
+			if ((rp = tab->routes.data[i]) && rp->family == family)
+				rp->seq = 0;
+		}
+	}
+}
+
+static void
+ni_route_tables_drop_table_by_seq(ni_netconfig_t *nc, ni_route_table_t *tab,
+			unsigned int family, unsigned int table, unsigned int seq)
+{
+	unsigned int i;
+	ni_route_t *rp;
+
+	for ( ; tab; tab = tab->next) {
+		if (tab->tid != table)
+			continue;
+
+		for (i = 0; i < tab->routes.count; ) {
+			rp = tab->routes.data[i];
+			if (rp->family == family && rp->seq != seq) {
+				if (ni_route_table_remove(tab, i) == rp) {
+					ni_netconfig_route_del(nc, rp, NULL);
+					ni_route_free(rp);
+					continue;
+				}
+			}
+			i++;
+		}
+	}
 }
 
 static void
@@ -436,6 +512,16 @@ __ni_refresh_bonding_master_bind(ni_netdev_t *master, ni_linkinfo_t *link, const
 	ni_bonding_slave_set_info(slave, link->slave.bond);
 }
 
+static inline void
+__ni_refresh_bridge_master_bind(ni_netdev_t *master, ni_linkinfo_t *link, const char *ifname)
+{
+	const ni_netdev_ref_t ref = { .name = (char *)ifname, .index = link->ifindex };
+	ni_bridge_port_t *port;
+
+	port = ni_bridge_bind_port(ni_netdev_get_bridge(master), &ref, master->name);
+	ni_bridge_port_set_info(port, link->slave.bridge);
+}
+
 static void
 __ni_refresh_bind_master(ni_netconfig_t *nc, ni_netdev_t *dev)
 {
@@ -457,6 +543,9 @@ __ni_refresh_bind_master(ni_netconfig_t *nc, ni_netdev_t *dev)
 	case NI_IFTYPE_BOND:
 		__ni_refresh_bonding_master_bind(master, &dev->link, dev->name);
 		break;
+	case NI_IFTYPE_BRIDGE:
+		__ni_refresh_bridge_master_bind(master, &dev->link, dev->name);
+		break;
 
 	default:
 		break;
@@ -483,6 +572,14 @@ __ni_refresh_bonding_master_unbind(ni_netdev_t *master, ni_linkinfo_t *link, con
 	ni_bonding_unbind_slave(master->bonding, &ref, master->name);
 }
 
+static inline void
+__ni_refresh_bridge_master_unbind(ni_netdev_t *master, ni_linkinfo_t *link, const char *ifname)
+{
+	const ni_netdev_ref_t ref = { .name = (char *)ifname, .index = link->ifindex };
+
+	ni_bridge_unbind_port(master->bridge, &ref, master->name);
+}
+
 static void
 __ni_refresh_unbind_master(ni_netconfig_t *nc, ni_netdev_t *dev)
 {
@@ -501,6 +598,9 @@ __ni_refresh_unbind_master(ni_netconfig_t *nc, ni_netdev_t *dev)
 	case NI_IFTYPE_BOND:
 		__ni_refresh_bonding_master_unbind(master, &dev->link, dev->name);
 		break;
+	case NI_IFTYPE_BRIDGE:
+		__ni_refresh_bridge_master_unbind(master, &dev->link, dev->name);
+		break;
 
 	default:
 		break;
@@ -515,6 +615,10 @@ int
 __ni_system_refresh_interfaces(ni_netconfig_t *nc)
 {
 	ni_assert(nc == ni_global_state_handle(0));
+
+	/* discover everything once, then re-process changes only */
+	if (ni_netconfig_devlist(nc))
+		return __ni_system_resync(nc);
 	return __ni_system_refresh_all(nc, NULL);
 }
 
@@ -574,12 +678,12 @@ __ni_system_refresh_all(ni_netconfig_t *nc, ni_netdev_t **del_list)
 			if ((pci_dev = ni_sysfs_netdev_get_pci(ifname)) != NULL)
 				ni_netdev_set_pci(dev, pci_dev);
 
-			/* FIXME: use ni_netconfig_device_append() */
+			/* append to tail, avoiding a list walk per device */
 			*tail = dev;
 			tail = &dev->next;
+			ni_netconfig_device_hash_add(nc, dev);
 		} else {
-			if (!ni_string_eq(dev->name, ifname))
-				ni_string_dup(&dev->name, ifname);
+			ni_netconfig_device_rename(nc, dev, ifname);
 
 			/* Clear out addresses and routes */
 			ni_address_list_reset_seq(dev->addrs);
@@ -636,10 +740,12 @@ __ni_system_refresh_all(ni_netconfig_t *nc, ni_netdev_t **del_list)
 	/* Cull any interfaces that went away */
 	tail = ni_netconfig_device_list_head(nc);
 	while ((dev = *tail) != NULL) {
+		ni_netconfig_digest_unset_addrs(nc, dev->link.ifindex);
 		ni_address_list_drop_by_seq(&dev->addrs, seqno);
 		ni_route_tables_drop_by_seq(nc, dev->routes, seqno);
 		if (dev->seq != seqno) {
 			*tail = dev->next;
+			ni_netconfig_device_hash_del(nc, dev);
 			if (del_list == NULL) {
 				__ni_refresh_unbind_master(nc, dev);
 				ni_client_state_drop(dev->link.ifindex);
@@ -667,6 +773,499 @@ failed:
 	return res;
 }
 
+/*
+ * Content digests of rtnetlink messages for the incremental resync.
+ * Counters and timestamps changing on their own are left out, so the
+ * digest changes only when we would see a different object.
+ */
+#define NI_RTNL_DIGEST_INIT	14695981039346656037ULL
+#define NI_RTNL_DIGEST_PRIME	1099511628211ULL
+
+#ifndef RTA_EXPIRES
+#define NI_RTA_EXPIRES		23	/* linux >= 4.15 */
+#else
+#define NI_RTA_EXPIRES		RTA_EXPIRES
+#endif
+
+static inline uint64_t
+__ni_rtnl_digest(uint64_t hash, const void *data, size_t len)
+{
+	const unsigned char *ptr = data;
+
+	while (len--) {
+		hash ^= *ptr++;
+		hash *= NI_RTNL_DIGEST_PRIME;
+	}
+	return hash;
+}
+
+static inline uint64_t
+__ni_rtnl_digest_done(uint64_t hash)
+{
+	return hash ? hash : 1;
+}
+
+static uint64_t
+__ni_rtnl_digest_inet6(uint64_t hash, struct nlattr *nest)
+{
+	struct nlattr *nla;
+	int rem;
+
+	hash = __ni_rtnl_digest(hash, nest, NLA_HDRLEN);
+	nla_for_each_nested(nla, nest, rem) {
+		switch (nla_type(nla)) {
+		case IFLA_INET6_STATS:
+		case IFLA_INET6_ICMP6STATS:
+			break;
+		default:
+			hash = __ni_rtnl_digest(hash, nla, nla->nla_len);
+			break;
+		}
+	}
+	return hash;
+}
+
+static uint64_t
+__ni_rtnl_digest_link(struct nlmsghdr *h, struct ifinfomsg *ifi)
+{
+	uint64_t hash = NI_RTNL_DIGEST_INIT;
+	struct nlattr *nla, *af;
+	int rem, len;
+
+	hash = __ni_rtnl_digest(hash, ifi, sizeof(*ifi));
+	nlmsg_for_each_attr(nla, h, sizeof(*ifi), rem) {
+		switch (nla_type(nla)) {
+		case IFLA_STATS:
+		case IFLA_STATS64:
+			break;
+
+		case IFLA_AF_SPEC:
+			hash = __ni_rtnl_digest(hash, nla, NLA_HDRLEN);
+			nla_for_each_nested(af, nla, len) {
+				if (nla_type(af) == AF_INET6)
+					hash = __ni_rtnl_digest_inet6(hash, af);
+				else
+					hash = __ni_rtnl_digest(hash, af, af->nla_len);
+			}
+			break;
+
+		case IFLA_PROTINFO:
+			if (ifi->ifi_family == AF_INET6) {
+				hash = __ni_rtnl_digest_inet6(hash, nla);
+				break;
+			}
+			/* fall through */
+		default:
+			hash = __ni_rtnl_digest(hash, nla, nla->nla_len);
+			break;
+		}
+	}
+	return __ni_rtnl_digest_done(hash);
+}
+
+static uint64_t
+__ni_rtnl_digest_addr(struct nlmsghdr *h, struct ifaddrmsg *ifa)
+{
+	uint64_t hash = NI_RTNL_DIGEST_INIT;
+	const struct ifa_cacheinfo *ci;
+	struct nlattr *nla;
+	int rem;
+
+	hash = __ni_rtnl_digest(hash, ifa, sizeof(*ifa));
+	nlmsg_for_each_attr(nla, h, sizeof(*ifa), rem) {
+		switch (nla_type(nla)) {
+		case IFA_CACHEINFO:
+			/* lifetimes count down, tstamp tells about updates */
+			if ((ci = __ni_nla_get_data(sizeof(*ci), nla))) {
+				hash = __ni_rtnl_digest(hash, &ci->cstamp, sizeof(ci->cstamp));
+				hash = __ni_rtnl_digest(hash, &ci->tstamp, sizeof(ci->tstamp));
+			}
+			break;
+		default:
+			hash = __ni_rtnl_digest(hash, nla, nla->nla_len);
+			break;
+		}
+	}
+	return __ni_rtnl_digest_done(hash);
+}
+
+static uint64_t
+__ni_rtnl_digest_route(struct nlmsghdr *h, struct rtmsg *rtm, unsigned int *table)
+{
+	uint64_t hash = NI_RTNL_DIGEST_INIT;
+	struct nlattr *nla;
+	int rem;
+
+	*table = rtm->rtm_table;
+	hash = __ni_rtnl_digest(hash, rtm, sizeof(*rtm));
+	nlmsg_for_each_attr(nla, h, sizeof(*rtm), rem) {
+		switch (nla_type(nla)) {
+		case RTA_CACHEINFO:
+		case NI_RTA_EXPIRES:
+			break;
+		case RTA_TABLE:
+			*table = nla_get_u32(nla);
+			/* fall through */
+		default:
+			hash = __ni_rtnl_digest(hash, nla, nla->nla_len);
+			break;
+		}
+	}
+	return __ni_rtnl_digest_done(hash);
+}
+
+static ni_bool_t
+__ni_resync_digest_changed(ni_netconfig_t *nc, uint64_t key, uint64_t digest)
+{
+	return !digest || digest != ni_netconfig_digests_get(ni_netconfig_digests(nc), key);
+}
+
+static void
+__ni_resync_links(ni_netconfig_t *nc, struct ni_rtnl_query *query, unsigned int seqno,
+			ni_netconfig_resync_stats_t *stats)
+{
+	ni_netdev_t **tail, *dev;
+	struct nlmsghdr *h;
+
+	tail = ni_netconfig_device_list_head(nc);
+	while ((dev = *tail) != NULL)
+		tail = &dev->next;
+
+	while (1) {
+		struct ifinfomsg *ifi;
+		struct nlattr *nla;
+		uint64_t digest, key;
+		char *ifname = NULL;
+
+		if (!(ifi = ni_rtnl_query_next_link_info(query, &h)))
+			break;
+
+		if ((nla = nlmsg_find_attr(h, sizeof(*ifi), IFLA_IFNAME)) == NULL) {
+			ni_warn("RTM_NEWLINK message without IFNAME");
+			continue;
+		}
+		ifname = nla_get_string(nla);
+
+		stats->links++;
+		digest = __ni_rtnl_digest_link(h, ifi);
+		key = NI_NETCONFIG_DIGEST_KEY(NI_NETCONFIG_DIGEST_LINK, AF_UNSPEC, ifi->ifi_index);
+
+		if ((dev = ni_netdev_by_index(nc, ifi->ifi_index)) == NULL) {
+			ni_pci_dev_t *pci_dev;
+
+			if (!(dev = ni_netdev_new(ifname, ifi->ifi_index)))
+				continue;
+
+			if ((pci_dev = ni_sysfs_netdev_get_pci(ifname)) != NULL)
+				ni_netdev_set_pci(dev, pci_dev);
+
+			*tail = dev;
+			tail = &dev->next;
+			ni_netconfig_device_hash_add(nc, dev);
+		} else {
+			ni_netconfig_device_rename(nc, dev, ifname);
+			if (!__ni_resync_digest_changed(nc, key, digest)) {
+				dev->seq = seqno;
+				continue;
+			}
+		}
+
+		dev->seq = seqno;
+		stats->links_changed++;
+		if (__ni_netdev_process_newlink(dev, h, ifi, nc) < 0)
+			ni_error("Problem parsing RTM_NEWLINK message for %s", ifname);
+		else
+			ni_netconfig_digests_set(ni_netconfig_digests(nc), key, digest);
+	}
+
+	/* Cull any interfaces that went away */
+	tail = ni_netconfig_device_list_head(nc);
+	while ((dev = *tail) != NULL) {
+		if (dev->seq != seqno) {
+			*tail = dev->next;
+			ni_netconfig_device_hash_del(nc, dev);
+			__ni_refresh_unbind_master(nc, dev);
+			ni_client_state_drop(dev->link.ifindex);
+			ni_netdev_put(dev);
+			stats->links_removed++;
+		} else {
+			tail = &dev->next;
+		}
+	}
+
+	for (dev = ni_netconfig_devlist(nc); dev; dev = dev->next) {
+		__ni_refresh_bind_master(nc, dev);
+		__ni_refresh_bind_lower(nc, dev);
+	}
+}
+
+static void
+__ni_resync_ipv6_links(ni_netconfig_t *nc, struct ni_rtnl_query *query)
+{
+	struct nlmsghdr *h;
+	ni_netdev_t *dev;
+
+	while (1) {
+		struct ifinfomsg *ifi;
+		uint64_t digest, key;
+
+		if (!(ifi = ni_rtnl_query_next_ipv6_link_info(query, &h)))
+			break;
+
+		if ((dev = ni_netdev_by_index(nc, ifi->ifi_index)) == NULL)
+			continue;
+
+		digest = __ni_rtnl_digest_link(h, ifi);
+		key = NI_NETCONFIG_DIGEST_KEY(NI_NETCONFIG_DIGEST_IPV6, AF_INET6, ifi->ifi_index);
+		if (!__ni_resync_digest_changed(nc, key, digest))
+			continue;
+
+		if (__ni_netdev_process_newlink_ipv6(dev, h, ifi) < 0)
+			ni_error("Problem parsing IPv6 RTM_NEWLINK message for %s", dev->name);
+		else
+			ni_netconfig_digests_set(ni_netconfig_digests(nc), key, digest);
+	}
+}
+
+static void
+__ni_resync_addrs(ni_netconfig_t *nc, struct ni_rtnl_query *query, unsigned int family,
+			unsigned int seqno, ni_netconfig_resync_stats_t *stats)
+{
+	ni_netconfig_digests_t current = NI_NETCONFIG_DIGESTS_INIT;
+	ni_netconfig_digests_t changed = NI_NETCONFIG_DIGESTS_INIT;
+	struct nlmsghdr *h;
+	struct ifaddrmsg *ifa;
+	ni_address_t *ap;
+	ni_netdev_t *dev;
+	uint64_t digest;
+
+	/* order independent per-device digest over all its addresses */
+	query->addr_info.entry = query->addr_info.nlmsg_list.head;
+	while ((ifa = ni_rtnl_query_next_addr_info(query, &h))) {
+		if (ifa->ifa_family != family)
+			continue;
+
+		stats->addrs++;
+		digest = ni_netconfig_digests_get(&current, ifa->ifa_index);
+		digest += __ni_rtnl_digest_addr(h, ifa);
+		ni_netconfig_digests_set(&current, ifa->ifa_index, __ni_rtnl_digest_done(digest));
+	}
+
+	for (dev = ni_netconfig_devlist(nc); dev; dev = dev->next) {
+		digest = ni_netconfig_digests_get(&current, dev->link.ifindex);
+		if (!digest) {
+			/* no addresses in the kernel -- any to drop? */
+			for (ap = dev->addrs; ap; ap = ap->next) {
+				if (ap->family == family)
+					break;
+			}
+			if (!ap)
+				continue;
+		} else
+		if (!__ni_resync_digest_changed(nc, NI_NETCONFIG_DIGEST_KEY(
+				NI_NETCONFIG_DIGEST_ADDRS, family, dev->link.ifindex), digest))
+			continue;
+
+		ni_netconfig_digests_set(&changed, dev->link.ifindex, 1);
+		ni_address_list_reset_family_seq(dev->addrs, family);
+	}
+
+	query->addr_info.entry = query->addr_info.nlmsg_list.head;
+	while ((ifa = ni_rtnl_query_next_addr_info(query, &h))) {
+		if (ifa->ifa_family != family)
+			continue;
+		if (!ni_netconfig_digests_get(&changed, ifa->ifa_index))
+			continue;
+		if ((dev = ni_netdev_by_index(nc, ifa->ifa_index)) == NULL)
+			continue;
+
+		stats->addrs_changed++;
+		if (__ni_netdev_process_newaddr(dev, h, ifa) < 0)
+			ni_error("Problem parsing RTM_NEWADDR message for %s", dev->name);
+	}
+
+	for (dev = ni_netconfig_devlist(nc); dev; dev = dev->next) {
+		if (!ni_netconfig_digests_get(&changed, dev->link.ifindex))
+			continue;
+
+		ni_address_list_drop_family_by_seq(&dev->addrs, family, seqno);
+		ni_netconfig_digests_set(ni_netconfig_digests(nc), NI_NETCONFIG_DIGEST_KEY(
+				NI_NETCONFIG_DIGEST_ADDRS, family, dev->link.ifindex),
+				ni_netconfig_digests_get(&current, dev->link.ifindex));
+	}
+
+	ni_netconfig_digests_destroy(&current);
+	ni_netconfig_digests_destroy(&changed);
+}
+
+static void
+__ni_resync_routes(ni_netconfig_t *nc, struct ni_rtnl_query *query, unsigned int family,
+			ni_netconfig_resync_stats_t *stats)
+{
+	unsigned int seqno = __ni_global_seqno; /* used by newroute processing */
+	ni_netconfig_digests_t current = NI_NETCONFIG_DIGESTS_INIT;
+	ni_netconfig_digests_t changed = NI_NETCONFIG_DIGESTS_INIT;
+	ni_route_table_t *tab;
+	struct nlmsghdr *h;
+	struct rtmsg *rtm;
+	unsigned int table, i;
+	ni_netdev_t *dev;
+	uint64_t digest;
+	ni_route_t *rp;
+
+	/* order independent per-table digest over all its routes */
+	query->route_info.entry = query->route_info.nlmsg_list.head;
+	while ((rtm = ni_rtnl_query_next_route_info(query, &h))) {
+		if (rtm->rtm_family != family || ni_rtnl_route_filter_msg(rtm))
+			continue;
+
+		stats->routes++;
+		digest = __ni_rtnl_digest_route(h, rtm, &table);
+		digest += ni_netconfig_digests_get(&current, table);
+		ni_netconfig_digests_set(&current, table, __ni_rtnl_digest_done(digest));
+	}
+
+	for (i = 0; i < current.count; ++i) {
+		table = current.data[i].key;
+		if (__ni_resync_digest_changed(nc, NI_NETCONFIG_DIGEST_KEY(
+				NI_NETCONFIG_DIGEST_ROUTES, family, table), current.data[i].value))
+			ni_netconfig_digests_set(&changed, table, 1);
+	}
+
+	/* tables we track but the kernel does not report any more */
+	for (dev = ni_netconfig_devlist(nc); dev; dev = dev->next) {
+		for (tab = dev->routes; tab; tab = tab->next) {
+			if (ni_netconfig_digests_get(&current, tab->tid))
+				continue;
+
+			for (i = 0; i < tab->routes.count; ++i) {
+				if ((rp = tab->routes.data[i]) && rp->family == family) {
+					ni_netconfig_digests_set(&changed, tab->tid, 1);
+					break;
+				}
+			}
+		}
+	}
+
+	if (!changed.count)
+		goto done;
+
+	for (dev = ni_netconfig_devlist(nc); dev; dev = dev->next) {
+		for (i = 0; i < changed.count; ++i)
+			ni_route_tables_reset_table_seq(dev->routes, family, changed.data[i].key);
+	}
+
+	query->route_info.entry = query->route_info.nlmsg_list.head;
+	while ((rtm = ni_rtnl_query_next_route_info(query, &h))) {
+		if (rtm->rtm_family != family || ni_rtnl_route_filter_msg(rtm))
+			continue;
+
+		__ni_rtnl_digest_route(h, rtm, &table);
+		if (!ni_netconfig_digests_get(&changed, table))
+			continue;
+
+		stats->routes_changed++;
+		if (__ni_netdev_process_newroute(NULL, h, rtm, nc) < 0)
+			ni_error("Problem parsing RTM_NEWROUTE message");
+	}
+
+	for (i = 0; i < changed.count; ++i) {
+		table = changed.data[i].key;
+
+		for (dev = ni_netconfig_devlist(nc); dev; dev = dev->next)
+			ni_route_tables_drop_table_by_seq(nc, dev->routes, family, table, seqno);
+
+		/* processing invalidates, record the digest as the last step */
+		ni_netconfig_digests_set(ni_netconfig_digests(nc), NI_NETCONFIG_DIGEST_KEY(
+				NI_NETCONFIG_DIGEST_ROUTES, family, table),
+				ni_netconfig_digests_get(&current, table));
+		stats->tables_changed++;
+	}
+
+done:
+	ni_netconfig_digests_destroy(&current);
+	ni_netconfig_digests_destroy(&changed);
+}
+
+/*
+ * Incremental resync with the kernel, e.g. after an event overrun.
+ *
+ * Dumps the links and, per address family, the addresses and routes,
+ * but re-processes only links, per-device address sets and per-table
+ * routes whose content digest differs from the one recorded when they
+ * were processed last. Event processing invalidates the digests of the
+ * objects it touches, so a skip never hides a divergent state.
+ */
+int
+__ni_system_resync(ni_netconfig_t *nc)
+{
+	static const unsigned int families[] = { AF_INET, AF_INET6 };
+	ni_netconfig_resync_stats_t *total = ni_netconfig_resync_stats(nc);
+	ni_netconfig_resync_stats_t stats;
+	struct ni_rtnl_query query;
+	unsigned int seqno, filter, i;
+	int res = -1;
+
+	do {
+		seqno = ++__ni_global_seqno;
+	} while (!seqno);
+
+	memset(&stats, 0, sizeof(stats));
+	memset(&query, 0, sizeof(query));
+	filter = ni_netconfig_get_family_filter(nc);
+
+	if (__ni_rtnl_query(&query.link_info, AF_UNSPEC, RTM_GETLINK) < 0)
+		goto failed;
+	__ni_resync_links(nc, &query, seqno, &stats);
+
+	if (filter != AF_INET) {
+		if (__ni_rtnl_query(&query.ipv6_info, AF_INET6, RTM_GETLINK) < 0)
+			goto failed;
+		__ni_resync_ipv6_links(nc, &query);
+	}
+
+	for (i = 0; i < sizeof(families)/sizeof(families[0]); ++i) {
+		if (filter != AF_UNSPEC && filter != families[i])
+			continue;
+
+		if (__ni_rtnl_query(&query.addr_info, families[i], RTM_GETADDR) < 0)
+			goto failed;
+		__ni_resync_addrs(nc, &query, families[i], seqno, &stats);
+		ni_nlmsg_list_destroy(&query.addr_info.nlmsg_list);
+
+		if (__ni_rtnl_query(&query.route_info, families[i], RTM_GETROUTE) < 0)
+			goto failed;
+		__ni_resync_routes(nc, &query, families[i], &stats);
+		ni_nlmsg_list_destroy(&query.route_info.nlmsg_list);
+	}
+
+	if (!ni_netconfig_discover_filtered(nc, NI_NETCONFIG_DISCOVER_ROUTE_RULES))
+		(void)__ni_system_refresh_rules(nc);
+
+	ni_debug_verbose(NI_LOG_DEBUG, NI_TRACE_EVENTS,
+			"Resync processed %u/%u links (%u removed), %u/%u addresses, "
+			"%u/%u routes in %u tables",
+			stats.links_changed, stats.links, stats.links_removed,
+			stats.addrs_changed, stats.addrs,
+			stats.routes_changed, stats.routes, stats.tables_changed);
+	res = 0;
+
+failed:
+	if (total) {
+		total->runs++;
+		total->links		+= stats.links;
+		total->links_changed	+= stats.links_changed;
+		total->links_removed	+= stats.links_removed;
+		total->addrs		+= stats.addrs;
+		total->addrs_changed	+= stats.addrs_changed;
+		total->routes		+= stats.routes;
+		total->routes_changed	+= stats.routes_changed;
+		total->tables_changed	+= stats.tables_changed;
+	}
+	ni_rtnl_query_destroy(&query);
+	return res;
+}
+
 /*
  * Refresh one interfaces
  */
@@ -688,6 +1287,7 @@ __ni_system_refresh_interface(ni_netconfig_t *nc, ni_netdev_t *dev)
 	if (ni_rtnl_query(&query, dev->link.ifindex, ni_netconfig_get_family_filter(nc)) < 0)
 		goto failed;
 
+	ni_netconfig_digest_unset_addrs(nc, dev->link.ifindex);
 	dev->seq = 0;
 	while (1) {
 		struct ifinfomsg *ifi;
@@ -703,8 +1303,7 @@ __ni_system_refresh_interface(ni_netconfig_t *nc, ni_netdev_t *dev)
 		}
 
 		ifname = nla_get_string(nla);
-		if (!ni_string_eq(dev->name, ifname))
-			ni_string_dup(&dev->name, ifname);
+		ni_netconfig_device_rename(nc, dev, ifname);
 
 		/* Clear out addresses and routes */
 		dev->seq = __ni_global_seqno;
@@ -769,6 +1368,7 @@ __ni_system_refresh_addrs(ni_netconfig_t *nc, unsigned int family)
 		goto failed;
 
 	for (dev = ni_netconfig_devlist(nc); dev; dev = dev->next) {
+		ni_netconfig_digest_unset_addrs(nc, dev->link.ifindex);
 		ni_address_list_reset_seq(dev->addrs);
 		dev->seq = seqno;
 	}
@@ -814,6 +1414,7 @@ __ni_system_refresh_interface_addrs(ni_netconfig_t *nc, ni_netdev_t *dev)
 	if (ni_rtnl_query_addr_info(&query, dev->link.ifindex, ni_netconfig_get_family_filter(nc)) < 0)
 		goto failed;
 
+	ni_netconfig_digest_unset_addrs(nc, dev->link.ifindex);
 	ni_address_list_reset_seq(dev->addrs);
 	while (1) {
 		struct ifaddrmsg *ifa;
@@ -890,7 +1491,7 @@ __ni_system_refresh_routes(ni_netconfig_t *nc)
 		seqno = ++__ni_global_seqno;
 	} while (!seqno);
 
-	if (ni_rtnl_query_route_info(&query, ni_netconfig_get_family_filter(nc)) < 0)
+	if (ni_rtnl_query_route_info(&query, 0, ni_netconfig_get_family_filter(nc)) < 0)
 		goto failed;
 
 	for (dev = ni_netconfig_devlist(nc); dev; dev = dev->next)
@@ -931,7 +1532,7 @@ __ni_system_refresh_interface_routes(ni_netconfig_t *nc, ni_netdev_t *dev)
 		dev->seq = ++__ni_global_seqno;
 	} while (!dev->seq);
 
-	if (ni_rtnl_query_route_info(&query, ni_netconfig_get_family_filter(nc)) < 0)
+	if (ni_rtnl_query_route_info(&query, dev->link.ifindex, ni_netconfig_get_family_filter(nc)) < 0)
 		goto failed;
 
 	ni_route_tables_reset_seq(dev->routes);
@@ -1010,6 +1611,9 @@ __ni_device_refresh_ipv6_link_info(ni_netconfig_t *nc, ni_netdev_t *dev)
 	if ((rv = ni_rtnl_query_ipv6_link(&query, dev->link.ifindex)) < 0)
 		goto done;
 
+	ni_netconfig_digest_unset(nc, NI_NETCONFIG_DIGEST_KEY(
+			NI_NETCONFIG_DIGEST_IPV6, AF_INET6, dev->link.ifindex));
+
 	while (1) {
 		struct ifinfomsg *ifi;
 
@@ -1095,7 +1699,7 @@ __ni_process_ifinfomsg_ovs_type(ni_iftype_t *type, const char *ifname, ni_netcon
 	if (ni_netconfig_discover_filtered(nc, NI_NETCONFIG_DISCOVER_LINK_EXTERN))
 		return;
 
-	if (ni_ovs_vsctl_bridge_exists(ifname) == 0)
+	if (ni_ovs_bridge_exists(ifname) == 0)
 		*type = NI_IFTYPE_OVS_BRIDGE;
 }
 
@@ -1251,6 +1855,9 @@ __ni_process_ifinfomsg_masterdev_unbind(ni_linkinfo_t *link, const char *ifname,
 		case NI_IFTYPE_BOND:
 			ni_bonding_unbind_slave(master->bonding, &ref, master->name);
 			break;
+		case NI_IFTYPE_BRIDGE:
+			ni_bridge_unbind_port(master->bridge, &ref, master->name);
+			break;
 		default:
 			break;
 		}
@@ -1270,6 +1877,9 @@ __ni_process_ifinfomsg_masterdev_bind(ni_linkinfo_t *link, const char *ifname,
 		case NI_IFTYPE_BOND:
 			ni_bonding_bind_slave(master->bonding, &ref, master->name);
 			break;
+		case NI_IFTYPE_BRIDGE:
+			ni_bridge_bind_port(ni_netdev_get_bridge(master), &ref, master->name);
+			break;
 		default:
 			break;
 		}
@@ -1399,6 +2009,101 @@ __ni_process_ifinfomsg_bond_slave_data(ni_linkinfo_t *link, const char *ifname,
 	}
 }
 
+#ifdef HAVE_IFLA_BR_ROOT_ID
+static void
+__ni_bridge_id_format(char **str, const struct nlattr *nla)
+{
+	const struct ifla_bridge_id *id;
+	char buf[sizeof("ffff.ffffffffffff")];
+
+	if (nla_len(nla) < (int)sizeof(*id))
+		return;
+
+	/* same format as in the sysfs *_id files */
+	id = nla_data(nla);
+	snprintf(buf, sizeof(buf), "%.2x%.2x.%.2x%.2x%.2x%.2x%.2x%.2x",
+			id->prio[0], id->prio[1],
+			id->addr[0], id->addr[1], id->addr[2],
+			id->addr[3], id->addr[4], id->addr[5]);
+	ni_string_dup(str, buf);
+}
+#endif
+
+/*
+ * Parse IFLA_BRPORT_* attrs provided as bridge slave data and in
+ * AF_BRIDGE IFLA_PROTINFO; returns whether the status is complete.
+ */
+static ni_bool_t
+__ni_process_ifinfomsg_bridge_port_data(ni_bridge_port_t *port, const char *ifname, struct nlattr *data)
+{
+	/* static const */ struct nla_policy	__port_policy[IFLA_BRPORT_MAX+1] = {
+		[IFLA_BRPORT_STATE]			= { .type = NLA_U8	},
+		[IFLA_BRPORT_PRIORITY]			= { .type = NLA_U16	},
+		[IFLA_BRPORT_COST]			= { .type = NLA_U32	},
+		[IFLA_BRPORT_MODE]			= { .type = NLA_U8	},
+#ifdef HAVE_IFLA_BR_ROOT_ID
+		[IFLA_BRPORT_ROOT_ID]			= { .minlen = sizeof(struct ifla_bridge_id) },
+		[IFLA_BRPORT_BRIDGE_ID]			= { .minlen = sizeof(struct ifla_bridge_id) },
+		[IFLA_BRPORT_DESIGNATED_PORT]		= { .type = NLA_U16	},
+		[IFLA_BRPORT_DESIGNATED_COST]		= { .type = NLA_U16	},
+		[IFLA_BRPORT_ID]			= { .type = NLA_U16	},
+		[IFLA_BRPORT_NO]			= { .type = NLA_U16	},
+		[IFLA_BRPORT_TOPOLOGY_CHANGE_ACK]	= { .type = NLA_U8	},
+		[IFLA_BRPORT_CONFIG_PENDING]		= { .type = NLA_U8	},
+		[IFLA_BRPORT_MESSAGE_AGE_TIMER]		= { .type = NLA_U64	},
+		[IFLA_BRPORT_FORWARD_DELAY_TIMER]	= { .type = NLA_U64	},
+		[IFLA_BRPORT_HOLD_TIMER]		= { .type = NLA_U64	},
+#endif
+	};
+	struct nlattr *tb[IFLA_BRPORT_MAX+1];
+	ni_bridge_port_status_t *ps = &port->status;
+
+	if (nla_parse_nested(tb, IFLA_BRPORT_MAX, data, __port_policy) < 0) {
+		ni_error("%s: unable to parse bridge port data", ifname);
+		return FALSE;
+	}
+
+	if (tb[IFLA_BRPORT_PRIORITY])
+		port->priority = ps->priority = nla_get_u16(tb[IFLA_BRPORT_PRIORITY]);
+	if (tb[IFLA_BRPORT_COST])
+		port->path_cost = ps->path_cost = nla_get_u32(tb[IFLA_BRPORT_COST]);
+	if (tb[IFLA_BRPORT_STATE])
+		ps->state = nla_get_u8(tb[IFLA_BRPORT_STATE]);
+	if (tb[IFLA_BRPORT_MODE])
+		ps->hairpin_mode = nla_get_u8(tb[IFLA_BRPORT_MODE]);
+
+#ifdef HAVE_IFLA_BR_ROOT_ID
+	if (!tb[IFLA_BRPORT_ROOT_ID])
+		return FALSE;
+
+	__ni_bridge_id_format(&ps->designated_root, tb[IFLA_BRPORT_ROOT_ID]);
+	if (tb[IFLA_BRPORT_BRIDGE_ID])
+		__ni_bridge_id_format(&ps->designated_bridge, tb[IFLA_BRPORT_BRIDGE_ID]);
+	if (tb[IFLA_BRPORT_DESIGNATED_PORT])
+		ps->designated_port = nla_get_u16(tb[IFLA_BRPORT_DESIGNATED_PORT]);
+	if (tb[IFLA_BRPORT_DESIGNATED_COST])
+		ps->designated_cost = nla_get_u16(tb[IFLA_BRPORT_DESIGNATED_COST]);
+	if (tb[IFLA_BRPORT_ID])
+		ps->port_id = nla_get_u16(tb[IFLA_BRPORT_ID]);
+	if (tb[IFLA_BRPORT_NO])
+		ps->port_no = nla_get_u16(tb[IFLA_BRPORT_NO]);
+	if (tb[IFLA_BRPORT_TOPOLOGY_CHANGE_ACK])
+		ps->change_ack = nla_get_u8(tb[IFLA_BRPORT_TOPOLOGY_CHANGE_ACK]);
+	if (tb[IFLA_BRPORT_CONFIG_PENDING])
+		ps->config_pending = nla_get_u8(tb[IFLA_BRPORT_CONFIG_PENDING]);
+	if (tb[IFLA_BRPORT_MESSAGE_AGE_TIMER])
+		ps->message_age_timer = nla_get_u64(tb[IFLA_BRPORT_MESSAGE_AGE_TIMER]);
+	if (tb[IFLA_BRPORT_FORWARD_DELAY_TIMER])
+		ps->forward_delay_timer = nla_get_u64(tb[IFLA_BRPORT_FORWARD_DELAY_TIMER]);
+	if (tb[IFLA_BRPORT_HOLD_TIMER])
+		ps->hold_timer = nla_get_u64(tb[IFLA_BRPORT_HOLD_TIMER]);
+
+	return TRUE;
+#else
+	return FALSE;
+#endif
+}
+
 static inline void
 __ni_process_ifinfomsg_slave_data(ni_linkinfo_t *link, const char *ifname,
 		ni_netdev_t *master, const char *kind, struct nlattr *data)
@@ -1436,6 +2141,29 @@ __ni_process_ifinfomsg_slave_data(ni_linkinfo_t *link, const char *ifname,
 			__ni_process_ifinfomsg_bond_slave_data(link, ifname, data);
 		break;
 
+	case NI_IFTYPE_BRIDGE:
+		if (master && master->link.type != link->slave.type) {
+			ni_warn("%s: master %s link type does not match slaveinfo kind type",
+					master->name, ifname);
+			return;
+		}
+
+		if (!data) {
+			ni_debug_verbose(NI_LOG_DEBUG2, NI_TRACE_EVENTS,
+					"%s: slave info does not provide any data", ifname);
+			return;
+		}
+
+		link->slave.bridge = ni_bridge_port_new(NULL, ifname, link->ifindex);
+		if (!__ni_process_ifinfomsg_bridge_port_data(link->slave.bridge, ifname, data))
+			ni_sysfs_bridge_port_get_status(ifname, &link->slave.bridge->status);
+
+		if (master) {
+			ni_bridge_port_set_info(ni_bridge_port_by_index(master->bridge,
+						link->ifindex), link->slave.bridge);
+		}
+		break;
+
 	default:
 		break;
 	}
@@ -1832,6 +2560,28 @@ __ni_process_ifinfomsg_af_spec(ni_netdev_t *dev, struct nlattr *ifla_af_spec, ni
 	return 0;
 }
 
+/*
+ * Whether a link change may change the ethtool data (link settings,
+ * features) of the device; other newlink events keep the cached data.
+ */
+static ni_bool_t
+__ni_netdev_ethtool_changed(const ni_netdev_t *dev, const ni_linkinfo_t *old)
+{
+	const unsigned int flags = NI_IFF_DEVICE_READY | NI_IFF_DEVICE_UP | NI_IFF_LINK_UP;
+
+	if (!dev->ethtool)
+		return TRUE;
+	if ((old->ifflags ^ dev->link.ifflags) & flags)
+		return TRUE;
+	if (old->mtu != dev->link.mtu)
+		return TRUE;
+	if (old->masterdev.index != dev->link.masterdev.index)
+		return TRUE;
+	if (!ni_link_address_equal(&old->hwaddr, &dev->link.hwaddr))
+		return TRUE;
+	return FALSE;
+}
+
 /*
  * Refresh complete interface link info given a RTM_NEWLINK message
  */
@@ -1840,8 +2590,11 @@ __ni_netdev_process_newlink(ni_netdev_t *dev, struct nlmsghdr *h,
 				struct ifinfomsg *ifi, ni_netconfig_t *nc)
 {
 	struct nlattr *tb[IFLA_MAX+1];
+	ni_linkinfo_t old;
 	int rv;
 
+	ni_netconfig_digest_unset_link(nc, dev->link.ifindex);
+
 	memset(tb, 0, sizeof(tb));
 	if (nlmsg_parse(h, sizeof(*ifi), tb, IFLA_MAX, NULL) < 0) {
 		ni_error("%s[%u] unable to parse rtnl LINK message",
@@ -1861,9 +2614,14 @@ __ni_netdev_process_newlink(ni_netdev_t *dev, struct nlmsghdr *h,
 					dev->name, dev->link.ifindex);
 			return -1;
 		}
-		ni_string_dup(&dev->name, nla_get_string(tb[IFLA_IFNAME]));
+		ni_netconfig_device_rename(nc, dev, nla_get_string(tb[IFLA_IFNAME]));
 	}
 
+	old.ifflags = dev->link.ifflags;
+	old.mtu = dev->link.mtu;
+	old.hwaddr = dev->link.hwaddr;
+	old.masterdev.index = dev->link.masterdev.index;
+
 	rv = __ni_process_ifinfomsg_linkinfo(&dev->link, dev->name, tb, h, ifi, nc);
 	if (rv < 0)
 		return rv;
@@ -1884,8 +2642,9 @@ __ni_netdev_process_newlink(ni_netdev_t *dev, struct nlmsghdr *h,
 	if (ifi->ifi_family == AF_INET6)
 		__ni_process_ifinfomsg_ipv6info(dev, tb[IFLA_PROTINFO]);
 
-	if (!ni_netconfig_discover_filtered(nc, NI_NETCONFIG_DISCOVER_LINK_EXTERN))
-		ni_system_ethtool_refresh(dev);
+	if (!ni_netconfig_discover_filtered(nc, NI_NETCONFIG_DISCOVER_LINK_EXTERN) &&
+	    __ni_netdev_ethtool_changed(dev, &old))
+		ni_system_ethtool_invalidate(dev);
 
 	switch (dev->link.type) {
 	case NI_IFTYPE_ETHERNET:
@@ -1901,7 +2660,7 @@ __ni_netdev_process_newlink(ni_netdev_t *dev, struct nlmsghdr *h,
 		break;
 
 	case NI_IFTYPE_BRIDGE:
-		__ni_discover_bridge(dev);
+		__ni_discover_bridge(dev, tb);
 		break;
 	case NI_IFTYPE_BOND:
 		__ni_discover_bond(dev, tb, nc);
@@ -3467,21 +4226,162 @@ failure:
 }
 
 
+/*
+ * Process AF_BRIDGE RTM_NEWLINK port notifications (STP state changes)
+ */
+int
+__ni_netdev_process_newlink_bridge_port(ni_netdev_t *dev, struct nlmsghdr *h,
+				struct ifinfomsg *ifi, ni_netconfig_t *nc)
+{
+	struct nlattr *tb[IFLA_MAX+1];
+	ni_bridge_port_t *port;
+	ni_netdev_t *master;
+
+	if (nlmsg_parse(h, sizeof(*ifi), tb, IFLA_MAX, NULL) < 0)
+		return -1;
+
+	if (!tb[IFLA_MASTER] || !tb[IFLA_PROTINFO] ||
+	    !(tb[IFLA_PROTINFO]->nla_type & NLA_F_NESTED))
+		return 0;
+
+	master = ni_netdev_by_index(nc, nla_get_u32(tb[IFLA_MASTER]));
+	if (!master || !master->bridge ||
+	    !(port = ni_bridge_port_by_index(master->bridge, dev->link.ifindex)))
+		return 0;
+
+	__ni_process_ifinfomsg_bridge_port_data(port, dev->name, tb[IFLA_PROTINFO]);
+	if (dev->link.slave.type == NI_IFTYPE_BRIDGE && dev->link.slave.bridge)
+		ni_bridge_port_set_info(dev->link.slave.bridge, port);
+	return 0;
+}
+
+/*
+ * Discover bridge settings and status from IFLA_BR_* attrs;
+ * returns 1 when the kernel does not provide them.
+ */
+static int
+__ni_discover_bridge_netlink(ni_netdev_t *dev, struct nlattr **tb, ni_bridge_t *bridge)
+{
+	/* static const */ struct nla_policy	__info_data_policy[IFLA_INFO_MAX+1] = {
+		[IFLA_INFO_KIND]			= { .type = NLA_STRING	},
+		[IFLA_INFO_DATA]			= { .type = NLA_NESTED	},
+	};
+	/* static const */ struct nla_policy	__bridge_policy[IFLA_BR_MAX+1] = {
+		[IFLA_BR_FORWARD_DELAY]			= { .type = NLA_U32	},
+		[IFLA_BR_HELLO_TIME]			= { .type = NLA_U32	},
+		[IFLA_BR_MAX_AGE]			= { .type = NLA_U32	},
+		[IFLA_BR_AGEING_TIME]			= { .type = NLA_U32	},
+		[IFLA_BR_STP_STATE]			= { .type = NLA_U32	},
+		[IFLA_BR_PRIORITY]			= { .type = NLA_U16	},
+#ifdef HAVE_IFLA_BR_ROOT_ID
+		[IFLA_BR_ROOT_ID]			= { .minlen = sizeof(struct ifla_bridge_id) },
+		[IFLA_BR_BRIDGE_ID]			= { .minlen = sizeof(struct ifla_bridge_id) },
+		[IFLA_BR_ROOT_PORT]			= { .type = NLA_U16	},
+		[IFLA_BR_ROOT_PATH_COST]		= { .type = NLA_U32	},
+		[IFLA_BR_TOPOLOGY_CHANGE]		= { .type = NLA_U8	},
+		[IFLA_BR_TOPOLOGY_CHANGE_DETECTED]	= { .type = NLA_U8	},
+		[IFLA_BR_HELLO_TIMER]			= { .type = NLA_U64	},
+		[IFLA_BR_TCN_TIMER]			= { .type = NLA_U64	},
+		[IFLA_BR_TOPOLOGY_CHANGE_TIMER]		= { .type = NLA_U64	},
+		[IFLA_BR_GC_TIMER]			= { .type = NLA_U64	},
+		[IFLA_BR_GROUP_ADDR]			= { .minlen = ETH_ALEN	},
+#endif
+	};
+	struct nlattr *info[IFLA_INFO_MAX+1];
+	struct nlattr *data[IFLA_BR_MAX+1];
+	ni_bridge_status_t *bs = &bridge->status;
+
+	if (!tb || !tb[IFLA_LINKINFO])
+		return 1;
+
+	if (nla_parse_nested(info, IFLA_INFO_MAX, tb[IFLA_LINKINFO], __info_data_policy) < 0) {
+		ni_error("%s: Unable to parse IFLA_LINKINFO newlink attribute", dev->name);
+		return -1;
+	}
+
+	if (!info[IFLA_INFO_DATA] || !ni_string_eq("bridge", nla_get_string(info[IFLA_INFO_KIND])))
+		return 1;
+
+	if (nla_parse_nested(data, IFLA_BR_MAX, info[IFLA_INFO_DATA], __bridge_policy) < 0) {
+		ni_error("%s: Unable to parse bridge IFLA_INFO_DATA", dev->name);
+		return -1;
+	}
+
+	/* timer values are in USER_HZ clock ticks as in sysfs */
+	if (data[IFLA_BR_STP_STATE]) {
+		bs->stp_state = nla_get_u32(data[IFLA_BR_STP_STATE]);
+		bridge->stp = bs->stp_state ? TRUE : FALSE;
+	}
+	if (data[IFLA_BR_PRIORITY])
+		bridge->priority = nla_get_u16(data[IFLA_BR_PRIORITY]);
+	if (data[IFLA_BR_FORWARD_DELAY])
+		bridge->forward_delay = (double)nla_get_u32(data[IFLA_BR_FORWARD_DELAY]) / 100.0;
+	if (data[IFLA_BR_AGEING_TIME])
+		bridge->ageing_time = (double)nla_get_u32(data[IFLA_BR_AGEING_TIME]) / 100.0;
+	if (data[IFLA_BR_HELLO_TIME])
+		bridge->hello_time = (double)nla_get_u32(data[IFLA_BR_HELLO_TIME]) / 100.0;
+	if (data[IFLA_BR_MAX_AGE])
+		bridge->max_age = (double)nla_get_u32(data[IFLA_BR_MAX_AGE]) / 100.0;
+
+#ifdef HAVE_IFLA_BR_ROOT_ID
+	if (data[IFLA_BR_ROOT_ID]) {
+		__ni_bridge_id_format(&bs->root_id, data[IFLA_BR_ROOT_ID]);
+		if (data[IFLA_BR_BRIDGE_ID])
+			__ni_bridge_id_format(&bs->bridge_id, data[IFLA_BR_BRIDGE_ID]);
+		if (data[IFLA_BR_GROUP_ADDR]) {
+			const unsigned char *a = nla_data(data[IFLA_BR_GROUP_ADDR]);
+			char buf[sizeof("ff:ff:ff:ff:ff:ff")];
+
+			snprintf(buf, sizeof(buf), "%.2x:%.2x:%.2x:%.2x:%.2x:%.2x",
+					a[0], a[1], a[2], a[3], a[4], a[5]);
+			ni_string_dup(&bs->group_addr, buf);
+		}
+		if (data[IFLA_BR_ROOT_PORT])
+			bs->root_port = nla_get_u16(data[IFLA_BR_ROOT_PORT]);
+		if (data[IFLA_BR_ROOT_PATH_COST])
+			bs->root_path_cost = nla_get_u32(data[IFLA_BR_ROOT_PATH_COST]);
+		if (data[IFLA_BR_TOPOLOGY_CHANGE])
+			bs->topology_change = nla_get_u8(data[IFLA_BR_TOPOLOGY_CHANGE]);
+		if (data[IFLA_BR_TOPOLOGY_CHANGE_DETECTED])
+			bs->topology_change_detected = nla_get_u8(data[IFLA_BR_TOPOLOGY_CHANGE_DETECTED]);
+		if (data[IFLA_BR_HELLO_TIMER])
+			bs->hello_timer = nla_get_u64(data[IFLA_BR_HELLO_TIMER]);
+		if (data[IFLA_BR_TCN_TIMER])
+			bs->tcn_timer = nla_get_u64(data[IFLA_BR_TCN_TIMER]);
+		if (data[IFLA_BR_TOPOLOGY_CHANGE_TIMER])
+			bs->topology_change_timer = nla_get_u64(data[IFLA_BR_TOPOLOGY_CHANGE_TIMER]);
+		if (data[IFLA_BR_GC_TIMER])
+			bs->gc_timer = nla_get_u64(data[IFLA_BR_GC_TIMER]);
+		return 0;
+	}
+#endif
+	/* kernel without bridge status attrs */
+	ni_sysfs_bridge_get_status(dev->name, bs);
+	return 0;
+}
+
 /*
  * Discover bridge topology
+ *
+ * The ports are bound and updated by the RTM_NEWLINK bridge slave info
+ * of the port devices; sysfs is used on kernels without netlink data.
  */
 static int
-__ni_discover_bridge(ni_netdev_t *dev)
+__ni_discover_bridge(ni_netdev_t *dev, struct nlattr **tb)
 {
 	ni_bridge_t *bridge;
 	ni_string_array_t ports;
 	unsigned int i;
+	int ret;
 
 	if (dev->link.type != NI_IFTYPE_BRIDGE)
 		return 0;
 
 	bridge = ni_netdev_get_bridge(dev);
 
+	if ((ret = __ni_discover_bridge_netlink(dev, tb, bridge)) <= 0)
+		return ret;
+
 	ni_sysfs_bridge_get_config(dev->name, bridge);
 	ni_sysfs_bridge_get_status(dev->name, &bridge->status);
 
@@ -117,5 +117,6 @@ extern	const char *			ni_json_format_string(ni_stringbuf_t *buf,
 							const ni_json_format_options_t *);
 
 extern	ni_json_t *			ni_json_parse_string(const char *str);
+extern	ni_json_t *			ni_json_parse_buffer(ni_buffer_t *buf);
 
 #endif /* NI_JSON_H */
@@ -31,6 +31,7 @@
 #include "util_priv.h"
 #include "sysfs.h"
 #include "kernel.h"
+#include "timeline.h"
 #include <wicked/ppp.h>
 #include <wicked/tuntap.h>
 
@@ -532,32 +533,97 @@ __ni_nl_dump_valid(struct nl_msg *msg, void *p)
 	return NL_OK;
 }
 
+#ifndef SOL_NETLINK
+#define SOL_NETLINK		270
+#endif
+#ifndef NETLINK_GET_STRICT_CHK
+#define NETLINK_GET_STRICT_CHK	12
+#endif
+
 /*
- * Issue a DUMP request and store all replies in list
+ * Toggle kernel side dump filtering (linux >= 4.20) on the socket.
+ * The kernel captures the flag when the dump starts, so it is
+ * sufficient to enable it around sending the request.
  */
-int
-ni_nl_dump_store(int af, int type, struct ni_nlmsg_list *list)
+static ni_bool_t
+__ni_nl_strict_chk(struct nl_sock *nl_sock, ni_bool_t enable)
+{
+	static ni_bool_t unsupported = FALSE;
+	int val = enable ? 1 : 0;
+
+	if (unsupported)
+		return FALSE;
+
+	if (setsockopt(nl_socket_get_fd(nl_sock), SOL_NETLINK,
+			NETLINK_GET_STRICT_CHK, &val, sizeof(val)) < 0) {
+		if (enable) {
+			ni_debug_socket("netlink strict dump checking unsupported: %m");
+			unsupported = TRUE;
+		}
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/*
+ * Build a dump request with a complete family header, as required
+ * by strict checking. Only the ifindex and route table filters are
+ * set; everything else has to stay zero.
+ */
+static struct nl_msg *
+__ni_nl_dump_request(int af, int type, unsigned int ifindex, unsigned int table)
+{
+	struct nl_msg *msg;
+
+	if (!(msg = nlmsg_alloc_simple(type, NLM_F_DUMP)))
+		return NULL;
+
+	switch (type) {
+	case RTM_GETADDR: {
+			struct ifaddrmsg ifa;
+
+			memset(&ifa, 0, sizeof(ifa));
+			ifa.ifa_family = af;
+			ifa.ifa_index = ifindex;
+			if (nlmsg_append(msg, &ifa, sizeof(ifa), NLMSG_ALIGNTO) < 0)
+				goto failure;
+		}
+		break;
+
+	case RTM_GETROUTE: {
+			struct rtmsg rtm;
+
+			memset(&rtm, 0, sizeof(rtm));
+			rtm.rtm_family = af;
+			if (nlmsg_append(msg, &rtm, sizeof(rtm), NLMSG_ALIGNTO) < 0)
+				goto failure;
+			if (table && nla_put_u32(msg, RTA_TABLE, table) < 0)
+				goto failure;
+			if (ifindex && nla_put_u32(msg, RTA_OIF, ifindex) < 0)
+				goto failure;
+		}
+		break;
+
+	default:
+		goto failure;
+	}
+	return msg;
+
+failure:
+	nlmsg_free(msg);
+	return NULL;
+}
+
+static int
+__ni_nl_dump_recv(struct nl_sock *nl_sock, const char *name, struct ni_nlmsg_list *list)
 {
-	struct nl_sock *nl_sock;
 	struct __ni_nl_dump_state data = {
 		.msg_type = -1,
 		.list = list,
 	};
 	struct nl_cb *cb;
-	const char *name;
 	int rv;
 
-	name = ni_rtnl_msg_type_to_name(type, __func__);
-	if (!__ni_global_netlink || !(nl_sock = __ni_global_netlink->nl_sock)) {
-		ni_error("%s: no netlink socket", name);
-		return -NLE_BAD_SOCK;
-	}
-
-	if ((rv = nl_rtgen_request(nl_sock, type, af, NLM_F_DUMP)) < 0) {
-		ni_error("%s: failed to send request", name);
-		return rv;
-	}
-
 	if (!(cb = __ni_nl_cb_clone(__ni_global_netlink)))
 		return -NLE_NOMEM;
 
@@ -587,6 +653,74 @@ retry:
 	return rv;
 }
 
+/*
+ * Issue a DUMP request and store all replies in list
+ */
+int
+ni_nl_dump_store(int af, int type, struct ni_nlmsg_list *list)
+{
+	struct nl_sock *nl_sock;
+	const char *name;
+	int rv;
+
+	name = ni_rtnl_msg_type_to_name(type, __func__);
+	if (!__ni_global_netlink || !(nl_sock = __ni_global_netlink->nl_sock)) {
+		ni_error("%s: no netlink socket", name);
+		return -NLE_BAD_SOCK;
+	}
+
+	ni_timeline_begin(NI_TIMELINE_NETLINK);
+	if ((rv = nl_rtgen_request(nl_sock, type, af, NLM_F_DUMP)) < 0)
+		ni_error("%s: failed to send request", name);
+	else
+		rv = __ni_nl_dump_recv(nl_sock, name, list);
+	ni_timeline_end(NI_TIMELINE_NETLINK);
+
+	return rv;
+}
+
+/*
+ * Issue a DUMP request asking the kernel to filter the replies by
+ * interface index (addresses, routes via RTA_OIF) and route table.
+ * Kernels without strict checking ignore the filter and dump all,
+ * so callers still have to filter the replies on their own.
+ */
+int
+ni_nl_dump_store_filter(int af, int type, unsigned int ifindex,
+			unsigned int table, struct ni_nlmsg_list *list)
+{
+	struct nl_sock *nl_sock;
+	struct nl_msg *msg;
+	const char *name;
+	ni_bool_t strict;
+	int rv;
+
+	if (!ifindex && !table)
+		return ni_nl_dump_store(af, type, list);
+
+	name = ni_rtnl_msg_type_to_name(type, __func__);
+	if (!__ni_global_netlink || !(nl_sock = __ni_global_netlink->nl_sock)) {
+		ni_error("%s: no netlink socket", name);
+		return -NLE_BAD_SOCK;
+	}
+
+	if (!(msg = __ni_nl_dump_request(af, type, ifindex, table)))
+		return ni_nl_dump_store(af, type, list);
+
+	strict = __ni_nl_strict_chk(nl_sock, TRUE);
+	rv = nl_send_auto(nl_sock, msg);
+	if (strict)
+		__ni_nl_strict_chk(nl_sock, FALSE);
+	nlmsg_free(msg);
+
+	if (rv < 0) {
+		ni_error("%s: failed to send request", name);
+		return rv;
+	}
+
+	return __ni_nl_dump_recv(nl_sock, name, list);
+}
+
 /*
  * Send a message and capture the response message(s)
  */
@@ -611,6 +745,250 @@ ni_nl_talk(struct nl_msg *msg, struct ni_nlmsg_list *list)
 	}
 }
 
+/*
+ * Batched netlink requests: the messages are packed into as few
+ * sendmsg calls as possible and the ACK or error reported for each
+ * of them is collected. The kernel processes the messages in order
+ * and continues after a failed one.
+ * The kernel queues all ACKs before sendmsg returns, so the number
+ * of messages per sendmsg is limited to not overrun the receive
+ * buffer of the socket.
+ */
+#define NI_NL_BATCH_CHUNK	16
+#define NI_NL_BATCH_BUFSIZE	(16 * 1024)
+#define NI_NL_BATCH_MAXMSGS	64
+
+struct ni_nl_batch_entry {
+	struct nl_msg *		msg;
+	unsigned int		seq;
+	int			error;
+	unsigned int		acked : 1;
+};
+
+struct ni_nl_batch {
+	unsigned int		count;
+	struct ni_nl_batch_entry *data;
+};
+
+struct __ni_nl_batch_state {
+	ni_nl_batch_t *		batch;
+	unsigned int		first;
+	unsigned int		last;
+	unsigned int		pending;
+};
+
+ni_nl_batch_t *
+ni_nl_batch_new(void)
+{
+	return xcalloc(1, sizeof(ni_nl_batch_t));
+}
+
+void
+ni_nl_batch_free(ni_nl_batch_t *batch)
+{
+	unsigned int i;
+
+	if (!batch)
+		return;
+
+	for (i = 0; i < batch->count; ++i)
+		nlmsg_free(batch->data[i].msg);
+	free(batch->data);
+	free(batch);
+}
+
+/*
+ * Append a message to the batch, taking over the ownership
+ * of it. Returns the index of the message in the batch.
+ */
+int
+ni_nl_batch_add(ni_nl_batch_t *batch, struct nl_msg *msg)
+{
+	struct ni_nl_batch_entry *entry;
+
+	if (!batch || !msg)
+		return -1;
+
+	if ((batch->count % NI_NL_BATCH_CHUNK) == 0) {
+		size_t size = batch->count + NI_NL_BATCH_CHUNK;
+
+		batch->data = xrealloc(batch->data, size * sizeof(*entry));
+	}
+
+	entry = &batch->data[batch->count];
+	memset(entry, 0, sizeof(*entry));
+	entry->msg = msg;
+	return batch->count++;
+}
+
+unsigned int
+ni_nl_batch_count(const ni_nl_batch_t *batch)
+{
+	return batch ? batch->count : 0;
+}
+
+int
+ni_nl_batch_error(const ni_nl_batch_t *batch, unsigned int index)
+{
+	if (!batch || index >= batch->count)
+		return -NLE_RANGE;
+	return batch->data[index].error;
+}
+
+static struct ni_nl_batch_entry *
+__ni_nl_batch_find(struct __ni_nl_batch_state *state, unsigned int seq)
+{
+	struct ni_nl_batch_entry *entry;
+	unsigned int i;
+
+	for (i = state->first; i < state->last; ++i) {
+		entry = &state->batch->data[i];
+		if (entry->seq == seq && !entry->acked)
+			return entry;
+	}
+	return NULL;
+}
+
+static int
+__ni_nl_batch_ack_handler(struct nl_msg *msg, void *arg)
+{
+	struct __ni_nl_batch_state *state = arg;
+	struct ni_nl_batch_entry *entry;
+
+	if ((entry = __ni_nl_batch_find(state, nlmsg_hdr(msg)->nlmsg_seq))) {
+		entry->acked = 1;
+		state->pending--;
+	}
+	return NL_OK;
+}
+
+static int
+__ni_nl_batch_error_handler(struct sockaddr_nl *sender, struct nlmsgerr *err, void *arg)
+{
+	struct __ni_nl_batch_state *state = arg;
+	struct ni_nl_batch_entry *entry;
+
+	if ((entry = __ni_nl_batch_find(state, err->msg.nlmsg_seq))) {
+		entry->error = -nl_syserr2nlerr(err->error);
+		entry->acked = 1;
+		state->pending--;
+	}
+	return NL_SKIP;
+}
+
+static int
+__ni_nl_batch_flush(struct nl_sock *nl_sock, struct __ni_nl_batch_state *state,
+			void *buf, size_t len)
+{
+	struct nl_cb *cb;
+	unsigned int i;
+	int err;
+
+	if ((err = nl_sendto(nl_sock, buf, len)) < 0) {
+		ni_error("%s: unable to send: %s", __func__, nl_geterror(err));
+		goto failed;
+	}
+
+	if (!(cb = __ni_nl_cb_clone(__ni_global_netlink))) {
+		err = -NLE_NOMEM;
+		goto failed;
+	}
+
+	nl_cb_err(cb, NL_CB_CUSTOM, __ni_nl_batch_error_handler, state);
+	nl_cb_set(cb, NL_CB_ACK, NL_CB_CUSTOM, __ni_nl_batch_ack_handler, state);
+
+	while (state->pending) {
+		if ((err = nl_recvmsgs(nl_sock, cb)) < 0) {
+			ni_debug_socket("%s: recv failed: %s", __func__, nl_geterror(err));
+			break;
+		}
+	}
+	nl_cb_put(cb);
+
+	if (!state->pending)
+		return 0;
+
+failed:
+	for (i = state->first; i < state->last; ++i) {
+		if (!state->batch->data[i].acked)
+			state->batch->data[i].error = err;
+	}
+	state->pending = 0;
+	return err;
+}
+
+/*
+ * Send all messages of the batch and wait for their ACKs.
+ * Returns the number of failed messages; the per-message
+ * error code is available via ni_nl_batch_error().
+ */
+int
+ni_nl_batch_commit(ni_nl_batch_t *batch)
+{
+	struct __ni_nl_batch_state state;
+	struct nl_sock *nl_sock;
+	struct nlmsghdr *nlh;
+	unsigned char *buf;
+	size_t len = 0, size;
+	unsigned int i;
+	int failed = 0;
+
+	if (!batch || !batch->count)
+		return 0;
+
+	if (!__ni_global_netlink || !(nl_sock = __ni_global_netlink->nl_sock)) {
+		ni_error("%s: no netlink socket", __func__);
+		for (i = 0; i < batch->count; ++i)
+			batch->data[i].error = -NLE_BAD_SOCK;
+		return batch->count;
+	}
+
+	memset(&state, 0, sizeof(state));
+	state.batch = batch;
+	buf = xcalloc(1, NI_NL_BATCH_BUFSIZE);
+
+	for (i = 0; i < batch->count; ++i) {
+		struct ni_nl_batch_entry *entry = &batch->data[i];
+
+		/* sequence numbers have to be assigned in send order */
+		nl_complete_msg(nl_sock, entry->msg);
+		nlh = nlmsg_hdr(entry->msg);
+		size = NLMSG_ALIGN(nlh->nlmsg_len);
+
+		if (len && (len + size > NI_NL_BATCH_BUFSIZE ||
+			    state.pending >= NI_NL_BATCH_MAXMSGS)) {
+			__ni_nl_batch_flush(nl_sock, &state, buf, len);
+			state.first = state.last;
+			len = 0;
+		}
+
+		entry->seq = nlh->nlmsg_seq;
+		if (size > NI_NL_BATCH_BUFSIZE) {
+			/* oversized message, send it on its own */
+			state.last = i + 1;
+			state.pending = 1;
+			__ni_nl_batch_flush(nl_sock, &state, nlh, nlh->nlmsg_len);
+			state.first = state.last;
+			continue;
+		}
+
+		memcpy(buf + len, nlh, nlh->nlmsg_len);
+		len += size;
+		state.last = i + 1;
+		state.pending++;
+	}
+	if (len)
+		__ni_nl_batch_flush(nl_sock, &state, buf, len);
+
+	free(buf);
+
+	for (i = 0; i < batch->count; ++i) {
+		if (batch->data[i].error)
+			failed++;
+	}
+	return failed;
+}
+
 #define ni_t2n(x)	[x] = #x
 static const char *	ni_rtnl_msg_type_names[RTM_MAX] = {
 #ifdef	RTM_NEWLINK
@@ -74,6 +74,20 @@ struct ni_nlmsg_list {
 
 extern int	ni_nl_talk(struct nl_msg *, struct ni_nlmsg_list *);
 extern int	ni_nl_dump_store(int af, int type, struct ni_nlmsg_list *list);
+extern int	ni_nl_dump_store_filter(int af, int type, unsigned int ifindex,
+				unsigned int table, struct ni_nlmsg_list *list);
+
+/*
+ * Batch of netlink requests sent with few sendmsg calls
+ */
+typedef struct ni_nl_batch	ni_nl_batch_t;
+
+extern ni_nl_batch_t *	ni_nl_batch_new(void);
+extern void		ni_nl_batch_free(ni_nl_batch_t *);
+extern int		ni_nl_batch_add(ni_nl_batch_t *, struct nl_msg *);
+extern unsigned int	ni_nl_batch_count(const ni_nl_batch_t *);
+extern int		ni_nl_batch_commit(ni_nl_batch_t *);
+extern int		ni_nl_batch_error(const ni_nl_batch_t *, unsigned int);
 
 extern void	ni_nlmsg_list_init(struct ni_nlmsg_list *);
 extern void	ni_nlmsg_list_destroy(struct ni_nlmsg_list *);
@@ -135,6 +149,7 @@ extern int	__ni_rtnl_parse_newprefix(const char *, struct nlmsghdr *, struct pre
 
 extern int	__ni_netdev_process_newlink(ni_netdev_t *, struct nlmsghdr *, struct ifinfomsg *, ni_netconfig_t *);
 extern int	__ni_netdev_process_newlink_ipv6(ni_netdev_t *, struct nlmsghdr *, struct ifinfomsg *);
+extern int	__ni_netdev_process_newlink_bridge_port(ni_netdev_t *, struct nlmsghdr *, struct ifinfomsg *, ni_netconfig_t *);
 extern int	__ni_netdev_process_newprefix(ni_netdev_t *, struct nlmsghdr *, struct prefixmsg *);
 extern int	__ni_netdev_process_newaddr_event(ni_netdev_t *dev, struct nlmsghdr *h, struct ifaddrmsg *ifa, const ni_address_t **);
 
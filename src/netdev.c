@@ -87,6 +87,10 @@ ni_netdev_slaveinfo_destroy(ni_slaveinfo_t *slave)
 	case NI_IFTYPE_BOND:
 		ni_bonding_slave_info_free(slave->bond);
 		break;
+	case NI_IFTYPE_BRIDGE:
+		if (slave->bridge)
+			ni_bridge_port_free(slave->bridge);
+		break;
 	default:
 		break;
 	}
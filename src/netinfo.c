@@ -42,16 +42,46 @@ typedef struct ni_netconfig_filter {
 	unsigned int		discover;
 } ni_netconfig_filter_t;
 
+/*
+ * Hash index of the interface list by ifindex and by name,
+ * so we do not need to walk the whole list on every event.
+ */
+typedef struct ni_netdev_hash_entry	ni_netdev_hash_entry_t;
+
+struct ni_netdev_hash_entry {
+	ni_netdev_hash_entry_t *	next;
+	unsigned int			key;
+	ni_netdev_t *			dev;
+};
+
+typedef struct ni_netdev_hash {
+	unsigned int			count;
+	unsigned int			size;
+	ni_netdev_hash_entry_t **	buckets;
+} ni_netdev_hash_t;
+
+#define NI_NETDEV_HASH_MIN_SIZE		64
+
 struct ni_netconfig {
 	ni_netconfig_filter_t	filter;
 
 	ni_netdev_t *		interfaces;
 	ni_modem_t *		modems;
 
+	struct {
+		ni_netdev_hash_t	by_index;
+		ni_netdev_hash_t	by_name;
+	}			hash;
+
 	struct {
 		ni_rule_array_t	rules;
 	}			route;
 
+	struct {
+		ni_netconfig_digests_t	digests;
+		ni_netconfig_resync_stats_t stats;
+	}			resync;
+
 	unsigned char		initialized;
 };
 
@@ -427,6 +457,24 @@ ni_create_dbus_client(const char *dbus_name)
 	return ni_dbus_client_open(ni_global.config->dbus_type, dbus_name);
 }
 
+/*
+ * Cache the parsed schema files in the state directory, if we can
+ */
+static void
+ni_server_dbus_xml_schema_cache(ni_xs_scope_t *scope)
+{
+	const char *statedir = ni_global.config->statedir.path;
+	char *dirname = NULL;
+
+	if (ni_string_empty(statedir) || !ni_isdir(statedir))
+		return;
+
+	if (ni_string_printf(&dirname, "%s/schema", statedir) &&
+	    ni_mkdir_maybe(dirname, 0755) == 0)
+		ni_xs_scope_set_cache_dir(scope, dirname);
+	ni_string_free(&dirname);
+}
+
 ni_xs_scope_t *
 ni_server_dbus_xml_schema(void)
 {
@@ -439,6 +487,7 @@ ni_server_dbus_xml_schema(void)
 	}
 
 	scope = ni_dbus_xml_init();
+	ni_server_dbus_xml_schema_cache(scope);
 	if (ni_xs_process_schema_file(filename, scope) < 0) {
 		ni_error("Cannot create dbus xml schema: error in schema definition");
 		ni_xs_scope_free(scope);
@@ -491,6 +540,127 @@ ni_global_state_handle(int refresh)
 	return nc;
 }
 
+/*
+ * Interface hash index helpers
+ */
+static inline unsigned int
+ni_netdev_hash_name(const char *name)
+{
+	unsigned int hash = 2166136261U;
+
+	while (*name) {
+		hash ^= (unsigned char)*name++;
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+static void
+ni_netdev_hash_destroy(ni_netdev_hash_t *hash)
+{
+	ni_netdev_hash_entry_t *entry;
+	unsigned int i;
+
+	for (i = 0; i < hash->size; ++i) {
+		while ((entry = hash->buckets[i]) != NULL) {
+			hash->buckets[i] = entry->next;
+			free(entry);
+		}
+	}
+	free(hash->buckets);
+	memset(hash, 0, sizeof(*hash));
+}
+
+static void
+ni_netdev_hash_resize(ni_netdev_hash_t *hash, unsigned int size)
+{
+	ni_netdev_hash_entry_t **buckets, *entry;
+	unsigned int i, pos;
+
+	buckets = xcalloc(size, sizeof(*buckets));
+	for (i = 0; i < hash->size; ++i) {
+		while ((entry = hash->buckets[i]) != NULL) {
+			hash->buckets[i] = entry->next;
+			pos = entry->key & (size - 1);
+			entry->next = buckets[pos];
+			buckets[pos] = entry;
+		}
+	}
+	free(hash->buckets);
+	hash->buckets = buckets;
+	hash->size = size;
+}
+
+static void
+ni_netdev_hash_insert(ni_netdev_hash_t *hash, unsigned int key, ni_netdev_t *dev)
+{
+	ni_netdev_hash_entry_t *entry;
+	unsigned int pos;
+
+	if (hash->count >= hash->size)
+		ni_netdev_hash_resize(hash, hash->size ? hash->size << 1 :
+						NI_NETDEV_HASH_MIN_SIZE);
+
+	entry = xcalloc(1, sizeof(*entry));
+	entry->key = key;
+	entry->dev = dev;
+
+	pos = key & (hash->size - 1);
+	entry->next = hash->buckets[pos];
+	hash->buckets[pos] = entry;
+	hash->count++;
+}
+
+static ni_bool_t
+ni_netdev_hash_delete(ni_netdev_hash_t *hash, unsigned int key, const ni_netdev_t *dev)
+{
+	ni_netdev_hash_entry_t **pos, *entry;
+
+	if (!hash->size)
+		return FALSE;
+
+	pos = &hash->buckets[key & (hash->size - 1)];
+	for ( ; (entry = *pos) != NULL; pos = &entry->next) {
+		if (entry->dev == dev && entry->key == key) {
+			*pos = entry->next;
+			hash->count--;
+			free(entry);
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+static ni_bool_t
+ni_netdev_hash_purge(ni_netdev_hash_t *hash, const ni_netdev_t *dev)
+{
+	ni_netdev_hash_entry_t **pos, *entry;
+	ni_bool_t found = FALSE;
+	unsigned int i;
+
+	/* slow path for an entry with a stale key */
+	for (i = 0; i < hash->size; ++i) {
+		pos = &hash->buckets[i];
+		while ((entry = *pos) != NULL) {
+			if (entry->dev == dev) {
+				*pos = entry->next;
+				hash->count--;
+				free(entry);
+				found = TRUE;
+			} else {
+				pos = &entry->next;
+			}
+		}
+	}
+	return found;
+}
+
+static inline ni_netdev_hash_entry_t *
+ni_netdev_hash_bucket(const ni_netdev_hash_t *hash, unsigned int key)
+{
+	return hash->size ? hash->buckets[key & (hash->size - 1)] : NULL;
+}
+
 /*
  * Constructor/destructor for netconfig handles
  */
@@ -519,8 +689,11 @@ ni_netconfig_init(ni_netconfig_t *nc)
 void
 ni_netconfig_destroy(ni_netconfig_t *nc)
 {
+	ni_netdev_hash_destroy(&nc->hash.by_index);
+	ni_netdev_hash_destroy(&nc->hash.by_name);
 	__ni_netdev_list_destroy(&nc->interfaces);
 	ni_rule_array_destroy(&nc->route.rules);
+	ni_netconfig_digests_destroy(&nc->resync.digests);
 	memset(nc, 0, sizeof(*nc));
 }
 
@@ -575,10 +748,184 @@ ni_netconfig_device_list_head(ni_netconfig_t *nc)
 	return &nc->interfaces;
 }
 
+/*
+ * Add/remove the device to/from the ifindex and name hash index.
+ * Callers manipulating the device list directly have to use them
+ * to keep the index in sync with the list.
+ */
+void
+ni_netconfig_device_hash_add(ni_netconfig_t *nc, ni_netdev_t *dev)
+{
+	ni_netdev_hash_insert(&nc->hash.by_index, dev->link.ifindex, dev);
+	if (dev->name)
+		ni_netdev_hash_insert(&nc->hash.by_name,
+				ni_netdev_hash_name(dev->name), dev);
+}
+
+ni_bool_t
+ni_netconfig_device_hash_del(ni_netconfig_t *nc, ni_netdev_t *dev)
+{
+	ni_bool_t found;
+
+	if (!(found = ni_netdev_hash_delete(&nc->hash.by_index, dev->link.ifindex, dev)))
+		found = ni_netdev_hash_purge(&nc->hash.by_index, dev);
+
+	if (!dev->name || !ni_netdev_hash_delete(&nc->hash.by_name,
+				ni_netdev_hash_name(dev->name), dev))
+		ni_netdev_hash_purge(&nc->hash.by_name, dev);
+
+	ni_netconfig_digest_unset_link(nc, dev->link.ifindex);
+	ni_netconfig_digest_unset_addrs(nc, dev->link.ifindex);
+
+	return found;
+}
+
+/*
+ * Sorted key to content digest maps, used by the incremental resync.
+ * Zero means "unknown" and is never stored.
+ */
+static unsigned int
+ni_netconfig_digests_index(const ni_netconfig_digests_t *map, uint64_t key)
+{
+	unsigned int lo = 0, hi = map->count, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (map->data[mid].key < key)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+uint64_t
+ni_netconfig_digests_get(const ni_netconfig_digests_t *map, uint64_t key)
+{
+	unsigned int pos;
+
+	if (!map)
+		return 0;
+
+	pos = ni_netconfig_digests_index(map, key);
+	if (pos < map->count && map->data[pos].key == key)
+		return map->data[pos].value;
+	return 0;
+}
+
+#define NI_NETCONFIG_DIGESTS_CHUNK	64
+
+void
+ni_netconfig_digests_set(ni_netconfig_digests_t *map, uint64_t key, uint64_t value)
+{
+	ni_netconfig_digest_t *data;
+	unsigned int pos;
+
+	if (!map)
+		return;
+
+	pos = ni_netconfig_digests_index(map, key);
+	if (pos < map->count && map->data[pos].key == key) {
+		if (value) {
+			map->data[pos].value = value;
+		} else {
+			map->count--;
+			memmove(&map->data[pos], &map->data[pos + 1],
+				(map->count - pos) * sizeof(*data));
+		}
+		return;
+	}
+	if (!value)
+		return;
+
+	if ((map->count % NI_NETCONFIG_DIGESTS_CHUNK) == 0) {
+		size_t size = map->count + NI_NETCONFIG_DIGESTS_CHUNK;
+
+		map->data = xrealloc(map->data, size * sizeof(*data));
+	}
+	data = map->data;
+	memmove(&data[pos + 1], &data[pos], (map->count - pos) * sizeof(*data));
+	data[pos].key = key;
+	data[pos].value = value;
+	map->count++;
+}
+
+void
+ni_netconfig_digests_destroy(ni_netconfig_digests_t *map)
+{
+	if (map) {
+		free(map->data);
+		memset(map, 0, sizeof(*map));
+	}
+}
+
+ni_netconfig_digests_t *
+ni_netconfig_digests(ni_netconfig_t *nc)
+{
+	return nc ? &nc->resync.digests : NULL;
+}
+
+void
+ni_netconfig_digest_unset(ni_netconfig_t *nc, uint64_t key)
+{
+	if (nc)
+		ni_netconfig_digests_set(&nc->resync.digests, key, 0);
+}
+
+void
+ni_netconfig_digest_unset_link(ni_netconfig_t *nc, unsigned int ifindex)
+{
+	ni_netconfig_digest_unset(nc, NI_NETCONFIG_DIGEST_KEY(
+				NI_NETCONFIG_DIGEST_LINK, AF_UNSPEC, ifindex));
+	ni_netconfig_digest_unset(nc, NI_NETCONFIG_DIGEST_KEY(
+				NI_NETCONFIG_DIGEST_IPV6, AF_INET6, ifindex));
+}
+
+void
+ni_netconfig_digest_unset_addrs(ni_netconfig_t *nc, unsigned int ifindex)
+{
+	ni_netconfig_digest_unset(nc, NI_NETCONFIG_DIGEST_KEY(
+				NI_NETCONFIG_DIGEST_ADDRS, AF_INET, ifindex));
+	ni_netconfig_digest_unset(nc, NI_NETCONFIG_DIGEST_KEY(
+				NI_NETCONFIG_DIGEST_ADDRS, AF_INET6, ifindex));
+}
+
+ni_netconfig_resync_stats_t *
+ni_netconfig_resync_stats(ni_netconfig_t *nc)
+{
+	return nc ? &nc->resync.stats : NULL;
+}
+
+/*
+ * Rename a device, keeping the name index up to date
+ */
+void
+ni_netconfig_device_rename(ni_netconfig_t *nc, ni_netdev_t *dev, const char *ifname)
+{
+	ni_bool_t indexed;
+
+	if (!dev || ni_string_eq(dev->name, ifname))
+		return;
+
+	/* devices not (yet) in the list are not in the index either */
+	indexed = nc && ni_netdev_by_index(nc, dev->link.ifindex) == dev;
+
+	if (indexed && (!dev->name || !ni_netdev_hash_delete(&nc->hash.by_name,
+				ni_netdev_hash_name(dev->name), dev)))
+		ni_netdev_hash_purge(&nc->hash.by_name, dev);
+
+	ni_string_dup(&dev->name, ifname);
+
+	if (indexed && dev->name)
+		ni_netdev_hash_insert(&nc->hash.by_name,
+				ni_netdev_hash_name(dev->name), dev);
+}
+
 void
 ni_netconfig_device_append(ni_netconfig_t *nc, ni_netdev_t *dev)
 {
 	__ni_netdev_list_append(&nc->interfaces, dev);
+	ni_netconfig_device_hash_add(nc, dev);
 }
 
 static inline void
@@ -600,6 +947,7 @@ ni_netconfig_device_remove(ni_netconfig_t *nc, ni_netdev_t *dev)
 	for (pos = &nc->interfaces; (cur = *pos) != NULL; pos = &cur->next) {
 		if (cur == dev) {
 			*pos = cur->next;
+			ni_netconfig_device_hash_del(nc, cur);
 			ni_netconfig_device_unbind_slave_index(nc, cur->link.ifindex);
 			ni_netdev_put(cur);
 			return;
@@ -645,6 +993,9 @@ ni_netconfig_route_add(ni_netconfig_t *nc, ni_route_t *rp, ni_netdev_t *dev)
 	if (!nc || !rp)
 		return -1;
 
+	ni_netconfig_digest_unset(nc, NI_NETCONFIG_DIGEST_KEY(
+				NI_NETCONFIG_DIGEST_ROUTES, rp->family, rp->table));
+
 	for (nh = &rp->nh; ret != -1 && nh; nh = nh->next) {
 		if (nh->device.index == 0 ||
 		    ni_uint_array_contains(&idx, nh->device.index))
@@ -704,6 +1055,9 @@ ni_netconfig_route_del(ni_netconfig_t *nc, ni_route_t *rp, ni_netdev_t *dev)
 	if (!nc || !ni_route_ref(rp))
 		return -1;
 
+	ni_netconfig_digest_unset(nc, NI_NETCONFIG_DIGEST_KEY(
+				NI_NETCONFIG_DIGEST_ROUTES, rp->family, rp->table));
+
 	if (dev && ni_route_tables_del_route(dev->routes, rp))
 		ret = 0;
 
@@ -814,11 +1168,16 @@ ni_netconfig_rule_find(ni_netconfig_t *nc, const ni_rule_t *rule)
 ni_netdev_t *
 ni_netdev_by_name(ni_netconfig_t *nc, const char *name)
 {
-	ni_netdev_t *dev;
+	ni_netdev_hash_entry_t *entry;
+	unsigned int key;
 
-	for (dev = nc->interfaces; dev; dev = dev->next) {
-		if (dev->name && ni_string_eq(dev->name, name))
-			return dev;
+	if (!name)
+		return NULL;
+
+	key = ni_netdev_hash_name(name);
+	for (entry = ni_netdev_hash_bucket(&nc->hash.by_name, key); entry; entry = entry->next) {
+		if (entry->key == key && ni_string_eq(entry->dev->name, name))
+			return entry->dev;
 	}
 
 	return NULL;
@@ -830,11 +1189,11 @@ ni_netdev_by_name(ni_netconfig_t *nc, const char *name)
 ni_netdev_t *
 ni_netdev_by_index(ni_netconfig_t *nc, unsigned int ifindex)
 {
-	ni_netdev_t *dev;
+	ni_netdev_hash_entry_t *entry;
 
-	for (dev = nc->interfaces; dev; dev = dev->next) {
-		if (dev->link.ifindex == ifindex)
-			return dev;
+	for (entry = ni_netdev_hash_bucket(&nc->hash.by_index, ifindex); entry; entry = entry->next) {
+		if (entry->key == ifindex && entry->dev->link.ifindex == ifindex)
+			return entry->dev;
 	}
 
 	return NULL;
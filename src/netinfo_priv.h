@@ -36,6 +36,43 @@ enum {
 	NI_NETCONFIG_DISCOVER_ROUTE_RULES = 1U << 1,
 };
 
+/*
+ * Content digests of kernel objects, used by the incremental resync
+ * to skip objects that did not change since they were last processed.
+ */
+enum {
+	NI_NETCONFIG_DIGEST_LINK = 1,
+	NI_NETCONFIG_DIGEST_IPV6,
+	NI_NETCONFIG_DIGEST_ADDRS,
+	NI_NETCONFIG_DIGEST_ROUTES,
+};
+#define NI_NETCONFIG_DIGEST_KEY(kind, family, id)	\
+	(((uint64_t)(kind) << 40) | ((uint64_t)((family) & 0xff) << 32) | (uint32_t)(id))
+
+typedef struct ni_netconfig_digest {
+	uint64_t		key;
+	uint64_t		value;
+} ni_netconfig_digest_t;
+
+typedef struct ni_netconfig_digests {
+	unsigned int		count;
+	ni_netconfig_digest_t *	data;
+} ni_netconfig_digests_t;
+
+#define NI_NETCONFIG_DIGESTS_INIT	{ .count = 0, .data = NULL }
+
+typedef struct ni_netconfig_resync_stats {
+	unsigned int		runs;
+	unsigned int		links;
+	unsigned int		links_changed;
+	unsigned int		links_removed;
+	unsigned int		addrs;
+	unsigned int		addrs_changed;
+	unsigned int		routes;
+	unsigned int		routes_changed;
+	unsigned int		tables_changed;
+} ni_netconfig_resync_stats_t;
+
 /*
  * These constants describe why/how the interface has been brought up
  */
@@ -46,6 +83,9 @@ extern void		__ni_netlink_close(ni_netlink_t *);
 
 extern void		ni_netconfig_device_append(ni_netconfig_t *, ni_netdev_t *);
 extern void		ni_netconfig_device_remove(ni_netconfig_t *, ni_netdev_t *);
+extern void		ni_netconfig_device_rename(ni_netconfig_t *, ni_netdev_t *, const char *);
+extern void		ni_netconfig_device_hash_add(ni_netconfig_t *, ni_netdev_t *);
+extern ni_bool_t	ni_netconfig_device_hash_del(ni_netconfig_t *, ni_netdev_t *);
 extern ni_netdev_t **	ni_netconfig_device_list_head(ni_netconfig_t *);
 extern void		ni_netconfig_modem_append(ni_netconfig_t *, ni_modem_t *);
 extern int		ni_netconfig_route_add(ni_netconfig_t *, ni_route_t *, ni_netdev_t *);
@@ -54,6 +94,14 @@ extern int		ni_netconfig_rule_add(ni_netconfig_t *, ni_rule_t *);
 extern int		ni_netconfig_rule_del(ni_netconfig_t *, const ni_rule_t *, ni_rule_t **);
 extern ni_rule_t *	ni_netconfig_rule_find(ni_netconfig_t *, const ni_rule_t *);
 extern ni_rule_array_t *ni_netconfig_rule_array(ni_netconfig_t *);
+extern uint64_t		ni_netconfig_digests_get(const ni_netconfig_digests_t *, uint64_t);
+extern void		ni_netconfig_digests_set(ni_netconfig_digests_t *, uint64_t, uint64_t);
+extern void		ni_netconfig_digests_destroy(ni_netconfig_digests_t *);
+extern ni_netconfig_digests_t *ni_netconfig_digests(ni_netconfig_t *);
+extern void		ni_netconfig_digest_unset(ni_netconfig_t *, uint64_t);
+extern void		ni_netconfig_digest_unset_link(ni_netconfig_t *, unsigned int);
+extern void		ni_netconfig_digest_unset_addrs(ni_netconfig_t *, unsigned int);
+extern ni_netconfig_resync_stats_t *ni_netconfig_resync_stats(ni_netconfig_t *);
 
 extern ni_bool_t	ni_netconfig_set_discover_filter(ni_netconfig_t *, unsigned int);
 extern ni_bool_t	ni_netconfig_discover_filtered(ni_netconfig_t *, unsigned int);
@@ -81,6 +129,7 @@ extern ni_bool_t	__ni_address_list_remove(ni_address_t **, ni_address_t *);
 
 extern int		__ni_system_refresh_all(ni_netconfig_t *nc, ni_netdev_t **del_list);
 extern int		__ni_system_refresh_interfaces(ni_netconfig_t *nc);
+extern int		__ni_system_resync(ni_netconfig_t *nc);
 extern int		__ni_system_refresh_interface(ni_netconfig_t *, ni_netdev_t *);
 extern int		__ni_system_refresh_interface_addrs(ni_netconfig_t *, ni_netdev_t *);
 extern int		__ni_system_refresh_interface_routes(ni_netconfig_t *, ni_netdev_t *);
@@ -97,6 +146,7 @@ extern int		__ni_system_interface_flush_routes(ni_netconfig_t *, ni_netdev_t *);
 extern void		__ni_system_ethernet_refresh(ni_netdev_t *);
 extern void		__ni_system_ethernet_update(ni_netdev_t *, ni_ethernet_t *);
 extern void		ni_system_ethtool_refresh(ni_netdev_t *);
+extern void		ni_system_ethtool_invalidate(ni_netdev_t *);
 
 /* FIXME: These should go elsewhere, maybe runtime.h */
 extern int		__ni_system_interface_update_lease(ni_netdev_t *, ni_addrconf_lease_t **, ni_event_t);
@@ -30,6 +30,7 @@
 #include <wicked/util.h>
 #include <wicked/netinfo.h>
 #include "ovs.h"
+#include "ovsdb.h"
 #include "buffer.h"
 #include "process.h"
 #include "util_priv.h"
@@ -663,6 +664,14 @@ failure:
 	return rv;
 }
 
+int /* process run codes (for now) */
+ni_ovs_bridge_exists(const char *brname)
+{
+	if (ni_ovsdb_monitor_active())
+		return ni_ovsdb_bridge_exists(brname) ? NI_PROCESS_FAILURE : NI_PROCESS_SUCCESS;
+	return ni_ovs_vsctl_bridge_exists(brname);
+}
+
 int
 ni_ovs_bridge_discover(ni_netdev_t *dev, ni_netconfig_t *nc)
 {
@@ -673,6 +682,12 @@ ni_ovs_bridge_discover(ni_netdev_t *dev, ni_netconfig_t *nc)
 		return -1;
 
 	ovsbr = ni_ovs_bridge_new();
+	if (ni_ovsdb_monitor_active()) {
+		if (ni_ovsdb_bridge_discover(dev->name, ovsbr)) {
+			ni_ovs_bridge_free(ovsbr);
+			return -1;
+		}
+	} else
 	if (ni_ovs_vsctl_bridge_to_parent(dev->name, &ovsbr->config.vlan.parent.name) ||
 	    ni_ovs_vsctl_bridge_to_vlan(dev->name, &ovsbr->config.vlan.tag) ||
 	    ni_ovs_vsctl_bridge_ports(dev->name, &ovsbr->ports)) {
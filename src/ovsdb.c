@@ -0,0 +1,869 @@
+/*
+ *	OVSDB JSON-RPC monitor client
+ *
+ *	Copyright (C) 2026 SUSE LLC
+ *
+ *	This program is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation; either version 2 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License along
+ *	with this program; if not, see <http://www.gnu.org/licenses/> or write
+ *	to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *	Boston, MA 02110-1301 USA.
+ *
+ *	The client keeps a persistent connection to the ovsdb-server and
+ *	monitors the Bridge and Port tables (RFC 7047), so the OVS bridge
+ *	discovery does not need to run ovs-vsctl on each link event.
+ *	The bridge, vlan (fake) bridge and port relations are resolved
+ *	the same way as ovs-vsctl br-to-parent, br-to-vlan and list-ports.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <wicked/util.h>
+#include <wicked/logging.h>
+#include <wicked/netinfo.h>
+#include <wicked/socket.h>
+#include "socket_priv.h"
+#include "buffer.h"
+#include "json.h"
+#include "ovsdb.h"
+#include "ovs.h"
+#include "util_priv.h"
+
+#define NI_OVSDB_DATABASE		"Open_vSwitch"
+#define NI_OVSDB_VSCTL_TOOL		"/usr/bin/ovs-vsctl"
+#define NI_OVSDB_TABLE_HASH		256
+#define NI_OVSDB_RECV_CHUNK		4096
+#define NI_OVSDB_SYNC_TIMEOUT		2000	/* msec */
+#define NI_OVSDB_RECONNECT_TIMEOUT	10000	/* msec */
+
+typedef struct ni_ovsdb_row	ni_ovsdb_row_t;
+
+struct ni_ovsdb_row {
+	ni_ovsdb_row_t *	next;
+
+	char *			uuid;
+	char *			name;
+	ni_string_array_t	ports;		/* Bridge: Port row uuids     */
+	int			tag;		/* Port: vlan tag or -1       */
+	ni_bool_t		fake_bridge;	/* Port: vlan (fake) bridge   */
+};
+
+typedef struct ni_ovsdb_table {
+	unsigned int		count;
+	ni_ovsdb_row_t *	hash[NI_OVSDB_TABLE_HASH];
+} ni_ovsdb_table_t;
+
+typedef struct ni_ovsdb_client {
+	char *			path;
+	ni_socket_t *		sock;
+	const ni_timer_t *	timer;
+
+	int64_t			next_id;
+	int64_t			monitor_id;
+	ni_bool_t		synced;
+
+	struct {
+		char *		data;
+		size_t		len;
+		size_t		size;
+		size_t		scan;
+		unsigned int	depth;
+		ni_bool_t	string;
+		ni_bool_t	escape;
+	} rbuf;
+
+	ni_ovsdb_table_t	bridges;
+	ni_ovsdb_table_t	ports;
+} ni_ovsdb_client_t;
+
+static ni_ovsdb_client_t *	ni_ovsdb_client;
+
+static int			ni_ovsdb_client_connect(ni_ovsdb_client_t *);
+static void			ni_ovsdb_client_disconnect(ni_ovsdb_client_t *);
+static void			ni_ovsdb_client_reconnect(ni_ovsdb_client_t *);
+
+/*
+ * Table rows hashed by uuid
+ */
+static unsigned int
+ni_ovsdb_uuid_hash(const char *uuid)
+{
+	unsigned int hash = 0;
+
+	while (uuid && *uuid)
+		hash = hash * 31 + (unsigned char)*uuid++;
+	return hash % NI_OVSDB_TABLE_HASH;
+}
+
+static void
+ni_ovsdb_row_free(ni_ovsdb_row_t *row)
+{
+	if (row) {
+		ni_string_free(&row->uuid);
+		ni_string_free(&row->name);
+		ni_string_array_destroy(&row->ports);
+		free(row);
+	}
+}
+
+static ni_ovsdb_row_t *
+ni_ovsdb_table_find(const ni_ovsdb_table_t *table, const char *uuid)
+{
+	ni_ovsdb_row_t *row;
+
+	for (row = table->hash[ni_ovsdb_uuid_hash(uuid)]; row; row = row->next) {
+		if (ni_string_eq(row->uuid, uuid))
+			return row;
+	}
+	return NULL;
+}
+
+static ni_ovsdb_row_t *
+ni_ovsdb_table_get(ni_ovsdb_table_t *table, const char *uuid)
+{
+	ni_ovsdb_row_t *row;
+	unsigned int pos;
+
+	if ((row = ni_ovsdb_table_find(table, uuid)))
+		return row;
+
+	pos = ni_ovsdb_uuid_hash(uuid);
+	row = xcalloc(1, sizeof(*row));
+	ni_string_dup(&row->uuid, uuid);
+	row->tag = -1;
+	row->next = table->hash[pos];
+	table->hash[pos] = row;
+	table->count++;
+	return row;
+}
+
+static void
+ni_ovsdb_table_delete(ni_ovsdb_table_t *table, const char *uuid)
+{
+	ni_ovsdb_row_t **pos, *row;
+
+	for (pos = &table->hash[ni_ovsdb_uuid_hash(uuid)]; (row = *pos); pos = &row->next) {
+		if (ni_string_eq(row->uuid, uuid)) {
+			*pos = row->next;
+			ni_ovsdb_row_free(row);
+			table->count--;
+			return;
+		}
+	}
+}
+
+static void
+ni_ovsdb_table_destroy(ni_ovsdb_table_t *table)
+{
+	ni_ovsdb_row_t *row;
+	unsigned int i;
+
+	for (i = 0; i < NI_OVSDB_TABLE_HASH; ++i) {
+		while ((row = table->hash[i])) {
+			table->hash[i] = row->next;
+			ni_ovsdb_row_free(row);
+		}
+	}
+	table->count = 0;
+}
+
+/*
+ * OVSDB json value encoding: a set with one element is sent as
+ * the atom itself, other sets as ["set", [atom, ...]]; an uuid
+ * atom is sent as ["uuid", "<uuid>"].
+ */
+static ni_bool_t
+ni_ovsdb_json_is_tagged(ni_json_t *json, const char *tag)
+{
+	char *type = NULL;
+	ni_bool_t ret;
+
+	if (ni_json_type(json) != NI_JSON_TYPE_ARRAY || ni_json_array_entries(json) != 2)
+		return FALSE;
+
+	if (!ni_json_string_get(ni_json_array_get(json, 0), &type))
+		return FALSE;
+
+	ret = ni_string_eq(type, tag);
+	ni_string_free(&type);
+	return ret;
+}
+
+static unsigned int
+ni_ovsdb_json_set_count(ni_json_t *json)
+{
+	if (ni_ovsdb_json_is_tagged(json, "set"))
+		return ni_json_array_entries(ni_json_array_get(json, 1));
+	return json ? 1 : 0;
+}
+
+static ni_json_t *
+ni_ovsdb_json_set_atom(ni_json_t *json, unsigned int pos)
+{
+	if (ni_ovsdb_json_is_tagged(json, "set"))
+		return ni_json_array_get(ni_json_array_get(json, 1), pos);
+	return pos == 0 ? json : NULL;
+}
+
+static ni_bool_t
+ni_ovsdb_json_uuid_get(ni_json_t *json, char **uuid)
+{
+	if (!ni_ovsdb_json_is_tagged(json, "uuid"))
+		return FALSE;
+	return ni_json_string_get(ni_json_array_get(json, 1), uuid);
+}
+
+/*
+ * Apply the table-updates received in the monitor reply and updates
+ */
+static void
+ni_ovsdb_row_update(ni_ovsdb_row_t *row, ni_json_t *columns)
+{
+	ni_json_t *value;
+	unsigned int i, n;
+	int64_t tag;
+
+	if ((value = ni_json_object_get_value(columns, "name")))
+		ni_json_string_get(value, &row->name);
+
+	if ((value = ni_json_object_get_value(columns, "ports"))) {
+		ni_string_array_destroy(&row->ports);
+		n = ni_ovsdb_json_set_count(value);
+		for (i = 0; i < n; ++i) {
+			char *uuid = NULL;
+
+			if (ni_ovsdb_json_uuid_get(ni_ovsdb_json_set_atom(value, i), &uuid))
+				ni_string_array_append(&row->ports, uuid);
+			ni_string_free(&uuid);
+		}
+	}
+
+	if ((value = ni_json_object_get_value(columns, "tag"))) {
+		if (ni_ovsdb_json_set_count(value) == 1 &&
+		    ni_json_int64_get(ni_ovsdb_json_set_atom(value, 0), &tag) &&
+		    tag >= 0 && tag <= 4095)
+			row->tag = tag;
+		else
+			row->tag = -1;
+	}
+
+	if ((value = ni_json_object_get_value(columns, "fake_bridge")))
+		ni_json_bool_get(value, &row->fake_bridge);
+}
+
+static void
+ni_ovsdb_table_update(ni_ovsdb_table_t *table, const char *name, ni_json_t *updates)
+{
+	unsigned int i, n;
+
+	n = ni_json_object_entries(updates);
+	for (i = 0; i < n; ++i) {
+		ni_json_pair_t *pair = ni_json_object_get_pair_at(updates, i);
+		const char *uuid = ni_json_pair_get_name(pair);
+		ni_json_t *columns;
+
+		if (ni_string_empty(uuid))
+			continue;
+
+		columns = ni_json_object_get_value(ni_json_pair_get_value(pair), "new");
+		if (columns) {
+			ni_ovsdb_row_update(ni_ovsdb_table_get(table, uuid), columns);
+		} else {
+			ni_ovsdb_table_delete(table, uuid);
+		}
+	}
+
+	ni_debug_verbose(NI_LOG_DEBUG2, NI_TRACE_EVENTS,
+			"ovsdb: applied %u %s row updates (%u rows)",
+			n, name, table->count);
+}
+
+static void
+ni_ovsdb_client_update(ni_ovsdb_client_t *client, ni_json_t *updates)
+{
+	ni_json_t *table;
+
+	if ((table = ni_json_object_get_value(updates, "Bridge")))
+		ni_ovsdb_table_update(&client->bridges, "Bridge", table);
+	if ((table = ni_json_object_get_value(updates, "Port")))
+		ni_ovsdb_table_update(&client->ports, "Port", table);
+}
+
+/*
+ * Update the ovs bridges in the global state from the cache
+ */
+static void
+ni_ovsdb_client_refresh_bridges(void)
+{
+	ni_netconfig_t *nc;
+	ni_netdev_t *dev;
+
+	if (!(nc = ni_global_state_handle(0)))
+		return;
+
+	for (dev = ni_netconfig_devlist(nc); dev; dev = dev->next) {
+		if (dev->link.type == NI_IFTYPE_OVS_BRIDGE && ni_netdev_device_is_ready(dev))
+			ni_ovs_bridge_discover(dev, nc);
+	}
+}
+
+/*
+ * JSON-RPC messages
+ */
+static int
+ni_ovsdb_client_send(ni_ovsdb_client_t *client, int fd, ni_json_t *msg)
+{
+	ni_stringbuf_t buf = NI_STRINGBUF_INIT_DYNAMIC;
+	size_t off = 0;
+	ssize_t n;
+
+	if (!ni_json_format_string(&buf, msg, NULL)) {
+		ni_stringbuf_destroy(&buf);
+		return -1;
+	}
+
+	while (off < buf.len) {
+		n = send(fd, buf.string + off, buf.len - off, MSG_NOSIGNAL);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			ni_error("ovsdb: unable to send request to %s: %m", client->path);
+			ni_stringbuf_destroy(&buf);
+			return -1;
+		}
+		off += n;
+	}
+	ni_stringbuf_destroy(&buf);
+	return 0;
+}
+
+static int
+ni_ovsdb_client_send_monitor(ni_ovsdb_client_t *client, int fd)
+{
+	static const char *bridge_columns[] = { "name", "ports", NULL };
+	static const char *port_columns[] = { "name", "tag", "fake_bridge", NULL };
+	ni_json_t *msg, *params, *requests, *req, *columns;
+	const char **c;
+	int ret;
+
+	client->monitor_id = ++client->next_id;
+
+	requests = ni_json_new_object();
+
+	req = ni_json_new_object();
+	columns = ni_json_new_array();
+	for (c = bridge_columns; *c; ++c)
+		ni_json_array_append(columns, ni_json_new_string(*c));
+	ni_json_object_set(req, "columns", columns);
+	ni_json_object_set(requests, "Bridge", req);
+
+	req = ni_json_new_object();
+	columns = ni_json_new_array();
+	for (c = port_columns; *c; ++c)
+		ni_json_array_append(columns, ni_json_new_string(*c));
+	ni_json_object_set(req, "columns", columns);
+	ni_json_object_set(requests, "Port", req);
+
+	params = ni_json_new_array();
+	ni_json_array_append(params, ni_json_new_string(NI_OVSDB_DATABASE));
+	ni_json_array_append(params, ni_json_new_null());
+	ni_json_array_append(params, requests);
+
+	msg = ni_json_new_object();
+	ni_json_object_set(msg, "id", ni_json_new_int64(client->monitor_id));
+	ni_json_object_set(msg, "method", ni_json_new_string("monitor"));
+	ni_json_object_set(msg, "params", params);
+
+	ret = ni_ovsdb_client_send(client, fd, msg);
+	ni_json_free(msg);
+	return ret;
+}
+
+static void
+ni_ovsdb_client_echo(ni_ovsdb_client_t *client, int fd, ni_json_t *request)
+{
+	ni_json_t *reply;
+
+	reply = ni_json_new_object();
+	ni_json_object_set(reply, "id", ni_json_clone(ni_json_object_get_value(request, "id")));
+	ni_json_object_set(reply, "result", ni_json_clone(ni_json_object_get_value(request, "params")));
+	ni_json_object_set(reply, "error", ni_json_new_null());
+
+	ni_ovsdb_client_send(client, fd, reply);
+	ni_json_free(reply);
+}
+
+static void
+ni_ovsdb_client_process(ni_ovsdb_client_t *client, int fd, ni_json_t *msg)
+{
+	ni_json_t *params, *error;
+	char *method = NULL;
+	int64_t id;
+
+	if (ni_json_string_get(ni_json_object_get_value(msg, "method"), &method)) {
+		if (ni_string_eq(method, "update")) {
+			params = ni_json_object_get_value(msg, "params");
+			ni_ovsdb_client_update(client, ni_json_array_get(params, 1));
+			if (client->synced)
+				ni_ovsdb_client_refresh_bridges();
+		} else
+		if (ni_string_eq(method, "echo")) {
+			ni_ovsdb_client_echo(client, fd, msg);
+		}
+		ni_string_free(&method);
+		return;
+	}
+
+	if (!ni_json_int64_get(ni_json_object_get_value(msg, "id"), &id) ||
+	    id != client->monitor_id)
+		return;
+
+	error = ni_json_object_get_value(msg, "error");
+	if (error && ni_json_type(error) != NI_JSON_TYPE_NULL) {
+		ni_stringbuf_t buf = NI_STRINGBUF_INIT_DYNAMIC;
+
+		ni_error("ovsdb: monitor request failed: %s",
+				ni_json_format_string(&buf, error, NULL));
+		ni_stringbuf_destroy(&buf);
+		return;
+	}
+
+	ni_ovsdb_client_update(client, ni_json_object_get_value(msg, "result"));
+	client->synced = TRUE;
+	if (client->timer) {
+		ni_timer_cancel(client->timer);
+		client->timer = NULL;
+	}
+
+	ni_debug_socket("ovsdb: monitoring %s: %u bridges, %u ports",
+			client->path, client->bridges.count, client->ports.count);
+
+	/* bridges discovered via ovs-vsctl while not synced */
+	ni_ovsdb_client_refresh_bridges();
+}
+
+/*
+ * The server sends a stream of json objects without any framing;
+ * find the end of the next complete object in the receive buffer.
+ */
+static ni_bool_t
+ni_ovsdb_client_frame(ni_ovsdb_client_t *client, size_t *end)
+{
+	size_t pos;
+	char cc;
+
+	for (pos = client->rbuf.scan; pos < client->rbuf.len; ++pos) {
+		cc = client->rbuf.data[pos];
+
+		if (client->rbuf.string) {
+			if (client->rbuf.escape)
+				client->rbuf.escape = FALSE;
+			else if (cc == '\\')
+				client->rbuf.escape = TRUE;
+			else if (cc == '"')
+				client->rbuf.string = FALSE;
+			continue;
+		}
+
+		switch (cc) {
+		case '"':
+			client->rbuf.string = TRUE;
+			break;
+		case '{':
+		case '[':
+			client->rbuf.depth++;
+			break;
+		case '}':
+		case ']':
+			if (client->rbuf.depth && --client->rbuf.depth == 0) {
+				client->rbuf.scan = 0;
+				*end = pos + 1;
+				return TRUE;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	client->rbuf.scan = pos;
+	return FALSE;
+}
+
+static int
+ni_ovsdb_client_recv(ni_ovsdb_client_t *client, int fd)
+{
+	ni_buffer_t buf;
+	ni_json_t *msg;
+	size_t end;
+	ssize_t n;
+
+	do {
+		if (client->rbuf.size - client->rbuf.len < NI_OVSDB_RECV_CHUNK) {
+			client->rbuf.size += NI_OVSDB_RECV_CHUNK;
+			client->rbuf.data = xrealloc(client->rbuf.data, client->rbuf.size);
+		}
+
+		n = recv(fd, client->rbuf.data + client->rbuf.len,
+				client->rbuf.size - client->rbuf.len, MSG_DONTWAIT);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			ni_error("ovsdb: unable to receive from %s: %m", client->path);
+			return -1;
+		}
+		if (n == 0) {
+			ni_debug_socket("ovsdb: connection to %s closed", client->path);
+			return -1;
+		}
+		client->rbuf.len += n;
+
+		while (ni_ovsdb_client_frame(client, &end)) {
+			ni_buffer_init_reader(&buf, client->rbuf.data, end);
+			if (!(msg = ni_json_parse_buffer(&buf))) {
+				ni_error("ovsdb: unable to parse message from %s", client->path);
+				return -1;
+			}
+			ni_ovsdb_client_process(client, fd, msg);
+			ni_json_free(msg);
+
+			client->rbuf.len -= end;
+			memmove(client->rbuf.data, client->rbuf.data + end, client->rbuf.len);
+		}
+	} while (1);
+
+	return 0;
+}
+
+/*
+ * Connection handling
+ */
+static void
+ni_ovsdb_client_reconnect_timeout(void *user_data, const ni_timer_t *timer)
+{
+	ni_ovsdb_client_t *client = user_data;
+
+	if (client != ni_ovsdb_client || client->timer != timer)
+		return;
+
+	client->timer = NULL;
+	if (ni_ovsdb_client_connect(client) < 0)
+		ni_ovsdb_client_reconnect(client);
+}
+
+static void
+ni_ovsdb_client_sync_timeout(void *user_data, const ni_timer_t *timer)
+{
+	ni_ovsdb_client_t *client = user_data;
+
+	if (client != ni_ovsdb_client || client->timer != timer)
+		return;
+
+	client->timer = NULL;
+	ni_error("ovsdb: timeout waiting for monitor reply from %s", client->path);
+	ni_ovsdb_client_reconnect(client);
+}
+
+static void
+ni_ovsdb_client_reconnect(ni_ovsdb_client_t *client)
+{
+	ni_ovsdb_client_disconnect(client);
+	client->timer = ni_timer_register(NI_OVSDB_RECONNECT_TIMEOUT,
+			ni_ovsdb_client_reconnect_timeout, client);
+}
+
+static void
+ni_ovsdb_client_sock_recv(ni_socket_t *sock)
+{
+	ni_ovsdb_client_t *client = sock->user_data;
+
+	if (ni_ovsdb_client_recv(client, sock->__fd) < 0)
+		ni_ovsdb_client_reconnect(client);
+}
+
+static void
+ni_ovsdb_client_sock_hangup(ni_socket_t *sock)
+{
+	ni_ovsdb_client_t *client = sock->user_data;
+
+	ni_debug_socket("ovsdb: connection to %s lost", client->path);
+	ni_ovsdb_client_reconnect(client);
+}
+
+static void
+ni_ovsdb_client_sock_error(ni_socket_t *sock)
+{
+	ni_ovsdb_client_t *client = sock->user_data;
+
+	ni_debug_socket("ovsdb: connection to %s failed", client->path);
+	ni_ovsdb_client_reconnect(client);
+}
+
+/*
+ * Connect and send the monitor request; the reply with the initial
+ * table contents is received asynchronously on the socket.
+ */
+static int
+ni_ovsdb_client_connect(ni_ovsdb_client_t *client)
+{
+	struct sockaddr_un sun;
+	int fd;
+
+	memset(&sun, 0, sizeof(sun));
+	sun.sun_family = AF_UNIX;
+	if (ni_string_len(client->path) >= sizeof(sun.sun_path)) {
+		ni_error("ovsdb: socket path %s too long", client->path);
+		return -1;
+	}
+	strcpy(sun.sun_path, client->path);
+
+	if ((fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0)) < 0) {
+		ni_error("ovsdb: unable to create socket: %m");
+		return -1;
+	}
+
+	if (connect(fd, (struct sockaddr *)&sun, sizeof(sun)) < 0) {
+		ni_debug_socket("ovsdb: unable to connect to %s: %m", client->path);
+		close(fd);
+		return -1;
+	}
+
+	if (!(client->sock = ni_socket_wrap(fd, SOCK_STREAM))) {
+		close(fd);
+		return -1;
+	}
+	client->sock->user_data = client;
+	client->sock->receive = ni_ovsdb_client_sock_recv;
+	client->sock->handle_hangup = ni_ovsdb_client_sock_hangup;
+	client->sock->handle_error = ni_ovsdb_client_sock_error;
+	ni_socket_activate(client->sock);
+
+	if (ni_ovsdb_client_send_monitor(client, fd) < 0) {
+		ni_ovsdb_client_disconnect(client);
+		return -1;
+	}
+
+	client->timer = ni_timer_register(NI_OVSDB_SYNC_TIMEOUT,
+			ni_ovsdb_client_sync_timeout, client);
+	return 0;
+}
+
+static void
+ni_ovsdb_client_disconnect(ni_ovsdb_client_t *client)
+{
+	if (client->timer) {
+		ni_timer_cancel(client->timer);
+		client->timer = NULL;
+	}
+	if (client->sock) {
+		ni_socket_close(client->sock);
+		client->sock = NULL;
+	}
+
+	free(client->rbuf.data);
+	memset(&client->rbuf, 0, sizeof(client->rbuf));
+
+	ni_ovsdb_table_destroy(&client->bridges);
+	ni_ovsdb_table_destroy(&client->ports);
+	client->synced = FALSE;
+}
+
+/*
+ * Whether openvswitch is installed or its database server is running
+ */
+static ni_bool_t
+ni_ovsdb_installed(void)
+{
+	return ni_file_exists(NI_OVSDB_DEFAULT_SOCKET) ||
+		ni_file_executable(NI_OVSDB_VSCTL_TOOL);
+}
+
+/*
+ * Start to monitor the ovsdb.  ovs-vsctl is used until the monitor
+ * reply arrived and, when the server is not (yet) running, while the
+ * connect is retried.  Without an explicit socket path, the monitor
+ * is not started at all when openvswitch is not installed.
+ */
+int
+ni_ovsdb_monitor_open(const char *path)
+{
+	ni_ovsdb_client_t *client;
+
+	if (ni_ovsdb_client)
+		return 0;
+
+	if (!path && !ni_ovsdb_installed())
+		return -1;
+
+	client = xcalloc(1, sizeof(*client));
+	ni_string_dup(&client->path, path ? path : NI_OVSDB_DEFAULT_SOCKET);
+	ni_ovsdb_client = client;
+
+	if (ni_ovsdb_client_connect(client) < 0) {
+		ni_ovsdb_client_reconnect(client);
+		return -1;
+	}
+	return 0;
+}
+
+void
+ni_ovsdb_monitor_close(void)
+{
+	ni_ovsdb_client_t *client;
+
+	if (!(client = ni_ovsdb_client))
+		return;
+
+	ni_ovsdb_client = NULL;
+	ni_ovsdb_client_disconnect(client);
+	ni_string_free(&client->path);
+	free(client);
+}
+
+ni_bool_t
+ni_ovsdb_monitor_active(void)
+{
+	return ni_ovsdb_client && ni_ovsdb_client->sock && ni_ovsdb_client->synced;
+}
+
+/*
+ * Bridge queries on the cache
+ */
+static ni_ovsdb_row_t *
+ni_ovsdb_bridge_by_name(const ni_ovsdb_client_t *client, const char *name)
+{
+	ni_ovsdb_row_t *row;
+	unsigned int i;
+
+	for (i = 0; i < NI_OVSDB_TABLE_HASH; ++i) {
+		for (row = client->bridges.hash[i]; row; row = row->next) {
+			if (ni_string_eq(row->name, name))
+				return row;
+		}
+	}
+	return NULL;
+}
+
+static ni_ovsdb_row_t *
+ni_ovsdb_fake_bridge_by_name(const ni_ovsdb_client_t *client, const char *name,
+				ni_ovsdb_row_t **parent)
+{
+	ni_ovsdb_row_t *row, *port;
+	unsigned int i, p;
+
+	for (i = 0; i < NI_OVSDB_TABLE_HASH; ++i) {
+		for (row = client->bridges.hash[i]; row; row = row->next) {
+			for (p = 0; p < row->ports.count; ++p) {
+				port = ni_ovsdb_table_find(&client->ports, row->ports.data[p]);
+				if (!port || !port->fake_bridge || port->tag < 0)
+					continue;
+				if (!ni_string_eq(port->name, name))
+					continue;
+				*parent = row;
+				return port;
+			}
+		}
+	}
+	return NULL;
+}
+
+static ni_bool_t
+ni_ovsdb_bridge_has_fake_tag(const ni_ovsdb_client_t *client, const ni_ovsdb_row_t *bridge, int tag)
+{
+	ni_ovsdb_row_t *port;
+	unsigned int p;
+
+	for (p = 0; p < bridge->ports.count; ++p) {
+		port = ni_ovsdb_table_find(&client->ports, bridge->ports.data[p]);
+		if (port && port->fake_bridge && port->tag == tag)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static int
+ni_ovsdb_port_name_cmp(const void *a, const void *b)
+{
+	return strcmp(*(const char * const *)a, *(const char * const *)b);
+}
+
+int
+ni_ovsdb_bridge_exists(const char *brname)
+{
+	ni_ovsdb_row_t *parent;
+
+	if (!ni_ovsdb_monitor_active() || ni_string_empty(brname))
+		return -1;
+
+	if (ni_ovsdb_bridge_by_name(ni_ovsdb_client, brname))
+		return 0;
+	if (ni_ovsdb_fake_bridge_by_name(ni_ovsdb_client, brname, &parent))
+		return 0;
+	return 1;
+}
+
+int
+ni_ovsdb_bridge_discover(const char *brname, ni_ovs_bridge_t *ovsbr)
+{
+	const ni_ovsdb_client_t *client = ni_ovsdb_client;
+	ni_string_array_t names = NI_STRING_ARRAY_INIT;
+	ni_ovsdb_row_t *bridge, *fake = NULL, *port;
+	unsigned int p;
+
+	if (!ni_ovsdb_monitor_active() || ni_string_empty(brname) || !ovsbr)
+		return -1;
+
+	if (!(bridge = ni_ovsdb_bridge_by_name(client, brname)) &&
+	    !(fake = ni_ovsdb_fake_bridge_by_name(client, brname, &bridge))) {
+		ni_error("%s: unable to find ovs bridge in ovsdb", brname);
+		return -1;
+	}
+
+	if (fake) {
+		ni_netdev_ref_set_ifname(&ovsbr->config.vlan.parent, bridge->name);
+		ovsbr->config.vlan.tag = fake->tag;
+	}
+
+	for (p = 0; p < bridge->ports.count; ++p) {
+		port = ni_ovsdb_table_find(&client->ports, bridge->ports.data[p]);
+		if (!port || ni_string_empty(port->name) || port->fake_bridge)
+			continue;
+		if (ni_string_eq(port->name, brname))
+			continue;
+
+		if (fake) {
+			if (port->tag != fake->tag)
+				continue;
+		} else
+		if (port->tag >= 0 && ni_ovsdb_bridge_has_fake_tag(client, bridge, port->tag))
+			continue;
+
+		ni_string_array_append(&names, port->name);
+	}
+
+	if (names.count > 1)
+		qsort(names.data, names.count, sizeof(names.data[0]), ni_ovsdb_port_name_cmp);
+	for (p = 0; p < names.count; ++p)
+		ni_ovs_bridge_port_array_add_new(&ovsbr->ports, names.data[p]);
+	ni_string_array_destroy(&names);
+
+	return 0;
+}
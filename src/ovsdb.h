@@ -0,0 +1,37 @@
+/*
+ *	OVSDB JSON-RPC monitor client
+ *
+ *	Copyright (C) 2026 SUSE LLC
+ *
+ *	This program is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation; either version 2 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License along
+ *	with this program; if not, see <http://www.gnu.org/licenses/> or write
+ *	to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *	Boston, MA 02110-1301 USA.
+ *
+ */
+#ifndef NI_WICKED_OVSDB_H
+#define NI_WICKED_OVSDB_H
+
+#include <wicked/types.h>
+#include <wicked/ovs.h>
+
+#define NI_OVSDB_DEFAULT_SOCKET		"/run/openvswitch/db.sock"
+
+extern int		ni_ovsdb_monitor_open(const char *);
+extern void		ni_ovsdb_monitor_close(void);
+extern ni_bool_t	ni_ovsdb_monitor_active(void);
+
+extern int		ni_ovsdb_bridge_exists(const char *);
+extern int		ni_ovsdb_bridge_discover(const char *, ni_ovs_bridge_t *);
+
+#endif /* NI_WICKED_OVSDB_H */
@@ -1695,6 +1695,301 @@ ni_route_array_sort_rev(ni_route_array_t *nra)
 }
 
 
+/*
+ * Per-table prefix index: a path compressed binary trie per address
+ * family. Each node refers (without holding a reference) to the routes
+ * of the table with exactly its destination prefix, in table order.
+ */
+typedef struct ni_route_trie		ni_route_trie_t;
+typedef struct ni_route_trie_node	ni_route_trie_node_t;
+
+struct ni_route_trie_node {
+	ni_route_trie_node_t *	parent;
+	ni_route_trie_node_t *	child[2];
+	unsigned int		plen;
+	unsigned char		prefix[16];
+	ni_route_array_t	routes;		/* weak refs */
+};
+
+struct ni_route_trie {
+	ni_route_trie_node_t *	root[2];	/* AF_INET, AF_INET6 */
+};
+
+static inline int
+ni_route_trie_family(unsigned int family, unsigned int *alen)
+{
+	switch (family) {
+	case AF_INET:
+		*alen = 32;
+		return 0;
+	case AF_INET6:
+		*alen = 128;
+		return 1;
+	default:
+		return -1;
+	}
+}
+
+static ni_bool_t
+ni_route_trie_key(unsigned int family, const ni_sockaddr_t *addr, unsigned char *key)
+{
+	memset(key, 0, 16);
+	if (!addr || addr->ss_family != family)
+		return FALSE;
+
+	if (family == AF_INET)
+		memcpy(key, &addr->sin.sin_addr, 4);
+	else
+		memcpy(key, &addr->six.sin6_addr, 16);
+	return TRUE;
+}
+
+static inline unsigned int
+ni_route_trie_bit(const unsigned char *key, unsigned int bit)
+{
+	return (key[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+
+static unsigned int
+ni_route_trie_common(const unsigned char *a, const unsigned char *b, unsigned int max)
+{
+	unsigned int len = 0;
+	unsigned char diff;
+
+	while (len < max) {
+		if ((diff = a[len >> 3] ^ b[len >> 3]) == 0) {
+			len += 8;
+			continue;
+		}
+		while (!(diff & 0x80)) {
+			diff <<= 1;
+			len++;
+		}
+		break;
+	}
+	return len < max ? len : max;
+}
+
+static ni_route_trie_node_t *
+ni_route_trie_node_new(const unsigned char *key, unsigned int plen, ni_route_trie_node_t *parent)
+{
+	ni_route_trie_node_t *node;
+	unsigned int bytes;
+
+	node = xcalloc(1, sizeof(*node));
+	node->parent = parent;
+	node->plen = plen;
+
+	bytes = plen >> 3;
+	memcpy(node->prefix, key, bytes);
+	if (plen & 7)
+		node->prefix[bytes] = key[bytes] & (0xff << (8 - (plen & 7)));
+	return node;
+}
+
+static void
+ni_route_trie_node_free(ni_route_trie_node_t *node)
+{
+	if (node) {
+		ni_route_trie_node_free(node->child[0]);
+		ni_route_trie_node_free(node->child[1]);
+		free(node->routes.data);
+		free(node);
+	}
+}
+
+static ni_route_trie_node_t *
+ni_route_trie_find(ni_route_trie_node_t *node, const unsigned char *key, unsigned int plen)
+{
+	while (node) {
+		if (node->plen > plen)
+			return NULL;
+		if (ni_route_trie_common(node->prefix, key, node->plen) < node->plen)
+			return NULL;
+		if (node->plen == plen)
+			return node;
+		node = node->child[ni_route_trie_bit(key, node->plen)];
+	}
+	return NULL;
+}
+
+static ni_route_trie_node_t *
+ni_route_trie_get(ni_route_trie_node_t **pos, const unsigned char *key, unsigned int plen)
+{
+	ni_route_trie_node_t *node, *parent = NULL, *glue, *leaf;
+	unsigned int common;
+
+	while ((node = *pos) != NULL) {
+		common = ni_route_trie_common(node->prefix, key,
+				node->plen < plen ? node->plen : plen);
+
+		if (common < node->plen) {
+			if (common == plen) {
+				/* new node becomes the parent of this one */
+				leaf = ni_route_trie_node_new(key, plen, parent);
+				leaf->child[ni_route_trie_bit(node->prefix, plen)] = node;
+				node->parent = leaf;
+				*pos = leaf;
+				return leaf;
+			}
+
+			/* diverging at common bit: insert a glue node */
+			glue = ni_route_trie_node_new(key, common, parent);
+			leaf = ni_route_trie_node_new(key, plen, glue);
+			glue->child[ni_route_trie_bit(node->prefix, common)] = node;
+			glue->child[ni_route_trie_bit(key, common)] = leaf;
+			node->parent = glue;
+			*pos = glue;
+			return leaf;
+		}
+
+		if (node->plen == plen)
+			return node;
+
+		parent = node;
+		pos = &node->child[ni_route_trie_bit(key, node->plen)];
+	}
+
+	*pos = ni_route_trie_node_new(key, plen, parent);
+	return *pos;
+}
+
+static void
+ni_route_trie_prune(ni_route_trie_node_t **root, ni_route_trie_node_t *node)
+{
+	ni_route_trie_node_t *parent, *child, **pos;
+
+	while (node && !node->routes.count && !(node->child[0] && node->child[1])) {
+		child = node->child[0] ? node->child[0] : node->child[1];
+		parent = node->parent;
+		pos = parent ? &parent->child[parent->child[1] == node] : root;
+
+		*pos = child;
+		if (child)
+			child->parent = parent;
+
+		free(node->routes.data);
+		free(node);
+		node = parent;
+	}
+}
+
+static void
+ni_route_trie_insert(ni_route_trie_t *trie, ni_route_t *rp)
+{
+	unsigned char key[16];
+	ni_route_trie_node_t *node;
+	unsigned int alen;
+	int fam;
+
+	if ((fam = ni_route_trie_family(rp->family, &alen)) < 0 || rp->prefixlen > alen)
+		return;
+
+	ni_route_trie_key(rp->family, &rp->destination, key);
+	node = ni_route_trie_get(&trie->root[fam], key, rp->prefixlen);
+	ni_route_array_append(&node->routes, rp);
+}
+
+static ni_bool_t
+ni_route_trie_remove(ni_route_trie_t *trie, const ni_route_t *rp)
+{
+	unsigned char key[16];
+	ni_route_trie_node_t *node;
+	unsigned int alen, i;
+	int fam;
+
+	if ((fam = ni_route_trie_family(rp->family, &alen)) < 0 || rp->prefixlen > alen)
+		return TRUE;
+
+	ni_route_trie_key(rp->family, &rp->destination, key);
+	if (!(node = ni_route_trie_find(trie->root[fam], key, rp->prefixlen)))
+		return FALSE;
+
+	for (i = 0; i < node->routes.count; ++i) {
+		if (node->routes.data[i] == rp) {
+			/* weak ref, just drop the pointer */
+			ni_route_array_remove(&node->routes, i);
+			ni_route_trie_prune(&trie->root[fam], node);
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+static void
+ni_route_trie_free(ni_route_trie_t *trie)
+{
+	if (trie) {
+		ni_route_trie_node_free(trie->root[0]);
+		ni_route_trie_node_free(trie->root[1]);
+		free(trie);
+	}
+}
+
+/*
+ * Return the index of the table, building it on first use after it
+ * has been dropped.  All changes of the table routes array have to
+ * update or drop the index.
+ */
+static ni_route_trie_t *
+ni_route_table_trie(ni_route_table_t *tab)
+{
+	unsigned int i;
+
+	if (tab->trie)
+		return tab->trie;
+
+	tab->trie = xcalloc(1, sizeof(*tab->trie));
+	for (i = 0; i < tab->routes.count; ++i) {
+		if (tab->routes.data[i])
+			ni_route_trie_insert(tab->trie, tab->routes.data[i]);
+	}
+	return tab->trie;
+}
+
+static void
+ni_route_table_trie_drop(ni_route_table_t *tab)
+{
+	ni_route_trie_free(tab->trie);
+	tab->trie = NULL;
+}
+
+static void
+ni_route_table_trie_remove(ni_route_table_t *tab, const ni_route_t *rp)
+{
+	/* destination modified in place: rebuild on next use */
+	if (tab->trie && !ni_route_trie_remove(tab->trie, rp))
+		ni_route_table_trie_drop(tab);
+}
+
+/*
+ * Candidate routes with the destination prefix of rp, or NULL when
+ * the trie is not applicable to the match function or route family.
+ */
+static ni_route_array_t *
+ni_route_table_candidates(ni_route_table_t *tab, const ni_route_t *rp,
+		ni_bool_t (*match)(const ni_route_t *, const ni_route_t *),
+		ni_bool_t *indexed)
+{
+	ni_route_trie_node_t *node;
+	unsigned char key[16];
+	unsigned int alen;
+	int fam;
+
+	*indexed = FALSE;
+	if (match != ni_route_equal && match != ni_route_equal_destination &&
+	    match != ni_route_equal_ref)
+		return NULL;
+
+	if ((fam = ni_route_trie_family(rp->family, &alen)) < 0 || rp->prefixlen > alen)
+		return NULL;
+
+	*indexed = TRUE;
+	ni_route_trie_key(rp->family, &rp->destination, key);
+	node = ni_route_trie_find(ni_route_table_trie(tab)->root[fam], key, rp->prefixlen);
+	return node ? &node->routes : NULL;
+}
+
 /*
  * ni_route_table functions
  */
@@ -1730,10 +2025,71 @@ void
 ni_route_table_clear(ni_route_table_t *tab)
 {
 	if (tab) {
+		ni_route_table_trie_drop(tab);
 		ni_route_array_destroy(&tab->routes);
 	}
 }
 
+ni_route_t *
+ni_route_table_remove(ni_route_table_t *tab, unsigned int index)
+{
+	ni_route_t *rp;
+
+	if (!tab || index >= tab->routes.count)
+		return NULL;
+
+	if ((rp = ni_route_array_remove(&tab->routes, index)))
+		ni_route_table_trie_remove(tab, rp);
+	return rp;
+}
+
+ni_bool_t
+ni_route_table_delete(ni_route_table_t *tab, unsigned int index)
+{
+	ni_route_t *rp;
+
+	if ((rp = ni_route_table_remove(tab, index))) {
+		ni_route_free(rp);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/*
+ * Longest prefix match of addr in the table; the route with the lowest
+ * priority (metric) wins among the routes with the same prefix.
+ */
+ni_route_t *
+ni_route_table_lookup(ni_route_table_t *tab, const ni_sockaddr_t *addr)
+{
+	ni_route_trie_node_t *node, *best = NULL;
+	unsigned char key[16];
+	ni_route_t *rp, *found = NULL;
+	unsigned int alen, i;
+	int fam;
+
+	if (!tab || !addr || (fam = ni_route_trie_family(addr->ss_family, &alen)) < 0)
+		return NULL;
+
+	ni_route_trie_key(addr->ss_family, addr, key);
+	for (node = ni_route_table_trie(tab)->root[fam]; node; ) {
+		if (ni_route_trie_common(node->prefix, key, node->plen) < node->plen)
+			break;
+		if (node->routes.count)
+			best = node;
+		if (node->plen == alen)
+			break;
+		node = node->child[ni_route_trie_bit(key, node->plen)];
+	}
+
+	for (i = 0; best && i < best->routes.count; ++i) {
+		rp = best->routes.data[i];
+		if (!found || rp->priority < found->priority)
+			found = rp;
+	}
+	return found;
+}
+
 /*
  * ni_route_tables list functions
  */
@@ -1742,9 +2098,15 @@ ni_route_tables_add_route(ni_route_table_t **list, ni_route_t *rp)
 {
 	ni_route_table_t *tab;
 
-	if (rp && (tab = ni_route_tables_get(list, rp->table)))
-		return ni_route_array_append(&tab->routes, rp);
-	return FALSE;
+	if (!rp || !(tab = ni_route_tables_get(list, rp->table)))
+		return FALSE;
+
+	if (!ni_route_array_append(&tab->routes, rp))
+		return FALSE;
+
+	if (tab->trie)
+		ni_route_trie_insert(tab->trie, rp);
+	return TRUE;
 }
 
 ni_bool_t
@@ -1767,11 +2129,17 @@ ni_bool_t
 ni_route_tables_del_route(ni_route_table_t *list, ni_route_t *rp)
 {
 	ni_route_table_t *tab;
+	ni_route_t *r;
 
 	if (!rp || !(tab = ni_route_tables_find(list, rp->table)))
 		return FALSE;
 
-	return ni_route_array_delete_ref(&tab->routes, rp);
+	if (!(r = ni_route_array_remove_ref(&tab->routes, rp)))
+		return FALSE;
+
+	ni_route_table_trie_remove(tab, r);
+	ni_route_free(r);
+	return TRUE;
 }
 
 ni_route_t *
@@ -1779,9 +2147,15 @@ ni_route_tables_find_match(ni_route_table_t *list, const ni_route_t *rp,
 		ni_bool_t (*match)(const ni_route_t *, const ni_route_t *))
 {
 	ni_route_table_t *tab;
+	ni_route_array_t *candidates;
+	ni_bool_t indexed;
 
 	if (!rp || !(tab = ni_route_tables_find(list, rp->table)))
 		return NULL;
+
+	candidates = ni_route_table_candidates(tab, rp, match, &indexed);
+	if (indexed)
+		return ni_route_array_find_match(candidates, rp, match);
 	return ni_route_array_find_match(&tab->routes, rp, match);
 }
 
@@ -1791,13 +2165,24 @@ ni_route_tables_find_matches(ni_route_table_t *list, const ni_route_t *rp,
 		ni_route_array_t *matches)
 {
 	ni_route_table_t *tab;
+	ni_route_array_t *candidates;
+	ni_bool_t indexed;
 
 	if (!rp || !(tab = ni_route_tables_find(list, rp->table)))
 		return 0;
 
+	candidates = ni_route_table_candidates(tab, rp, match, &indexed);
+	if (indexed)
+		return ni_route_array_find_matches(candidates, rp, match, matches);
 	return ni_route_array_find_matches(&tab->routes, rp, match, matches);
 }
 
+ni_route_t *
+ni_route_tables_lookup(ni_route_table_t *list, unsigned int tid, const ni_sockaddr_t *addr)
+{
+	return ni_route_table_lookup(ni_route_tables_find(list, tid), addr);
+}
+
 ni_route_table_t *
 ni_route_tables_find(ni_route_table_t *list, unsigned int tid)
 {
@@ -11,6 +11,7 @@
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/poll.h>
+#include <sys/epoll.h>
 #include <sys/un.h>
 #include <signal.h>
 #include <string.h>
@@ -19,6 +20,7 @@
 #include <unistd.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 
 #include <wicked/netinfo.h>
 #include <wicked/logging.h>
@@ -29,21 +31,53 @@
 #include "appconfig.h"
 
 #define	NI_SOCKET_ARRAY_CHUNK	16
+#define NI_SOCKET_EPOLL_EVENTS	64
 
 static void			__ni_socket_close(ni_socket_t *);
 static void			__ni_default_error_handler(ni_socket_t *);
 static void			__ni_default_hangup_handler(ni_socket_t *);
+static void			__ni_socket_unregister(ni_socket_t *);
 
 static ni_socket_array_t	__ni_sockets;
 
+/*
+ * The global socket array is watched using an epoll instance; sockets
+ * are registered on activation and unregistered on deactivation, so
+ * we don't need to rebuild a pollfd array on every loop iteration.
+ * When epoll is not usable, we fall back to ni_socket_array_wait().
+ */
+static struct {
+	int			fd;
+	ni_bool_t		disabled;
+} __ni_socket_epoll = {
+	.fd			= -1,
+	.disabled		= FALSE,
+};
+
+/*
+ * Heap of active sockets with a get_timeout deadline, ordered by the
+ * deadline cached in timeout_expires (sock->timeout_pos is 1-based).
+ */
+static struct {
+	unsigned int		count;
+	unsigned int		size;
+	ni_socket_t **		data;
+} __ni_socket_timeouts;
+
 
 /*
  * Install a socket so we check it for incoming data.
  */
+static void			__ni_socket_register(ni_socket_t *);
+
 ni_bool_t
 ni_socket_activate(ni_socket_t *sock)
 {
-	return ni_socket_array_activate(&__ni_sockets, sock);
+	if (!ni_socket_array_activate(&__ni_sockets, sock))
+		return FALSE;
+
+	__ni_socket_register(sock);
+	return TRUE;
 }
 
 static inline void
@@ -53,6 +87,7 @@ __ni_socket_deactivate(ni_socket_t **slot)
 
 	*slot = NULL;
 	sock->active = NULL;
+	__ni_socket_unregister(sock);
 	ni_socket_release(sock);
 }
 
@@ -69,6 +104,13 @@ void
 ni_socket_deactivate_all(void)
 {
 	ni_socket_array_destroy(&__ni_sockets);
+
+	if (__ni_socket_epoll.fd >= 0) {
+		close(__ni_socket_epoll.fd);
+		__ni_socket_epoll.fd = -1;
+	}
+	free(__ni_socket_timeouts.data);
+	memset(&__ni_socket_timeouts, 0, sizeof(__ni_socket_timeouts));
 }
 
 ni_socket_t *
@@ -110,6 +152,326 @@ __ni_default_hangup_handler(ni_socket_t *sock)
 }
 
 
+/*
+ * Socket timeout heap
+ */
+static inline ni_bool_t
+__ni_socket_timeout_before(unsigned int a, unsigned int b)
+{
+	ni_socket_t **data = __ni_socket_timeouts.data;
+
+	return timercmp(&data[a]->timeout_expires, &data[b]->timeout_expires, <);
+}
+
+static inline void
+__ni_socket_timeout_swap(unsigned int a, unsigned int b)
+{
+	ni_socket_t **data = __ni_socket_timeouts.data;
+	ni_socket_t *tmp = data[a];
+
+	data[a] = data[b];
+	data[b] = tmp;
+	data[a]->timeout_pos = a + 1;
+	data[b]->timeout_pos = b + 1;
+}
+
+static void
+__ni_socket_timeout_sift(unsigned int pos)
+{
+	unsigned int parent, child;
+
+	while (pos > 0) {
+		parent = (pos - 1) / 2;
+		if (!__ni_socket_timeout_before(pos, parent))
+			break;
+		__ni_socket_timeout_swap(pos, parent);
+		pos = parent;
+	}
+
+	while ((child = 2 * pos + 1) < __ni_socket_timeouts.count) {
+		if (child + 1 < __ni_socket_timeouts.count &&
+		    __ni_socket_timeout_before(child + 1, child))
+			child++;
+		if (!__ni_socket_timeout_before(child, pos))
+			break;
+		__ni_socket_timeout_swap(pos, child);
+		pos = child;
+	}
+}
+
+static void
+__ni_socket_timeout_remove(ni_socket_t *sock)
+{
+	unsigned int pos, last;
+
+	if (!sock->timeout_pos)
+		return;
+
+	pos = sock->timeout_pos - 1;
+	last = --__ni_socket_timeouts.count;
+	sock->timeout_pos = 0;
+	timerclear(&sock->timeout_expires);
+
+	if (pos != last) {
+		__ni_socket_timeouts.data[pos] = __ni_socket_timeouts.data[last];
+		__ni_socket_timeouts.data[pos]->timeout_pos = pos + 1;
+		__ni_socket_timeout_sift(pos);
+	}
+	__ni_socket_timeouts.data[last] = NULL;
+}
+
+static void
+__ni_socket_timeout_update(ni_socket_t *sock)
+{
+	struct timeval expires;
+	unsigned int pos;
+
+	timerclear(&expires);
+	if (sock->active != &__ni_sockets || !sock->get_timeout ||
+	    sock->get_timeout(sock, &expires) != 0 || !timerisset(&expires)) {
+		__ni_socket_timeout_remove(sock);
+		return;
+	}
+
+	if (!sock->timeout_pos) {
+		if (__ni_socket_timeouts.count == __ni_socket_timeouts.size) {
+			__ni_socket_timeouts.size += NI_SOCKET_ARRAY_CHUNK;
+			__ni_socket_timeouts.data = xrealloc(__ni_socket_timeouts.data,
+					__ni_socket_timeouts.size * sizeof(ni_socket_t *));
+		}
+		pos = __ni_socket_timeouts.count++;
+		__ni_socket_timeouts.data[pos] = sock;
+		sock->timeout_pos = pos + 1;
+	} else {
+		pos = sock->timeout_pos - 1;
+	}
+
+	sock->timeout_expires = expires;
+	__ni_socket_timeout_sift(pos);
+}
+
+/*
+ * Socket epoll registration
+ */
+static inline unsigned int
+__ni_socket_epoll_events(int poll_flags)
+{
+	unsigned int events = 0;
+
+	if (poll_flags & POLLIN)
+		events |= EPOLLIN;
+	if (poll_flags & POLLPRI)
+		events |= EPOLLPRI;
+	if (poll_flags & POLLOUT)
+		events |= EPOLLOUT;
+	return events;
+}
+
+static void
+__ni_socket_epoll_disable(void)
+{
+	unsigned int i;
+
+	ni_warn("unable to use epoll to watch sockets, falling back to poll");
+
+	for (i = 0; i < __ni_sockets.count; ++i) {
+		if (__ni_sockets.data[i])
+			__ni_sockets.data[i]->epoll = 0;
+	}
+	if (__ni_socket_epoll.fd >= 0)
+		close(__ni_socket_epoll.fd);
+	__ni_socket_epoll.fd = -1;
+	__ni_socket_epoll.disabled = TRUE;
+}
+
+static void
+__ni_socket_epoll_update(ni_socket_t *sock)
+{
+	struct epoll_event ev;
+	int op;
+
+	if (__ni_socket_epoll.disabled || sock->__fd < 0)
+		return;
+
+	if (sock->epoll && sock->epoll_flags == sock->poll_flags)
+		return;
+
+	if (__ni_socket_epoll.fd < 0) {
+		__ni_socket_epoll.fd = epoll_create1(EPOLL_CLOEXEC);
+		if (__ni_socket_epoll.fd < 0) {
+			ni_error("unable to create epoll instance: %m");
+			__ni_socket_epoll_disable();
+			return;
+		}
+	}
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = __ni_socket_epoll_events(sock->poll_flags);
+	ev.data.ptr = sock;
+
+	op = sock->epoll ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+	if (epoll_ctl(__ni_socket_epoll.fd, op, sock->__fd, &ev) < 0) {
+		ni_error("unable to %s socket %d in epoll: %m",
+				sock->epoll ? "modify" : "register", sock->__fd);
+		__ni_socket_epoll_disable();
+		return;
+	}
+	sock->epoll = 1;
+	sock->epoll_flags = sock->poll_flags;
+}
+
+static void
+__ni_socket_register(ni_socket_t *sock)
+{
+	if (sock->active != &__ni_sockets)
+		return;
+
+	__ni_socket_epoll_update(sock);
+	__ni_socket_timeout_update(sock);
+}
+
+static void
+__ni_socket_unregister(ni_socket_t *sock)
+{
+	struct epoll_event ev;
+
+	if (sock->epoll) {
+		/* the fd may be already closed by a close callback */
+		memset(&ev, 0, sizeof(ev));
+		if (sock->__fd >= 0 && __ni_socket_epoll.fd >= 0)
+			epoll_ctl(__ni_socket_epoll.fd, EPOLL_CTL_DEL, sock->__fd, &ev);
+		sock->epoll = 0;
+		sock->epoll_flags = 0;
+	}
+	__ni_socket_timeout_remove(sock);
+}
+
+void
+ni_socket_refresh(ni_socket_t *sock)
+{
+	if (sock && sock->active == &__ni_sockets)
+		__ni_socket_register(sock);
+}
+
+/*
+ * Wait for incoming data on the sockets registered in epoll.
+ */
+static int
+__ni_socket_epoll_wait(ni_socket_array_t *array, long timeout)
+{
+	struct epoll_event events[NI_SOCKET_EPOLL_EVENTS];
+	ni_socket_array_t expired = NI_SOCKET_ARRAY_INIT;
+	struct timeval now, delta;
+	ni_socket_t *sock;
+	int i, count;
+
+	ni_timer_get_time(&now);
+	if (__ni_socket_timeouts.count) {
+		sock = __ni_socket_timeouts.data[0];
+		if (timercmp(&sock->timeout_expires, &now, <)) {
+			timeout = 0;
+		} else {
+			long delta_ms;
+
+			timersub(&sock->timeout_expires, &now, &delta);
+			delta_ms = 1000 * delta.tv_sec + delta.tv_usec / 1000;
+			if (timeout < 0 || delta_ms < timeout)
+				timeout = delta_ms;
+		}
+	}
+
+	if (array->count == 0 && timeout < 0) {
+		ni_debug_socket("no sockets left to watch");
+		return 1;
+	}
+
+	count = epoll_wait(__ni_socket_epoll.fd, events, NI_SOCKET_EPOLL_EVENTS,
+			timeout > INT_MAX ? INT_MAX : (int)timeout);
+	if (count < 0) {
+		if (errno == EINTR)
+			return 0;
+		ni_error("epoll_wait returns error: %m");
+		return -1;
+	}
+
+	/* Registered sockets are held by the array; hold them while
+	 * dispatching as a callback may deactivate another one. */
+	for (i = 0; i < count; ++i)
+		ni_socket_hold(events[i].data.ptr);
+
+	for (i = 0; i < count; ++i) {
+		unsigned int revents = events[i].events;
+
+		sock = events[i].data.ptr;
+		if (sock->active != array || !sock->epoll)
+			goto done_with_this_socket;
+
+		if (revents & EPOLLERR) {
+			/* Deactivate socket */
+			ni_socket_deactivate(sock);
+			sock->handle_error(sock);
+			goto done_with_this_socket;
+		}
+
+		if (revents & (EPOLLIN | EPOLLPRI)) {
+			if (sock->receive == NULL) {
+				ni_error("socket %d has no receive callback", sock->__fd);
+				ni_socket_deactivate(sock);
+			} else {
+				sock->receive(sock);
+			}
+			if (sock->__fd < 0)
+				goto done_with_this_socket;
+		}
+
+		if (revents & EPOLLHUP) {
+			if (sock->handle_hangup)
+				sock->handle_hangup(sock);
+			if (sock->__fd < 0)
+				goto done_with_this_socket;
+		} else
+
+		if (revents & EPOLLOUT) {
+			if (sock->transmit == NULL) {
+				ni_error("socket %d has no transmit callback", sock->__fd);
+				ni_socket_deactivate(sock);
+			} else {
+				sock->transmit(sock);
+			}
+		}
+
+		/* callbacks may have changed poll_flags and deadline */
+		ni_socket_refresh(sock);
+
+done_with_this_socket:
+		ni_socket_release(sock);
+	}
+
+	/* Collect expired sockets first, check_timeout may rearm them */
+	ni_timer_get_time(&now);
+	while (__ni_socket_timeouts.count) {
+		sock = __ni_socket_timeouts.data[0];
+		if (!timercmp(&sock->timeout_expires, &now, <))
+			break;
+
+		__ni_socket_timeout_remove(sock);
+		if (ni_socket_array_append(&expired, sock))
+			ni_socket_hold(sock);
+	}
+
+	for (i = 0; i < (int)expired.count; ++i) {
+		sock = expired.data[i];
+
+		if (sock->active == array && sock->check_timeout)
+			sock->check_timeout(sock, &now);
+
+		ni_socket_refresh(sock);
+	}
+	ni_socket_array_destroy(&expired);
+
+	return 0;
+}
+
 /*
  * Wait for incoming data on any of the sockets.
  */
@@ -240,7 +602,10 @@ done_with_this_socket:
 int
 ni_socket_wait(long timeout)
 {
-	return ni_socket_array_wait(&__ni_sockets, timeout);
+	if (__ni_socket_epoll.fd < 0)
+		return ni_socket_array_wait(&__ni_sockets, timeout);
+
+	return __ni_socket_epoll_wait(&__ni_sockets, timeout);
 }
 
 /*
@@ -282,6 +647,9 @@ ni_socket_wrap(int fd, int sotype)
 static void
 __ni_socket_close(ni_socket_t *sock)
 {
+	/* unregister from epoll while the fd is still valid */
+	__ni_socket_unregister(sock);
+
 	if (sock->close) {
 		sock->close(sock);
 	} else if (sock->__fd >= 0) {
@@ -322,8 +690,10 @@ ni_socket_array_destroy(ni_socket_array_t *array)
 			sock = array->data[array->count];
 			array->data[array->count] = NULL;
 			if (sock) {
-				if (sock->active == array)
+				if (sock->active == array) {
 					sock->active = NULL;
+					__ni_socket_unregister(sock);
+				}
 				ni_socket_release(sock);
 			}
 		}
@@ -390,8 +760,10 @@ ni_socket_array_remove_at(ni_socket_array_t *array, unsigned int index)
 	}
 	array->data[array->count] = NULL;
 
-	if (sock && sock->active == array)
+	if (sock && sock->active == array) {
 		sock->active = NULL;
+		__ni_socket_unregister(sock);
+	}
 	return sock;
 }
 
@@ -8,6 +8,7 @@
 #define __WICKED_SOCKET_PRIV_H__
 
 #include <stdio.h>
+#include <sys/time.h>
 
 #include <wicked/types.h>
 #include <wicked/socket.h>
@@ -18,8 +19,13 @@ struct ni_socket {
 	ni_socket_array_t *	active;
 
 	int		__fd;
-	unsigned int	error  : 1;
+	unsigned int	error  : 1,
+			epoll  : 1;
 	int		poll_flags;
+	int		epoll_flags;
+
+	unsigned int	timeout_pos;
+	struct timeval	timeout_expires;
 
 	ni_buffer_t	rbuf;
 	ni_buffer_t	wbuf;
@@ -59,5 +65,12 @@ extern unsigned int	ni_socket_array_find(ni_socket_array_t *, ni_socket_t *);
 extern ni_bool_t	ni_socket_array_activate(ni_socket_array_t *, ni_socket_t *);
 extern ni_bool_t	ni_socket_array_deactivate(ni_socket_array_t *, ni_socket_t *);
 
+/*
+ * Re-read the poll_flags and the get_timeout deadline of an active
+ * socket. Needed when they're changed outside of a socket callback,
+ * e.g. when a retransmit deadline gets armed by a timer.
+ */
+extern void		ni_socket_refresh(ni_socket_t *);
+
 #endif /* __WICKED_SOCKET_PRIV_H__ */
 
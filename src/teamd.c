@@ -83,8 +83,14 @@ typedef struct ni_teamd_client_ops {
 } ni_teamd_client_ops_t;
 
 struct ni_teamd_client {
+	ni_teamd_client_t *	next;
+
 	ni_teamd_client_ops_t	ops;
 	char *			instance;
+	unsigned int		ifindex;
+
+	/* last discovered (actual) config dump */
+	char *			config;
 
 	/* dbus */
 	ni_dbus_client_t *	dbus;
@@ -166,10 +172,12 @@ ni_teamd_dbus_client_destroy(ni_teamd_client_t *tdc)
 static void
 ni_teamd_dbus_signal(ni_dbus_connection_t *connection, ni_dbus_message_t *msg, void *user_data)
 {
-	/* ni_teamd_client_t *tdc = user_data; */
+	ni_teamd_client_t *tdc = user_data;
 	const char *member = dbus_message_get_member(msg);
 
-	ni_debug_dbus("teamd-client: %s signal received (not handled)", member);
+	ni_debug_dbus("teamd-client: %s signal received, invalidating %s config",
+			member, tdc->instance);
+	ni_string_free(&tdc->config);
 }
 
 static int
@@ -651,10 +659,64 @@ ni_teamd_client_free(ni_teamd_client_t *tdc)
 		if (tdc->ops.destroy)
 			tdc->ops.destroy(tdc);
 		ni_string_free(&tdc->instance);
+		ni_string_free(&tdc->config);
 		free(tdc);
 	}
 }
 
+/*
+ * Persistent per team device clients, so the discovery on
+ * link events does not need to detect the ctl method and
+ * (dbus) connect to teamd on each event again.
+ * The discovery still requests the config dump from teamd
+ * on each event, as teamd does not signal config changes.
+ */
+static ni_teamd_client_t *	ni_teamd_clients;
+
+static ni_teamd_client_t *
+ni_teamd_client_get(const char *instance, unsigned int ifindex)
+{
+	ni_teamd_client_t **pos, *tdc;
+
+	if (ni_string_empty(instance))
+		return NULL;
+
+	for (pos = &ni_teamd_clients; (tdc = *pos); pos = &tdc->next) {
+		if (!ni_string_eq(tdc->instance, instance))
+			continue;
+
+		if (tdc->ifindex == ifindex)
+			return tdc;
+
+		/* device got recreated in the meantime */
+		*pos = tdc->next;
+		ni_teamd_client_free(tdc);
+		break;
+	}
+
+	if (!(tdc = ni_teamd_client_open(instance)))
+		return NULL;
+
+	tdc->ifindex = ifindex;
+	tdc->next = ni_teamd_clients;
+	ni_teamd_clients = tdc;
+	return tdc;
+}
+
+void
+ni_teamd_client_drop(const char *instance)
+{
+	ni_teamd_client_t **pos, *tdc;
+
+	for (pos = &ni_teamd_clients; (tdc = *pos); pos = &tdc->next) {
+		if (ni_string_eq(tdc->instance, instance)) {
+			*pos = tdc->next;
+			ni_teamd_client_free(tdc);
+			return;
+		}
+	}
+}
+
 /*
  * teamd ctl ops
  */
@@ -740,16 +802,16 @@ ni_teamd_port_enslave(const ni_netdev_t *master, const ni_netdev_t *port, const
 {
 	ni_stringbuf_t dump = NI_STRINGBUF_INIT_DYNAMIC;
 	ni_teamd_client_t *tdc;
-	int ret = -1;
 
 	if (!master || !master->name || !port || !port->name)
 		return -1;
 
-	if (!(tdc = ni_teamd_client_open(master->name)))
+	if (!(tdc = ni_teamd_client_get(master->name, master->link.ifindex)))
 		return -1;
 
+	ni_string_free(&tdc->config);
 	if (ni_teamd_ctl_port_add(tdc, port->name) < 0)
-		goto failure;
+		return -1;
 
 	if (config) {
 		ni_json_t *object = ni_teamd_port_config_json(config);
@@ -763,33 +825,25 @@ ni_teamd_port_enslave(const ni_netdev_t *master, const ni_netdev_t *port, const
 		ni_stringbuf_destroy(&dump);
 	}
 
-	ret = 0;
-
-failure:
-	ni_teamd_client_free(tdc);
-	return ret;
+	return 0;
 }
 
 int
 ni_teamd_port_unenslave(const ni_netdev_t *master, const ni_netdev_t *port)
 {
 	ni_teamd_client_t *tdc;
-	int ret = -1;
 
 	if (!master || !master->name || !port || !port->name)
 		return -1;
 
-	if (!(tdc = ni_teamd_client_open(master->name)))
+	if (!(tdc = ni_teamd_client_get(master->name, master->link.ifindex)))
 		return -1;
 
+	ni_string_free(&tdc->config);
 	if (ni_teamd_ctl_port_remove(tdc, port->name) < 0)
-		goto failure;
-
-	ret = 0;
+		return -1;
 
-failure:
-	ni_teamd_client_free(tdc);
-	return ret;
+	return 0;
 }
 
 
@@ -1114,17 +1168,30 @@ ni_teamd_discover(ni_netdev_t *dev)
 	if (!dev || dev->link.type != NI_IFTYPE_TEAM)
 		return -1;
 
+	if (!(tdc = ni_teamd_client_get(dev->name, dev->link.ifindex)))
+		return -1;
+
+	if (ni_teamd_ctl_config_dump(tdc, TRUE, &val) < 0) {
+		/* teamd may have been restarted, reconnect once */
+		ni_teamd_client_drop(dev->name);
+		if (!(tdc = ni_teamd_client_get(dev->name, dev->link.ifindex)))
+			return -1;
+		if (ni_teamd_ctl_config_dump(tdc, TRUE, &val) < 0)
+			goto failure;
+	}
+
+	/* unchanged since last discovery: the dump was requested
+	 * anyway, but the parse and team rebuild can be skipped */
+	if (dev->team && ni_string_eq(tdc->config, val)) {
+		ni_string_free(&val);
+		return 0;
+	}
+
 	/* we are about to replace dev->team, so just
 	 * allocate new one we can drop at any time */
 	if (!(team = ni_team_new()))
 		goto failure;
 
-	if (!(tdc = ni_teamd_client_open(dev->name)))
-		goto failure;
-
-	if (ni_teamd_ctl_config_dump(tdc, TRUE, &val) < 0)
-		goto failure;
-
 	if (!(conf = ni_json_parse_string(val)))
 		goto failure;
 
@@ -1138,15 +1205,15 @@ ni_teamd_discover(ni_netdev_t *dev)
 		goto failure;
 
 	ni_netdev_set_team(dev, team);
-	ni_teamd_client_free(tdc);
+	ni_string_free(&tdc->config);
+	tdc->config = val;
 	ni_json_free(conf);
-	ni_string_free(&val);
 	return 0;
 
 failure:
+	ni_string_free(&tdc->config);
 	ni_json_free(conf);
 	ni_team_free(team);
-	ni_teamd_client_free(tdc);
 	ni_string_free(&val);
 	return -1;
 }
@@ -1572,6 +1639,7 @@ ni_teamd_service_stop(const char *ifname)
 	int rv;
 	char *service = NULL;
 
+	ni_teamd_client_drop(ifname);
 	ni_string_printf(&service, NI_TEAMD_SERVICE_FMT, ifname);
 	rv = ni_systemctl_service_stop(service);
 	ni_teamd_config_file_remove(ifname);
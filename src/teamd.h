@@ -32,6 +32,7 @@ typedef struct ni_teamd_client		ni_teamd_client_t;
 
 ni_teamd_client_t *			ni_teamd_client_open(const char*);
 void					ni_teamd_client_free(ni_teamd_client_t *);
+void					ni_teamd_client_drop(const char *);
 
 extern int				ni_teamd_ctl_config_dump(ni_teamd_client_t *, ni_bool_t, char **);
 extern int				ni_teamd_ctl_state_dump(ni_teamd_client_t *, char **);
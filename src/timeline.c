@@ -0,0 +1,180 @@
+/*
+ *	wicked startup timeline -- per-phase bootstrap profiling
+ *
+ *	Copyright (C) 2026 SUSE LLC
+ *
+ *	This program is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation; either version 2 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License along
+ *	with this program; if not, see <http://www.gnu.org/licenses/> or write
+ *	to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *	Boston, MA 02110-1301 USA.
+ *
+ *	The timeline is recorded between ni_timeline_start() and
+ *	ni_timeline_finish() only; begin/end calls outside of this
+ *	window (e.g. netlink dumps at runtime) are no-ops.
+ *	Nested begin/end of the same phase is counted once.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <time.h>
+#include <string.h>
+
+#include <wicked/types.h>
+#include <wicked/util.h>
+#include <wicked/logging.h>
+#include "timeline.h"
+
+typedef struct ni_timeline_phase_entry {
+	ni_timeline_stats_t	stats;
+	unsigned int		depth;
+	uint64_t		begin;
+} ni_timeline_phase_entry_t;
+
+static struct {
+	ni_bool_t		started;
+	ni_bool_t		finished;
+	uint64_t		start;
+	uint64_t		total;
+	ni_timeline_phase_entry_t phase[__NI_TIMELINE_MAX];
+} ni_timeline;
+
+static const ni_intmap_t	ni_timeline_phase_names[] = {
+	{ "schema",		NI_TIMELINE_SCHEMA	},
+	{ "extensions",		NI_TIMELINE_EXTENSIONS	},
+	{ "netlink",		NI_TIMELINE_NETLINK	},
+	{ "discovery",		NI_TIMELINE_DISCOVERY	},
+	{ "dbus",		NI_TIMELINE_DBUS	},
+	{ "recovery",		NI_TIMELINE_RECOVERY	},
+
+	{ NULL,			__NI_TIMELINE_MAX	}
+};
+
+static uint64_t
+__ni_timeline_now(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0)
+		return 0;
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static inline ni_bool_t
+__ni_timeline_active(void)
+{
+	return ni_timeline.started && !ni_timeline.finished;
+}
+
+void
+ni_timeline_start(void)
+{
+	memset(&ni_timeline, 0, sizeof(ni_timeline));
+	ni_timeline.start = __ni_timeline_now();
+	ni_timeline.started = TRUE;
+}
+
+void
+ni_timeline_finish(void)
+{
+	if (!__ni_timeline_active())
+		return;
+
+	ni_timeline.total = __ni_timeline_now() - ni_timeline.start;
+	ni_timeline.finished = TRUE;
+}
+
+ni_bool_t
+ni_timeline_finished(void)
+{
+	return ni_timeline.finished;
+}
+
+uint64_t
+ni_timeline_total(void)
+{
+	return ni_timeline.total;
+}
+
+void
+ni_timeline_begin(ni_timeline_phase_t type)
+{
+	ni_timeline_phase_entry_t *phase;
+
+	if (type >= __NI_TIMELINE_MAX || !__ni_timeline_active())
+		return;
+
+	phase = &ni_timeline.phase[type];
+	if (phase->depth++)
+		return;
+
+	phase->begin = __ni_timeline_now() - ni_timeline.start;
+	if (!phase->stats.count++)
+		phase->stats.first = phase->begin;
+}
+
+void
+ni_timeline_end(ni_timeline_phase_t type)
+{
+	ni_timeline_phase_entry_t *phase;
+
+	if (type >= __NI_TIMELINE_MAX || !__ni_timeline_active())
+		return;
+
+	phase = &ni_timeline.phase[type];
+	if (!phase->depth || --phase->depth)
+		return;
+
+	phase->stats.last = __ni_timeline_now() - ni_timeline.start;
+	phase->stats.elapsed += phase->stats.last - phase->begin;
+}
+
+const char *
+ni_timeline_phase_name(ni_timeline_phase_t type)
+{
+	return ni_format_uint_mapped(type, ni_timeline_phase_names);
+}
+
+const ni_timeline_stats_t *
+ni_timeline_get_stats(ni_timeline_phase_t type)
+{
+	if (type >= __NI_TIMELINE_MAX || !ni_timeline.started)
+		return NULL;
+	return &ni_timeline.phase[type].stats;
+}
+
+void
+ni_timeline_dump(void)
+{
+	const ni_timeline_stats_t *stats;
+	unsigned int type;
+
+	if (!ni_timeline.finished || !ni_debug_guard(NI_LOG_DEBUG, NI_TRACE_STARTUP))
+		return;
+
+	ni_debug_startup("startup timeline: total %llu.%06llu sec",
+			(unsigned long long)ni_timeline.total / 1000000,
+			(unsigned long long)ni_timeline.total % 1000000);
+
+	for (type = 0; type < __NI_TIMELINE_MAX; ++type) {
+		stats = &ni_timeline.phase[type].stats;
+		if (!stats->count)
+			continue;
+
+		ni_debug_startup("  %-12s %6u x %8llu usec [%llu .. %llu]",
+				ni_timeline_phase_name(type), stats->count,
+				(unsigned long long)stats->elapsed,
+				(unsigned long long)stats->first,
+				(unsigned long long)stats->last);
+	}
+}
@@ -0,0 +1,61 @@
+/*
+ *	wicked startup timeline -- per-phase bootstrap profiling
+ *
+ *	Copyright (C) 2026 SUSE LLC
+ *
+ *	This program is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation; either version 2 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License along
+ *	with this program; if not, see <http://www.gnu.org/licenses/> or write
+ *	to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *	Boston, MA 02110-1301 USA.
+ *
+ */
+#ifndef WICKED_TIMELINE_H
+#define WICKED_TIMELINE_H
+
+#include <stdint.h>
+
+typedef enum {
+	NI_TIMELINE_SCHEMA,
+	NI_TIMELINE_EXTENSIONS,
+	NI_TIMELINE_NETLINK,
+	NI_TIMELINE_DISCOVERY,
+	NI_TIMELINE_DBUS,
+	NI_TIMELINE_RECOVERY,
+
+	__NI_TIMELINE_MAX
+} ni_timeline_phase_t;
+
+/*
+ * Accumulated statistics of a phase; times are in usec
+ * relative to ni_timeline_start().
+ */
+typedef struct ni_timeline_stats {
+	unsigned int		count;
+	uint64_t		elapsed;
+	uint64_t		first;
+	uint64_t		last;
+} ni_timeline_stats_t;
+
+extern void			ni_timeline_start(void);
+extern void			ni_timeline_finish(void);
+extern ni_bool_t		ni_timeline_finished(void);
+extern uint64_t			ni_timeline_total(void);
+
+extern void			ni_timeline_begin(ni_timeline_phase_t);
+extern void			ni_timeline_end(ni_timeline_phase_t);
+
+extern const char *		ni_timeline_phase_name(ni_timeline_phase_t);
+extern const ni_timeline_stats_t *ni_timeline_get_stats(ni_timeline_phase_t);
+extern void			ni_timeline_dump(void);
+
+#endif /* WICKED_TIMELINE_H */
@@ -8,20 +8,42 @@
 #endif
 
 #include <time.h>
+#include <stdint.h>
 #include <sys/time.h>
 #include <wicked/socket.h>
 #include "netinfo_priv.h"
 #include "util_priv.h"
 
+/*
+ * Timers are kept in a binary min-heap ordered by expiry time (and arm
+ * sequence for equal expiry, to keep the order they've been armed in).
+ * Handles are validated using a hash of the registered timers, so that
+ * cancel or rearm of an already expired timer never dereferences it.
+ */
 struct ni_timer {
-	ni_timer_t *		next;
+	ni_timer_t *		next;		/* hash chain */
 	unsigned int		ident;
+	unsigned int		pos;		/* heap position */
+	unsigned long		seq;		/* arm sequence */
 	struct timeval		expires;
 	ni_timeout_callback_t	*callback;
 	void *			user_data;
 };
 
-static ni_timer_t *		ni_timer_list;
+#define NI_TIMER_HEAP_CHUNK	64
+#define NI_TIMER_HASH_MIN_SIZE	64
+
+static struct {
+	unsigned int		count;
+	unsigned int		size;
+	ni_timer_t **		data;
+} ni_timer_heap;
+
+static struct {
+	unsigned int		count;
+	unsigned int		size;
+	ni_timer_t **		buckets;
+} ni_timer_hash;
 
 static void			__ni_timer_arm(ni_timer_t *, unsigned long);
 static ni_timer_t *		__ni_timer_disarm(const ni_timer_t *);
@@ -83,7 +105,7 @@ ni_timer_next_timeout(void)
 	long timeout;
 
 	ni_timer_get_time(&now);
-	while ((timer = ni_timer_list) != NULL) {
+	while (ni_timer_heap.count && (timer = ni_timer_heap.data[0]) != NULL) {
 		if (!timercmp(&timer->expires, &now, <)) {
 			timersub(&timer->expires, &now, &delta);
 			timeout = delta.tv_sec * 1000 + delta.tv_usec / 1000;
@@ -98,7 +120,7 @@ ni_timer_next_timeout(void)
 				__func__, timer,
 				(long) now.tv_sec, (long) now.tv_usec,
 				(long) timer->expires.tv_sec, (long) timer->expires.tv_usec);
-		ni_timer_list = timer->next;
+		__ni_timer_disarm(timer);
 		timer->callback(timer->user_data, timer);
 		free(timer);
 	}
@@ -106,10 +128,151 @@ ni_timer_next_timeout(void)
 	return -1;
 }
 
+/*
+ * Hash of registered timers
+ */
+static inline unsigned int
+__ni_timer_hash_key(const ni_timer_t *timer)
+{
+	uintptr_t key = (uintptr_t)timer;
+
+	key ^= key >> 16;
+	return (unsigned int)(key * 2654435761U);
+}
+
+static void
+__ni_timer_hash_resize(unsigned int size)
+{
+	ni_timer_t **buckets, *timer;
+	unsigned int i, pos;
+
+	buckets = xcalloc(size, sizeof(*buckets));
+	for (i = 0; i < ni_timer_hash.size; ++i) {
+		while ((timer = ni_timer_hash.buckets[i]) != NULL) {
+			ni_timer_hash.buckets[i] = timer->next;
+			pos = __ni_timer_hash_key(timer) & (size - 1);
+			timer->next = buckets[pos];
+			buckets[pos] = timer;
+		}
+	}
+	free(ni_timer_hash.buckets);
+	ni_timer_hash.buckets = buckets;
+	ni_timer_hash.size = size;
+}
+
+static void
+__ni_timer_hash_insert(ni_timer_t *timer)
+{
+	unsigned int pos;
+
+	if (ni_timer_hash.count >= ni_timer_hash.size)
+		__ni_timer_hash_resize(ni_timer_hash.size ? ni_timer_hash.size << 1 :
+							NI_TIMER_HASH_MIN_SIZE);
+
+	pos = __ni_timer_hash_key(timer) & (ni_timer_hash.size - 1);
+	timer->next = ni_timer_hash.buckets[pos];
+	ni_timer_hash.buckets[pos] = timer;
+	ni_timer_hash.count++;
+}
+
+static ni_timer_t *
+__ni_timer_hash_remove(const ni_timer_t *handle)
+{
+	ni_timer_t **pos, *timer;
+
+	if (!handle || !ni_timer_hash.size)
+		return NULL;
+
+	pos = &ni_timer_hash.buckets[__ni_timer_hash_key(handle) & (ni_timer_hash.size - 1)];
+	for ( ; (timer = *pos) != NULL; pos = &timer->next) {
+		if (timer == handle) {
+			*pos = timer->next;
+			timer->next = NULL;
+			ni_timer_hash.count--;
+			return timer;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Timer heap
+ */
+static inline ni_bool_t
+__ni_timer_heap_before(const ni_timer_t *a, const ni_timer_t *b)
+{
+	if (timercmp(&a->expires, &b->expires, !=))
+		return timercmp(&a->expires, &b->expires, <);
+	return a->seq < b->seq;
+}
+
+static inline void
+__ni_timer_heap_set(unsigned int pos, ni_timer_t *timer)
+{
+	ni_timer_heap.data[pos] = timer;
+	timer->pos = pos;
+}
+
+static void
+__ni_timer_heap_sift(unsigned int pos)
+{
+	ni_timer_t *timer = ni_timer_heap.data[pos];
+	unsigned int parent, child;
+
+	while (pos > 0) {
+		parent = (pos - 1) / 2;
+		if (!__ni_timer_heap_before(timer, ni_timer_heap.data[parent]))
+			break;
+		__ni_timer_heap_set(pos, ni_timer_heap.data[parent]);
+		pos = parent;
+	}
+
+	while ((child = 2 * pos + 1) < ni_timer_heap.count) {
+		if (child + 1 < ni_timer_heap.count &&
+		    __ni_timer_heap_before(ni_timer_heap.data[child + 1],
+					   ni_timer_heap.data[child]))
+			child++;
+		if (!__ni_timer_heap_before(ni_timer_heap.data[child], timer))
+			break;
+		__ni_timer_heap_set(pos, ni_timer_heap.data[child]);
+		pos = child;
+	}
+
+	__ni_timer_heap_set(pos, timer);
+}
+
+static void
+__ni_timer_heap_insert(ni_timer_t *timer)
+{
+	if (ni_timer_heap.count == ni_timer_heap.size) {
+		ni_timer_heap.size += NI_TIMER_HEAP_CHUNK;
+		ni_timer_heap.data = xrealloc(ni_timer_heap.data,
+				ni_timer_heap.size * sizeof(ni_timer_t *));
+	}
+
+	__ni_timer_heap_set(ni_timer_heap.count++, timer);
+	__ni_timer_heap_sift(timer->pos);
+}
+
+static void
+__ni_timer_heap_remove(ni_timer_t *timer)
+{
+	unsigned int pos = timer->pos;
+	ni_timer_t *last;
+
+	last = ni_timer_heap.data[--ni_timer_heap.count];
+	ni_timer_heap.data[ni_timer_heap.count] = NULL;
+	if (last != timer) {
+		__ni_timer_heap_set(pos, last);
+		__ni_timer_heap_sift(pos);
+	}
+	timer->pos = 0;
+}
+
 static void
 __ni_timer_arm(ni_timer_t *timer, unsigned long timeout)
 {
-	ni_timer_t *tail, **pos;
+	static unsigned long seq_counter;
 
 	ni_debug_verbose(NI_LOG_DEBUG2, NI_TRACE_TIMER,
 			"%s: timer %p timeout %lu", __func__, timer, timeout);
@@ -120,29 +283,22 @@ __ni_timer_arm(ni_timer_t *timer, unsigned long timeout)
 		timer->expires.tv_sec++;
 		timer->expires.tv_usec -= 1000000;
 	}
+	timer->seq = seq_counter++;
 
-	for (pos = &ni_timer_list; (tail = *pos) != NULL; pos = &tail->next) {
-		if (timercmp(&timer->expires, &tail->expires, <))
-			break;
-	}
-
-	timer->next = tail;
-	*pos = timer;
+	__ni_timer_hash_insert(timer);
+	__ni_timer_heap_insert(timer);
 }
 
 static ni_timer_t *
 __ni_timer_disarm(const ni_timer_t *handle)
 {
-	ni_timer_t **pos, *timer;
+	ni_timer_t *timer;
 
-	for (pos = &ni_timer_list; (timer = *pos) != NULL; pos = &timer->next) {
-		if (timer == handle) {
-			*pos = timer->next;
-			timer->next = NULL;
-			ni_debug_verbose(NI_LOG_DEBUG2, NI_TRACE_TIMER,
-					"%s: timer %p found", __func__, handle);
-			return timer;
-		}
+	if ((timer = __ni_timer_hash_remove(handle)) != NULL) {
+		__ni_timer_heap_remove(timer);
+		ni_debug_verbose(NI_LOG_DEBUG2, NI_TRACE_TIMER,
+				"%s: timer %p found", __func__, handle);
+		return timer;
 	}
 	ni_debug_verbose(NI_LOG_DEBUG2, NI_TRACE_TIMER,
 			"%s: timer %p NOT found", __func__, handle);
@@ -38,6 +38,7 @@
 #include "process.h"
 #include "buffer.h"
 #include "sysfs.h"
+#include "netinfo_priv.h"
 
 
 #ifndef _PATH_SYS_CLASS_NET
@@ -315,8 +316,7 @@ ni_udev_netdev_update_name(ni_netdev_t *dev)
 	if (ni_string_empty(ifname))
 		return -1; /* device seems to be gone */
 
-	if (!ni_string_eq(dev->name, ifname))
-		ni_string_dup(&dev->name, ifname);
+	ni_netconfig_device_rename(ni_global_state_handle(0), dev, ifname);
 
 	return 0;
 }
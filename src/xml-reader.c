@@ -26,7 +26,12 @@
 #endif
 
 #include <ctype.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
 #include <sys/param.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 
 #include <wicked/xml.h>
 #include <wicked/logging.h>
@@ -52,22 +57,25 @@ typedef enum {
 	Comment,
 } xml_token_type_t;
 
-#define XML_READER_BUFSZ	512
+#define XML_READER_BUFSZ	4096
 typedef struct xml_reader {
 	const char *		filename;
 
 	ni_buffer_t *		in_buffer;
 
 	FILE *			file;
-	unsigned char *		buffer;		/* FIXME: use in_buffer for this as well */
+	unsigned char *		buffer;		/* file contents read at once */
 
 	unsigned int		no_close : 1;
 
 	char *			doctype;
 
-	/* This pointer must be unsigned char, else 0xFF would
-	 * be expanded to EOF */
-	unsigned char *		pos;
+	/* The input is scanned in place, from the file contents
+	 * or the in_buffer data. These pointers must be unsigned
+	 * char, else 0xFF would be expanded to EOF */
+	const unsigned char *	data;
+	const unsigned char *	pos;
+	const unsigned char *	end;
 
 	xml_parser_state_t	state;
 	unsigned int		lineCount;
@@ -103,6 +111,7 @@ static int		xml_reader_open(xml_reader_t *xr, const char *filename);
 static int		xml_reader_destroy(xml_reader_t *xr);
 static int		xml_getc(xml_reader_t *xr);
 static void		xml_ungetc(xml_reader_t *xr, int cc);
+static void		xml_reader_put(xml_reader_t *, ni_stringbuf_t *, const unsigned char *);
 
 /*
  * Document reader implementation
@@ -181,7 +190,7 @@ xml_process_document(xml_reader_t *xr)
 	xml_document_t *doc;
 	xml_node_t *root;
 
-	doc = xml_document_new();
+	doc = xml_document_new_arena();
 
 	root = xml_document_root(doc);
 	if (xr->shared_location)
@@ -560,23 +569,23 @@ restart:
 
 	// Looks like CDATA. 
 	// Ignore initial newline, then scan to next <
-	do {
-		if (cc == '<') {
-			/* Looks like we're done.
-			 * FIXME: handle comments within CDATA?
-			 */
-			xml_ungetc(xr, cc);
+	// FIXME: handle comments within CDATA?
+	xml_ungetc(xr, cc);
+	while (xr->pos < xr->end) {
+		const unsigned char *lt, *amp;
+
+		if (!(lt = memchr(xr->pos, '<', xr->end - xr->pos)))
+			lt = xr->end;
+
+		amp = memchr(xr->pos, '&', lt - xr->pos);
+		xml_reader_put(xr, res, amp ? amp : lt);
+		if (!amp)
 			break;
-		} else
-		if (cc == '&') {
-			if (!xml_expand_entity(xr, res))
-				return None;
-		} else {
-			ni_stringbuf_putc(res, cc);
-		}
 
-		cc = xml_getc(xr);
-	} while (cc != EOF);
+		xr->pos++;
+		if (!xml_expand_entity(xr, res))
+			return None;
+	}
 
 	ni_stringbuf_trim_empty_lines(res);
 
@@ -587,6 +596,7 @@ restart:
 xml_token_type_t
 xml_get_token_tag(xml_reader_t *xr, ni_stringbuf_t *res)
 {
+	const unsigned char *end;
 	int cc, oc;
 
 	xml_skip_space(xr, NULL);
@@ -628,29 +638,25 @@ xml_get_token_tag(xml_reader_t *xr, ni_stringbuf_t *res)
 	case 'A' ... 'Z':
 	case '_':
 	case '!':
-		while ((cc = xml_getc(xr)) != EOF) {
-			if (!isalnum(cc) && cc != '_' && cc != '!' && cc != ':' && cc != '-') {
-				xml_ungetc(xr, cc);
+		for (end = xr->pos; end < xr->end; ++end) {
+			cc = *end;
+			if (!isalnum(cc) && cc != '_' && cc != '!' && cc != ':' && cc != '-')
 				break;
-			}
-			ni_stringbuf_putc(res, cc);
 		}
+		xml_reader_put(xr, res, end);
 		return Identifier;
 
 	case '\'':
 	case '"':
 		ni_stringbuf_clear(res);
 		oc = cc;
-		while (1) {
-			cc = xml_getc(xr);
-			if (cc == EOF) {
-				xml_parse_error(xr, "Unexpected EOF while parsing quoted string");
-				return None;
-			}
-			if (cc == oc)
-				break;
-			ni_stringbuf_putc(res, cc);
+		if (!(end = memchr(xr->pos, oc, xr->end - xr->pos))) {
+			xml_reader_put(xr, NULL, xr->end);
+			xml_parse_error(xr, "Unexpected EOF while parsing quoted string");
+			return None;
 		}
+		xml_reader_put(xr, res, end);
+		xr->pos++;
 		return QuotedString;
 
 	default:
@@ -668,27 +674,23 @@ error:
 xml_token_type_t
 xml_skip_comment(xml_reader_t *xr)
 {
-	int match = 0, cc;
+	const unsigned char *end;
 
 	if (xml_getc(xr) != '-') {
 		xml_parse_error(xr, "Unexpected <!-...> element");
 		return None;
 	}
 
-	while ((cc = xml_getc(xr)) != EOF) {
-		if (cc == '-') {
-			match++;
-		} else {
-			if (cc == '>' && match >= 2) {
+	end = memmem(xr->pos, xr->end - xr->pos, "-->", 3);
+	if (end) {
+		xml_reader_put(xr, NULL, end + 3);
 #ifdef XMLDEBUG_PARSER
-				xml_debug("Processed comment\n");
+		xml_debug("Processed comment\n");
 #endif
-				return Comment;
-			}
-			match = 0;
-		}
+		return Comment;
 	}
 
+	xml_reader_put(xr, NULL, xr->end);
 	xml_parse_error(xr, "Unexpected end of file while parsing comment");
 	return None;
 }
@@ -755,17 +757,11 @@ good:
 void
 xml_skip_space(xml_reader_t *xr, ni_stringbuf_t *result)
 {
-	int cc;
-
-	while ((cc = xml_getc(xr)) != EOF) {
-		if (!isspace(cc)) {
-			xml_ungetc(xr, cc);
-			break;
-		}
+	const unsigned char *end;
 
-		if (result)
-			ni_stringbuf_putc(result, cc);
-	}
+	for (end = xr->pos; end < xr->end && isspace(*end); ++end)
+		;
+	xml_reader_put(xr, result, end);
 }
 
 void
@@ -1009,6 +1005,29 @@ xml_location_free(xml_location_t *loc)
 /*
  * XML Reader object
  */
+static void
+xml_reader_read_file(xml_reader_t *xr)
+{
+	size_t size = XML_READER_BUFSZ, len = 0, count;
+	struct stat stb;
+
+	if (fstat(fileno(xr->file), &stb) == 0 && S_ISREG(stb.st_mode) && stb.st_size > 0)
+		size = stb.st_size + 1;
+
+	xr->buffer = xmalloc(size);
+	while ((count = fread(xr->buffer + len, 1, size - len, xr->file)) > 0) {
+		len += count;
+		if (len == size) {
+			size *= 2;
+			xr->buffer = xrealloc(xr->buffer, size);
+		}
+	}
+
+	xr->data = xr->buffer;
+	xr->pos = xr->data;
+	xr->end = xr->data + len;
+}
+
 static int
 xml_reader_open(xml_reader_t *xr, const char *filename)
 {
@@ -1021,7 +1040,7 @@ xml_reader_open(xml_reader_t *xr, const char *filename)
 		return -1;
 	}
 
-	xr->buffer = xmalloc(XML_READER_BUFSZ);
+	xml_reader_read_file(xr);
 	xr->state = Initial;
 	xr->lineCount = 1;
 	xr->shared_location = xml_location_shared_new(filename);
@@ -1039,7 +1058,7 @@ xml_reader_init_file(xml_reader_t *xr, FILE *fp, const char *location)
 	xr->file = fp;
 	xr->no_close = 1;
 
-	xr->buffer = xmalloc(XML_READER_BUFSZ);
+	xml_reader_read_file(xr);
 	xr->state = Initial;
 	xr->lineCount = 1;
 	xr->shared_location = xml_location_shared_new(location);
@@ -1058,6 +1077,10 @@ xml_reader_init_buffer(xml_reader_t *xr, ni_buffer_t *buf, const char *location)
 	xr->in_buffer = buf;
 	xr->no_close = 1;
 
+	xr->data = ni_buffer_head(buf);
+	xr->pos = xr->data;
+	xr->end = xr->data + ni_buffer_count(buf);
+
 	xr->state = Initial;
 	xr->lineCount = 1;
 	xr->shared_location = xml_location_shared_new(location);
@@ -1080,6 +1103,9 @@ xml_reader_destroy(xml_reader_t *xr)
 		free(xr->buffer);
 		xr->buffer = NULL;
 	}
+	if (xr->in_buffer && xr->pos > xr->data)
+		ni_buffer_pull_head(xr->in_buffer, xr->pos - xr->data);
+	xr->data = xr->pos = xr->end = NULL;
 
 	if (xr->shared_location) {
 		xml_location_shared_release(xr->shared_location);
@@ -1093,54 +1119,27 @@ xml_getc(xml_reader_t *xr)
 {
 	int cc;
 
-	if (xr->in_buffer) {
-		cc = ni_buffer_getc(xr->in_buffer);
-		if (cc == '\n')
-			xr->lineCount++;
-		return cc;
-	}
-
-	while (1) {
-		if (xr->pos) {
-			cc = *xr->pos++;
-			if (cc == '\n')
-				xr->lineCount++;
-			if (cc != '\0')
-				return cc;
-			xr->pos = NULL;
-		}
-
-		if (xr->file == NULL) {
-			/* Parsing just a string, no file backing */
-			break;
-		}
+	if (xr->pos >= xr->end)
+		return EOF;
 
-		if (fgets((char *)xr->buffer, XML_READER_BUFSZ, xr->file) == NULL)
-			break;
-
-		xr->pos = xr->buffer;
-	}
-
-	return EOF;
+	cc = *xr->pos++;
+	if (cc == '\n')
+		xr->lineCount++;
+	return cc;
 }
 
 void
 xml_ungetc(xml_reader_t *xr, int cc)
 {
-	if (xr->in_buffer) {
-		if (ni_buffer_ungetc(xr->in_buffer, cc) < 0)
-			ni_error("xml_ungetc: cannot put back");
-		if (cc == '\n')
-			xr->lineCount--;
+	if (cc == EOF)
 		return;
-	}
 
 	if (xr->pos == NULL
-	 || xr->pos == xr->buffer
+	 || xr->pos == xr->data
 	 || xr->pos[-1] != cc) {
 		ni_error("xml_ungetc: cannot put back");
-		ni_error("  buffer=%p pos=%p *pos=0x%x cc=0x%x",
-				xr->buffer, xr->pos,
+		ni_error("  data=%p pos=%p *pos=0x%x cc=0x%x",
+				xr->data, xr->pos,
 				xr->pos? xr->pos[-1] : 0,
 				cc);
 		return;
@@ -1151,3 +1150,300 @@ xml_ungetc(xml_reader_t *xr, int cc)
 	xr->pos--;
 }
 
+/*
+ * Consume the input up to @end, copying it to @res if given
+ */
+void
+xml_reader_put(xml_reader_t *xr, ni_stringbuf_t *res, const unsigned char *end)
+{
+	const unsigned char *nl = xr->pos;
+
+	while ((nl = memchr(nl, '\n', end - nl)) != NULL) {
+		xr->lineCount++;
+		nl++;
+	}
+
+	if (res && end > xr->pos)
+		ni_stringbuf_put(res, (const char *)xr->pos, end - xr->pos);
+	xr->pos = end;
+}
+
+/*
+ * Document cache
+ *
+ * A cache file holds a parsed document in a binary form, which can
+ * be decoded without tokenizing. It is valid only as long as the
+ * device, inode, size and mtime of the source file match the ones
+ * recorded in its header; else the source is parsed again and the
+ * cache file rewritten.
+ *
+ * Every node is stored as its cdata, line, attributes and children,
+ * where a child is preceded by its name. Strings are stored with a
+ * length including the NUL byte, 0 for NULL; all numbers are stored
+ * in host byte order, the file is not meant to be portable.
+ */
+#define XML_CACHE_MAGIC		"wickedxc"
+#define XML_CACHE_VERSION	1
+#define XML_CACHE_MAX_DEPTH	256
+
+typedef struct xml_cache_header {
+	char			magic[8];
+	uint32_t		version;
+	uint32_t		pathlen;	/* source path follows the header */
+	uint64_t		dev;
+	uint64_t		ino;
+	uint64_t		size;
+	int64_t			mtime_sec;
+	int64_t			mtime_nsec;
+} xml_cache_header_t;
+
+typedef struct xml_cache_reader {
+	const unsigned char *	pos;
+	const unsigned char *	end;
+
+	struct xml_location_shared *shared_location;
+} xml_cache_reader_t;
+
+static void
+xml_cache_header_init(xml_cache_header_t *hdr, const char *filename, const struct stat *stb)
+{
+	memset(hdr, 0, sizeof(*hdr));
+	memcpy(hdr->magic, XML_CACHE_MAGIC, sizeof(hdr->magic));
+	hdr->version = XML_CACHE_VERSION;
+	hdr->pathlen = strlen(filename) + 1;
+	hdr->dev = stb->st_dev;
+	hdr->ino = stb->st_ino;
+	hdr->size = stb->st_size;
+	hdr->mtime_sec = stb->st_mtim.tv_sec;
+	hdr->mtime_nsec = stb->st_mtim.tv_nsec;
+}
+
+static ni_bool_t
+xml_cache_get_uint(xml_cache_reader_t *cr, uint32_t *value)
+{
+	if ((size_t)(cr->end - cr->pos) < sizeof(*value))
+		return FALSE;
+
+	memcpy(value, cr->pos, sizeof(*value));
+	cr->pos += sizeof(*value);
+	return TRUE;
+}
+
+static ni_bool_t
+xml_cache_get_string(xml_cache_reader_t *cr, const char **string)
+{
+	uint32_t len;
+
+	if (!xml_cache_get_uint(cr, &len))
+		return FALSE;
+
+	if (len == 0) {
+		*string = NULL;
+		return TRUE;
+	}
+	if ((size_t)(cr->end - cr->pos) < len || cr->pos[len - 1] != '\0')
+		return FALSE;
+
+	*string = (const char *)cr->pos;
+	cr->pos += len;
+	return TRUE;
+}
+
+static ni_bool_t
+xml_cache_get_node(xml_cache_reader_t *cr, xml_node_t *node, unsigned int depth)
+{
+	const char *name, *value;
+	uint32_t line, count;
+
+	if (depth > XML_CACHE_MAX_DEPTH)
+		return FALSE;
+
+	if (!xml_cache_get_string(cr, &value) || !xml_cache_get_uint(cr, &line))
+		return FALSE;
+
+	if (value)
+		xml_node_set_cdata(node, value);
+	if (line)
+		node->location = xml_location_new(cr->shared_location, line);
+
+	if (!xml_cache_get_uint(cr, &count))
+		return FALSE;
+	while (count--) {
+		if (!xml_cache_get_string(cr, &name) || !name ||
+		    !xml_cache_get_string(cr, &value))
+			return FALSE;
+		xml_node_add_attr(node, name, value);
+	}
+
+	if (!xml_cache_get_uint(cr, &count))
+		return FALSE;
+	while (count--) {
+		xml_node_t *child;
+
+		if (!xml_cache_get_string(cr, &name) || !name)
+			return FALSE;
+
+		child = xml_node_new(name, node);
+		if (!xml_cache_get_node(cr, child, depth + 1))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static xml_document_t *
+xml_cache_read(const char *cachefile, const xml_cache_header_t *hdr, const char *filename)
+{
+	xml_cache_reader_t reader;
+	xml_document_t *doc = NULL;
+	unsigned char *data;
+	struct stat stb;
+	size_t size;
+	int fd;
+
+	if ((fd = open(cachefile, O_RDONLY | O_CLOEXEC)) < 0)
+		return NULL;
+
+	if (fstat(fd, &stb) < 0 || !S_ISREG(stb.st_mode) ||
+	    (size_t)stb.st_size < sizeof(*hdr) + hdr->pathlen) {
+		close(fd);
+		return NULL;
+	}
+
+	size = stb.st_size;
+	data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return NULL;
+
+	if (memcmp(data, hdr, sizeof(*hdr)) ||
+	    memcmp(data + sizeof(*hdr), filename, hdr->pathlen)) {
+		munmap(data, size);
+		return NULL;
+	}
+
+	memset(&reader, 0, sizeof(reader));
+	reader.pos = data + sizeof(*hdr) + hdr->pathlen;
+	reader.end = data + size;
+	reader.shared_location = xml_location_shared_new(filename);
+
+	doc = xml_document_new_arena();
+	if (!xml_cache_get_node(&reader, xml_document_root(doc), 0) ||
+	    reader.pos != reader.end) {
+		ni_debug_verbose(NI_LOG_DEBUG, NI_TRACE_XML,
+				"%s: ignoring corrupt xml cache file", cachefile);
+		xml_document_free(doc);
+		doc = NULL;
+	}
+
+	xml_location_shared_release(reader.shared_location);
+	munmap(data, size);
+	return doc;
+}
+
+static void
+xml_cache_put_uint(FILE *fp, uint32_t value)
+{
+	fwrite(&value, sizeof(value), 1, fp);
+}
+
+static void
+xml_cache_put_string(FILE *fp, const char *string)
+{
+	uint32_t len = string ? strlen(string) + 1 : 0;
+
+	xml_cache_put_uint(fp, len);
+	if (len)
+		fwrite(string, len, 1, fp);
+}
+
+static ni_bool_t
+xml_cache_put_node(FILE *fp, const xml_node_t *node, unsigned int depth)
+{
+	const xml_node_t *child;
+	unsigned int i;
+
+	/* the reader would reject it */
+	if (depth > XML_CACHE_MAX_DEPTH)
+		return FALSE;
+
+	xml_cache_put_string(fp, node->cdata);
+	xml_cache_put_uint(fp, node->location ? node->location->line : 0);
+
+	xml_cache_put_uint(fp, node->attrs.count);
+	for (i = 0; i < node->attrs.count; ++i) {
+		xml_cache_put_string(fp, node->attrs.data[i].name);
+		xml_cache_put_string(fp, node->attrs.data[i].value);
+	}
+
+	xml_cache_put_uint(fp, node->nchildren);
+	for (child = node->children; child; child = child->next) {
+		xml_cache_put_string(fp, child->name);
+		if (!xml_cache_put_node(fp, child, depth + 1))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static void
+xml_cache_write(const char *cachefile, const xml_cache_header_t *hdr, const char *filename,
+		const xml_document_t *doc)
+{
+	char *tempname = NULL;
+	FILE *fp;
+	int fd;
+
+	if (!ni_string_printf(&tempname, "%s.XXXXXX", cachefile))
+		return;
+
+	if ((fd = mkstemp(tempname)) < 0) {
+		ni_debug_verbose(NI_LOG_DEBUG, NI_TRACE_XML,
+				"unable to create xml cache file %s: %m", tempname);
+		ni_string_free(&tempname);
+		return;
+	}
+	if (fchmod(fd, 0644) < 0 || !(fp = fdopen(fd, "w"))) {
+		close(fd);
+		unlink(tempname);
+		ni_string_free(&tempname);
+		return;
+	}
+
+	fwrite(hdr, sizeof(*hdr), 1, fp);
+	fwrite(filename, hdr->pathlen, 1, fp);
+	if (!xml_cache_put_node(fp, doc->root, 0)) {
+		fclose(fp);
+		unlink(tempname);
+		ni_string_free(&tempname);
+		return;
+	}
+
+	if (ferror(fp) | fclose(fp) || rename(tempname, cachefile) < 0) {
+		ni_debug_verbose(NI_LOG_DEBUG, NI_TRACE_XML,
+				"unable to write xml cache file %s: %m", cachefile);
+		unlink(tempname);
+	}
+	ni_string_free(&tempname);
+}
+
+/*
+ * Read a document from @filename, using the @cachefile when it is
+ * up to date and (re)writing it when not. Cache errors are ignored.
+ */
+xml_document_t *
+xml_document_read_cached(const char *filename, const char *cachefile)
+{
+	xml_cache_header_t hdr;
+	xml_document_t *doc;
+	struct stat stb;
+
+	if (ni_string_empty(cachefile) || stat(filename, &stb) < 0 || !S_ISREG(stb.st_mode))
+		return xml_document_read(filename);
+
+	xml_cache_header_init(&hdr, filename, &stb);
+	if ((doc = xml_cache_read(cachefile, &hdr, filename)) != NULL)
+		return doc;
+
+	if ((doc = xml_document_read(filename)) != NULL)
+		xml_cache_write(cachefile, &hdr, filename, doc);
+	return doc;
+}
@@ -414,6 +414,7 @@ ni_xs_scope_free(ni_xs_scope_t *scope)
 	}
 
 	ni_string_free(&scope->name);
+	ni_string_free(&scope->cache_dir);
 	ni_xs_name_type_array_destroy(&scope->types);
 	if (scope->children) {
 		ni_xs_scope_t *child;
@@ -609,6 +610,37 @@ ni_xs_is_reserved_name(const char *name)
 	return __string_is_in_list(name, reserved);
 }
 
+/*
+ * Set the directory used to cache the parsed schema files
+ */
+void
+ni_xs_scope_set_cache_dir(ni_xs_scope_t *scope, const char *dirname)
+{
+	ni_string_dup(&scope->cache_dir, dirname);
+}
+
+static char *
+ni_xs_schema_cache_file(const ni_xs_scope_t *scope, const char *filename)
+{
+	char *cachefile = NULL, *p;
+
+	while (scope->parent)
+		scope = scope->parent;
+	if (ni_string_empty(scope->cache_dir))
+		return NULL;
+
+	while (*filename == '/')
+		filename++;
+	if (!ni_string_printf(&cachefile, "%s/%s.cache", scope->cache_dir, filename))
+		return NULL;
+
+	for (p = cachefile + strlen(scope->cache_dir) + 1; *p; ++p) {
+		if (*p == '/')
+			*p = '_';
+	}
+	return cachefile;
+}
+
 /*
  * Parse an XML schema file and process it
  */
@@ -616,6 +648,7 @@ int
 ni_xs_process_schema_file(const char *filename, ni_xs_scope_t *scope)
 {
 	xml_document_t *doc = NULL;
+	char *cachefile;
 
 	ni_debug_verbose(NI_LOG_DEBUG3, NI_TRACE_XML,
 		"ni_xs_process_schema_file(filename=%s)", filename);
@@ -625,7 +658,9 @@ ni_xs_process_schema_file(const char *filename, ni_xs_scope_t *scope)
 		return -1;
 	}
 
-	doc = xml_document_read(filename);
+	cachefile = ni_xs_schema_cache_file(scope, filename);
+	doc = xml_document_read_cached(filename, cachefile);
+	ni_string_free(&cachefile);
 	if (doc == NULL) {
 		ni_error("cannot parse schema file \"%s\"", filename);
 		return -1;
@@ -802,7 +837,7 @@ ni_xs_process_method(xml_node_t *node, ni_xs_service_t *service, ni_xs_scope_t *
 			if (method->meta == NULL)
 				method->meta = xml_node_new("meta", NULL);
 			xml_node_reparent(method->meta, child);
-			ni_string_dup(&child->name, child->name + 5);
+			xml_node_set_name(child, child->name + 5);
 		}
 	}
 
@@ -1300,7 +1335,7 @@ ni_xs_build_simple_type(xml_node_t *node, const char *typeName, ni_xs_scope_t *s
 			if (meta == NULL)
 				meta = xml_node_new("meta", NULL);
 			xml_node_reparent(meta, child);
-			ni_string_dup(&child->name, child->name + 5);
+			xml_node_set_name(child, child->name + 5);
 		}
 	}
 	if (meta) {
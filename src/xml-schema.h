@@ -342,10 +342,13 @@ struct ni_xs_scope {
 	struct {
 		const ni_xs_service_t *service;
 	} defined_by;
+
+	char *			cache_dir;	/* root scope only */
 };
 
 extern ni_xs_scope_t *	ni_xs_scope_new(ni_xs_scope_t *, const char *);
 extern void		ni_xs_scope_free(ni_xs_scope_t *);
+extern void		ni_xs_scope_set_cache_dir(ni_xs_scope_t *, const char *);
 extern const ni_xs_scope_t *ni_xs_scope_lookup_scope(const ni_xs_scope_t *, const char *);
 extern ni_xs_type_t *	ni_xs_scope_lookup(const ni_xs_scope_t *, const char *);
 extern ni_xs_type_t *	ni_xs_scope_lookup_local(const ni_xs_scope_t *, const char *);
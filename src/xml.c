@@ -27,9 +27,153 @@
 #include <wicked/logging.h>
 #include "util_priv.h"
 #include <inttypes.h>
+#include <stddef.h>
 
 #define XML_DOCUMENTARRAY_CHUNK		1
 #define XML_NODEARRAY_CHUNK		8
+#define XML_NAME_HASH_SIZE		1024
+#define XML_ARENA_CHUNK_NODES		64
+#define XML_NODE_INDEX_MIN		16
+
+/*
+ * Element names are interned: all nodes of the same name share
+ * one refcounted copy of it.
+ */
+typedef struct xml_name		xml_name_t;
+struct xml_name {
+	xml_name_t *		next;
+	unsigned int		refcount;
+	char *			string;
+};
+
+static xml_name_t *		xml_name_table[XML_NAME_HASH_SIZE];
+
+static unsigned int
+xml_string_hash(const char *string)
+{
+	unsigned int hash = 5381;
+
+	while (*string)
+		hash = ((hash << 5) + hash) ^ (unsigned char)*string++;
+
+	return hash;
+}
+
+static inline unsigned int
+xml_name_hash(const char *string)
+{
+	return xml_string_hash(string) % XML_NAME_HASH_SIZE;
+}
+
+static char *
+xml_name_get(const char *string)
+{
+	xml_name_t **pos, *name;
+
+	if (!string)
+		return NULL;
+
+	pos = &xml_name_table[xml_name_hash(string)];
+	for ( ; (name = *pos) != NULL; pos = &name->next) {
+		if (!strcmp(name->string, string)) {
+			name->refcount++;
+			return name->string;
+		}
+	}
+
+	name = xcalloc(1, sizeof(*name));
+	name->string = xstrdup(string);
+	name->refcount = 1;
+	*pos = name;
+	return name->string;
+}
+
+static void
+xml_name_put(const char *string)
+{
+	xml_name_t **pos, *name;
+
+	if (!string)
+		return;
+
+	pos = &xml_name_table[xml_name_hash(string)];
+	for ( ; (name = *pos) != NULL; pos = &name->next) {
+		if (name->string != string)
+			continue;
+
+		if (--name->refcount == 0) {
+			*pos = name->next;
+			free(name->string);
+			free(name);
+		}
+		return;
+	}
+
+	ni_error("%s: releasing unknown xml name \"%s\"", __func__, string);
+}
+
+/*
+ * Arena documents allocate their nodes from chunks owned by the
+ * arena. The nodes added to one of its nodes are allocated from the
+ * same arena; released nodes are recycled, and the chunks are freed
+ * at once with the last node.
+ */
+typedef struct xml_arena_chunk	xml_arena_chunk_t;
+struct xml_arena_chunk {
+	xml_arena_chunk_t *	next;
+	xml_node_t		nodes[XML_ARENA_CHUNK_NODES];
+};
+
+typedef struct xml_arena	xml_arena_t;
+struct xml_arena {
+	xml_arena_chunk_t *	chunks;
+	unsigned int		used;
+	unsigned int		users;
+	xml_node_t *		free;
+};
+
+static xml_node_t *
+xml_arena_alloc(xml_arena_t *arena)
+{
+	xml_arena_chunk_t *chunk;
+	xml_node_t *node;
+
+	if ((node = arena->free) != NULL) {
+		arena->free = node->next;
+		memset(node, 0, sizeof(*node));
+	} else {
+		if (!arena->chunks || arena->used == XML_ARENA_CHUNK_NODES) {
+			chunk = xcalloc(1, sizeof(*chunk));
+			chunk->next = arena->chunks;
+			arena->chunks = chunk;
+			arena->used = 0;
+		}
+		node = &arena->chunks->nodes[arena->used++];
+	}
+
+	node->arena = arena;
+	arena->users++;
+	return node;
+}
+
+static void
+xml_arena_release(xml_arena_t *arena, xml_node_t *node)
+{
+	xml_arena_chunk_t *chunk;
+
+	node->next = arena->free;
+	arena->free = node;
+
+	ni_assert(arena->users);
+	if (--arena->users)
+		return;
+
+	while ((chunk = arena->chunks) != NULL) {
+		arena->chunks = chunk->next;
+		free(chunk);
+	}
+	free(arena);
+}
 
 xml_document_t *
 xml_document_new()
@@ -41,6 +185,17 @@ xml_document_new()
 	return doc;
 }
 
+xml_document_t *
+xml_document_new_arena(void)
+{
+	xml_document_t *doc;
+
+	doc = xcalloc(1, sizeof(*doc));
+	doc->root = xml_arena_alloc(xcalloc(1, sizeof(xml_arena_t)));
+	doc->root->refcount = 1;
+	return doc;
+}
+
 xml_node_t *
 xml_document_root(xml_document_t *doc)
 {
@@ -84,6 +239,86 @@ xml_document_free(xml_document_t *doc)
 	}
 }
 
+/*
+ * Nodes with many children get an index mapping names to the first
+ * child of each name, built on the first lookup. Appending a child
+ * updates it; any other change of the children drops it.
+ */
+typedef struct xml_node_index_entry {
+	const char *		name;
+	xml_node_t *		child;
+} xml_node_index_entry_t;
+
+typedef struct xml_node_index {
+	unsigned int		size;
+	unsigned int		count;
+	xml_node_index_entry_t *entries;
+} xml_node_index_t;
+
+static void
+xml_node_index_drop(xml_node_t *node)
+{
+	if (node->index) {
+		free(node->index->entries);
+		free(node->index);
+		node->index = NULL;
+	}
+}
+
+static xml_node_index_entry_t *
+xml_node_index_entry(const xml_node_index_t *index, const char *name)
+{
+	xml_node_index_entry_t *entry;
+	unsigned int i;
+
+	i = xml_string_hash(name) & (index->size - 1);
+	for (entry = &index->entries[i]; entry->name; entry = &index->entries[i]) {
+		if (!strcmp(entry->name, name))
+			break;
+		i = (i + 1) & (index->size - 1);
+	}
+	return entry;
+}
+
+static ni_bool_t
+xml_node_index_add(xml_node_index_t *index, xml_node_t *child)
+{
+	xml_node_index_entry_t *entry;
+
+	if (!child->name)
+		return TRUE;
+
+	entry = xml_node_index_entry(index, child->name);
+	if (entry->name)
+		return TRUE;
+
+	if (2 * (index->count + 1) > index->size)
+		return FALSE;
+
+	entry->name = child->name;
+	entry->child = child;
+	index->count++;
+	return TRUE;
+}
+
+static xml_node_index_t *
+xml_node_index_build(xml_node_t *node)
+{
+	xml_node_index_t *index;
+	xml_node_t *child;
+
+	index = xcalloc(1, sizeof(*index));
+	for (index->size = 4 * XML_NODE_INDEX_MIN; index->size < 4 * node->nchildren; )
+		index->size <<= 1;
+	index->entries = xcalloc(index->size, sizeof(index->entries[0]));
+
+	for (child = node->children; child; child = child->next)
+		xml_node_index_add(index, child);
+
+	node->index = index;
+	return index;
+}
+
 /*
  * Helper functions for xml node list management
  */
@@ -93,14 +328,34 @@ __xml_node_list_insert(xml_node_t **pos, xml_node_t *node, xml_node_t *parent)
 	node->parent = parent;
 	node->next = *pos;
 	*pos = node;
+	parent->nchildren++;
+
+	if (node->next == NULL) {
+		parent->last = node;
+		if (parent->index && !xml_node_index_add(parent->index, node))
+			xml_node_index_drop(parent);
+	} else {
+		xml_node_index_drop(parent);
+	}
 }
 
 static inline xml_node_t *
 __xml_node_list_remove(xml_node_t **pos)
 {
 	xml_node_t *np = *pos;
+	xml_node_t *parent;
 
 	if (np) {
+		if ((parent = np->parent) != NULL) {
+			if (parent->last == np) {
+				if (pos == &parent->children)
+					parent->last = NULL;
+				else
+					parent->last = (xml_node_t *)((char *)pos - offsetof(xml_node_t, next));
+			}
+			parent->nchildren--;
+			xml_node_index_drop(parent);
+		}
 		np->parent = NULL;
 		*pos = np->next;
 		np->next = NULL;
@@ -131,11 +386,14 @@ __xml_node_list_tail(xml_node_t **pos)
 void
 xml_node_add_child(xml_node_t *parent, xml_node_t *child)
 {
-	xml_node_t **tail;
+	xml_node_t **tail, *last = parent->last;
 
 	ni_assert(child->parent == NULL);
 
-	tail = __xml_node_list_tail(&parent->children);
+	if (last && last->parent == parent && last->next == NULL)
+		tail = &last->next;
+	else
+		tail = __xml_node_list_tail(&parent->children);
 	__xml_node_list_insert(tail, child, parent);
 }
 
@@ -144,9 +402,11 @@ xml_node_new(const char *ident, xml_node_t *parent)
 {
 	xml_node_t *node;
 
-	node = xcalloc(1, sizeof(xml_node_t));
-	if (ident)
-		node->name = xstrdup(ident);
+	if (parent && parent->arena)
+		node = xml_arena_alloc(parent->arena);
+	else
+		node = xcalloc(1, sizeof(xml_node_t));
+	node->name = xml_name_get(ident);
 
 	if (parent)
 		xml_node_add_child(parent, node);
@@ -293,6 +553,7 @@ xml_node_free(xml_node_t *node)
 	if (--(node->refcount) != 0)
 		return;
 
+	xml_node_index_drop(node);
 	while ((child = node->children) != NULL) {
 		node->children = child->next;
 		child->parent = NULL;
@@ -304,8 +565,22 @@ xml_node_free(xml_node_t *node)
 
 	ni_var_array_destroy(&node->attrs);
 	free(node->cdata);
-	free(node->name);
-	free(node);
+	xml_name_put(node->name);
+	if (node->arena)
+		xml_arena_release(node->arena, node);
+	else
+		free(node);
+}
+
+void
+xml_node_set_name(xml_node_t *node, const char *name)
+{
+	const char *old = node->name;
+
+	if (node->parent)
+		xml_node_index_drop(node->parent);
+	node->name = xml_name_get(name);
+	xml_name_put(old);
 }
 
 void
@@ -459,10 +734,18 @@ xml_node_get_attr_double(const xml_node_t *node, const char *name, double *valp)
 xml_node_t *
 xml_node_get_next_child(const xml_node_t *top, const char *name, const xml_node_t *cur)
 {
+	xml_node_index_t *index;
 	xml_node_t *child;
 
 	if (top == NULL)
 		return NULL;
+
+	if (cur == NULL && name && top->nchildren >= XML_NODE_INDEX_MIN) {
+		if ((index = top->index) == NULL)
+			index = xml_node_index_build((xml_node_t *)top);
+		return xml_node_index_entry(index, name)->child;
+	}
+
 	for (child = cur ? cur->next : top->children; child; child = child->next) {
 		if (!strcmp(child->name, name))
 			return child;
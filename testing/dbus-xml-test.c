@@ -0,0 +1,254 @@
+/**
+ *	Copyright (C) 2026 SUSE LLC
+ *
+ *	This program is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation; either version 2 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *	Description:
+ *		Test for the direct xml to dbus message marshalling,
+ *		comparing the messages built from bond, team (union),
+ *		and addrconf requests with a large route list to the
+ *		ones built via a variant dict:
+ *		* ni_dbus_xml_append_arg()
+ *		* ni_dbus_xml_serialize_arg()
+ *
+ *	Usage: dbus-xml-test [schema file]
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <wicked/util.h>
+#include <wicked/netinfo.h>
+#include <wicked/logging.h>
+#include <wicked/xml.h>
+#include <wicked/dbus.h>
+#include <wicked/objectmodel.h>
+#include "xml-schema.h"
+
+#define DEFAULT_SCHEMA	"../schema/wicked.xml"
+
+static DBusMessage *
+message_new(void)
+{
+	return dbus_message_new_method_call("org.opensuse.Network", "/org/opensuse/Network",
+			"org.opensuse.Network.Test", "test");
+}
+
+static DBusMessage *
+build_via_variant(const ni_dbus_method_t *method, unsigned int argn, xml_node_t *node)
+{
+	ni_dbus_variant_t dict = NI_DBUS_VARIANT_INIT;
+	DBusError error = DBUS_ERROR_INIT;
+	DBusMessage *msg = message_new();
+
+	ni_dbus_variant_init_dict(&dict);
+	if (!ni_dbus_xml_serialize_arg(method, argn, &dict, node) ||
+	    !ni_dbus_message_serialize_variants(msg, 1, &dict, &error)) {
+		dbus_error_free(&error);
+		dbus_message_unref(msg);
+		msg = NULL;
+	}
+	ni_dbus_variant_destroy(&dict);
+	return msg;
+}
+
+static DBusMessage *
+build_direct(const ni_dbus_method_t *method, unsigned int argn, xml_node_t *node)
+{
+	DBusMessage *msg = message_new();
+
+	if (!ni_dbus_xml_append_arg(method, argn, msg, node)) {
+		dbus_message_unref(msg);
+		msg = NULL;
+	}
+	return msg;
+}
+
+static double
+elapsed(const struct timespec *begin)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - begin->tv_sec) * 1000.0 +
+		(now.tv_nsec - begin->tv_nsec) / 1000000.0;
+}
+
+/*
+ * Build the @argn argument of @service.@method from @xml both ways;
+ * the marshalled messages have to be identical, or both have to fail
+ * when @valid is false. With @rounds, report the time per message.
+ */
+static void
+compare(const char *service, const char *method, unsigned int argn,
+		const char *xml, ni_bool_t valid, unsigned int rounds)
+{
+	const ni_dbus_service_t *svc;
+	const ni_dbus_method_t *mth;
+	xml_document_t *doc;
+	xml_node_t *node;
+	DBusMessage *a, *b;
+	char *abuf, *bbuf;
+	int alen, blen;
+	struct timespec begin;
+	double t;
+	unsigned int i;
+
+	ni_assert((svc = ni_objectmodel_service_by_name(service)) != NULL);
+	ni_assert((mth = ni_dbus_service_get_method(svc, method)) != NULL);
+	ni_assert((doc = xml_document_from_string(xml, service)) != NULL);
+	ni_assert((node = xml_document_root(doc)->children) != NULL);
+
+	a = build_via_variant(mth, argn, node);
+	b = build_direct(mth, argn, node);
+	if (!valid) {
+		ni_assert(a == NULL && b == NULL);
+		xml_document_free(doc);
+		return;
+	}
+	ni_assert(a != NULL && b != NULL);
+
+	dbus_message_set_serial(a, 1);
+	dbus_message_set_serial(b, 1);
+	ni_assert(dbus_message_marshal(a, &abuf, &alen));
+	ni_assert(dbus_message_marshal(b, &bbuf, &blen));
+	ni_assert(alen == blen && !memcmp(abuf, bbuf, alen));
+	dbus_free(abuf);
+	dbus_free(bbuf);
+	dbus_message_unref(a);
+	dbus_message_unref(b);
+
+	if (rounds) {
+		clock_gettime(CLOCK_MONOTONIC, &begin);
+		for (i = 0; i < rounds; ++i)
+			dbus_message_unref(build_via_variant(mth, argn, node));
+		t = elapsed(&begin);
+		printf("%s.%s: %d bytes, variant: %.3f ms", service, method, alen, t / rounds);
+
+		clock_gettime(CLOCK_MONOTONIC, &begin);
+		for (i = 0; i < rounds; ++i)
+			dbus_message_unref(build_direct(mth, argn, node));
+		t = elapsed(&begin);
+		printf(", direct: %.3f ms\n", t / rounds);
+	}
+	xml_document_free(doc);
+}
+
+static void
+test_bond(void)
+{
+	compare("org.opensuse.Network.Bond", "changeDevice", 0,
+		"<bond>"
+		  "<mode>active-backup</mode>"
+		  "<fail-over-mac>active</fail-over-mac>"
+		  "<miimon><frequency>100</frequency><carrier-detect>netif</carrier-detect></miimon>"
+		  "<slaves>"
+		    "<slave><device>eth0</device><primary>true</primary></slave>"
+		    "<slave><device>eth1</device><queue-id>3</queue-id></slave>"
+		  "</slaves>"
+		  "<address>02:00:00:00:00:01</address>"
+		"</bond>", TRUE, 0);
+}
+
+static void
+test_team(void)
+{
+	compare("org.opensuse.Network.Team", "changeDevice", 0,
+		"<team>"
+		  "<runner name=\"lacp\">"
+		    "<active>true</active><sys_prio>5</sys_prio>"
+		    "<tx_hash>eth,ipv4</tx_hash>"
+		    "<tx_balancer><name>basic</name></tx_balancer>"
+		  "</runner>"
+		  "<link_watch>"
+		    "<watch name=\"ethtool\"><delay_up>3</delay_up></watch>"
+		    "<watch name=\"arp_ping\"><target_host>192.0.2.1</target_host><interval>9</interval></watch>"
+		  "</link_watch>"
+		  "<ports><port><device>eth2</device><prio>4</prio></port></ports>"
+		"</team>", TRUE, 0);
+
+	/* union member without data, union in the second argument */
+	compare("org.opensuse.Network.Team", "changeDevice", 0,
+		"<team><runner name=\"roundrobin\"/></team>", TRUE, 0);
+	compare("org.opensuse.Network.Team.Factory", "newDevice", 1,
+		"<team><runner name=\"broadcast\"/></team>", TRUE, 0);
+
+	/* unknown union discriminant, invalid scalar */
+	compare("org.opensuse.Network.Team", "changeDevice", 0,
+		"<team><runner name=\"unknown\"/></team>", FALSE, 0);
+	compare("org.opensuse.Network.Team", "changeDevice", 0,
+		"<team><link_watch><watch name=\"ethtool\"><delay_up>x</delay_up></watch></link_watch></team>",
+		FALSE, 0);
+}
+
+static void
+test_addrconf(unsigned int count)
+{
+	ni_stringbuf_t buf = NI_STRINGBUF_INIT_DYNAMIC;
+	unsigned int i;
+
+	ni_stringbuf_puts(&buf, "<ipv4:static>"
+			"<hostname>host</hostname>"
+			"<resolver><servers><server>192.0.2.53</server></servers></resolver>");
+	for (i = 0; i < count; ++i) {
+		ni_stringbuf_printf(&buf,
+			"<address>"
+			  "<local>10.%u.%u.1/24</local>"
+			  "<cache-info><valid-lifetime>%u</valid-lifetime></cache-info>"
+			"</address>"
+			"<route>"
+			  "<destination>172.%u.%u.0/24</destination>"
+			  "<priority>%u</priority>"
+			  "<nexthop><gateway>10.0.0.%u</gateway><device>eth0</device></nexthop>"
+			  "<kern><table>main</table><protocol>static</protocol></kern>"
+			  "<metrics><mtu>1500</mtu></metrics>"
+			"</route>",
+			i / 250, i % 250, i, 16 + i / 250, i % 250, i, i % 250 + 1);
+	}
+	ni_stringbuf_puts(&buf, "</ipv4:static>");
+
+	compare("org.opensuse.Network.Addrconf.ipv4.static", "requestLease", 0,
+			buf.string, TRUE, 10);
+	ni_stringbuf_destroy(&buf);
+}
+
+int
+main(int argc, char **argv)
+{
+	const char *schema = argc > 1 ? argv[1] : DEFAULT_SCHEMA;
+	ni_xs_scope_t *scope;
+
+	ni_init("dbus-xml-test");
+	ni_log_level_set("error");
+
+	scope = ni_dbus_xml_init();
+	ni_objectmodel_register_all();
+	if (ni_xs_process_schema_file(schema, scope) < 0 ||
+	    ni_dbus_xml_register_services(scope) < 0) {
+		fprintf(stderr, "%s: unable to load schema\n", schema);
+		return 1;
+	}
+
+	test_bond();
+	test_team();
+	test_addrconf(2000);
+
+	printf("ALL TEST SUCCESSFUL!\n");
+	return 0;
+}
@@ -0,0 +1,213 @@
+/**
+ *	Copyright (C) 2026 SUSE LLC
+ *
+ *	This program is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation; either version 2 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *	Description:
+ *		Test for the ovsdb monitor client, using a stand-in
+ *		ovsdb-server on a unix socket, which answers the monitor
+ *		request with a bridge, a vlan (fake) bridge and ports,
+ *		and later sends an echo and an update removing them:
+ *		* ni_ovsdb_monitor_open()
+ *		* ni_ovsdb_monitor_active()
+ *		* ni_ovs_bridge_exists()
+ *
+ *	Usage: ovsdb-test [socket path]
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include <wicked/util.h>
+#include <wicked/netinfo.h>
+#include <wicked/logging.h>
+#include <wicked/socket.h>
+#include "json.h"
+#include "process.h"
+#include "ovsdb.h"
+#include "ovs.h"
+
+static const char *	monitor_reply =
+	"{\"id\":%lld,\"error\":null,\"result\":{"
+	  "\"Bridge\":{"
+	    "\"b1\":{\"new\":{\"name\":\"br0\",\"ports\":[\"set\",["
+	      "[\"uuid\",\"p0\"],[\"uuid\",\"p1\"],[\"uuid\",\"p2\"]]]}}},"
+	  "\"Port\":{"
+	    "\"p0\":{\"new\":{\"name\":\"br0\",\"tag\":[\"set\",[]],\"fake_bridge\":false}},"
+	    "\"p1\":{\"new\":{\"name\":\"eth1\",\"tag\":[\"set\",[]],\"fake_bridge\":false}},"
+	    "\"p2\":{\"new\":{\"name\":\"br0v10\",\"tag\":10,\"fake_bridge\":true}}}}}";
+
+static const char *	echo_request =
+	"{\"id\":\"echo\",\"method\":\"echo\",\"params\":[]}";
+
+static const char *	update_notify =
+	"{\"id\":null,\"method\":\"update\",\"params\":[null,{"
+	  "\"Bridge\":{\"b1\":{\"old\":{}}},"
+	  "\"Port\":{\"p0\":{\"old\":{}},\"p1\":{\"old\":{}},\"p2\":{\"old\":{}}}}]}";
+
+/*
+ * Read from @fd until the data received so far parses as json
+ */
+static ni_json_t *
+server_recv(int fd, char *buf, size_t size)
+{
+	size_t len = 0;
+	ssize_t n;
+	ni_json_t *json;
+
+	while (len + 1 < size) {
+		if ((n = read(fd, buf + len, size - len - 1)) <= 0)
+			return NULL;
+		len += n;
+		buf[len] = '\0';
+		if ((json = ni_json_parse_string(buf)))
+			return json;
+	}
+	return NULL;
+}
+
+static int
+server_run(int lfd, int ctl)
+{
+	char buf[4096], reply[4096];
+	ni_json_t *req;
+	int64_t id;
+	int fd, len;
+	char cc;
+
+	if ((fd = accept(lfd, NULL, NULL)) < 0)
+		return 1;
+
+	/* answer the monitor request in two parts to exercise the framing */
+	if (!(req = server_recv(fd, buf, sizeof(buf))) ||
+	    !ni_json_int64_get(ni_json_object_get_value(req, "id"), &id))
+		return 2;
+	ni_json_free(req);
+
+	len = snprintf(reply, sizeof(reply), monitor_reply, (long long)id);
+	if (write(fd, reply, 17) != 17)
+		return 3;
+	usleep(50000);
+	if (write(fd, reply + 17, len - 17) != len - 17)
+		return 3;
+
+	/* wait for the go, then send both messages at once */
+	if (read(ctl, &cc, 1) != 1)
+		return 4;
+	len = snprintf(reply, sizeof(reply), "%s%s", echo_request, update_notify);
+	if (write(fd, reply, len) != len)
+		return 5;
+
+	if (!(req = server_recv(fd, buf, sizeof(buf))) ||
+	    !ni_json_object_get_value(req, "result"))
+		return 6;
+	ni_json_free(req);
+
+	/* wait until the client is done */
+	if (read(ctl, &cc, 1) < 0)
+		return 7;
+	close(fd);
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	char tmpdir[] = "/tmp/ovsdb-test.XXXXXX";
+	char path[PATH_MAX];
+	struct sockaddr_un sun;
+	int lfd, ctl[2], status, i;
+	pid_t pid;
+
+	ni_init("ovsdb-test");
+	ni_log_level_set("error");
+
+	if (argc > 1) {
+		snprintf(path, sizeof(path), "%s", argv[1]);
+	} else if (mkdtemp(tmpdir)) {
+		snprintf(path, sizeof(path), "%s/db.sock", tmpdir);
+	} else {
+		perror("mkdtemp");
+		return 1;
+	}
+
+	memset(&sun, 0, sizeof(sun));
+	sun.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(sun.sun_path)) {
+		fprintf(stderr, "%s: socket path too long\n", path);
+		return 1;
+	}
+	strcpy(sun.sun_path, path);
+	unlink(path);
+
+	if ((lfd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+	    bind(lfd, (struct sockaddr *)&sun, sizeof(sun)) < 0 ||
+	    listen(lfd, 1) < 0 || pipe(ctl) < 0) {
+		perror(path);
+		return 1;
+	}
+
+	if ((pid = fork()) < 0) {
+		perror("fork");
+		return 1;
+	}
+	if (pid == 0) {
+		close(ctl[1]);
+		_exit(server_run(lfd, ctl[0]));
+	}
+	close(ctl[0]);
+	close(lfd);
+
+	/* the monitor reply is received asynchronously */
+	ni_assert(ni_ovsdb_monitor_open(path) == 0);
+	ni_assert(!ni_ovsdb_monitor_active());
+	for (i = 0; i < 50 && !ni_ovsdb_monitor_active(); ++i)
+		ni_socket_wait(100);
+	ni_assert(ni_ovsdb_monitor_active());
+
+	ni_assert(ni_ovs_bridge_exists("br0") == NI_PROCESS_SUCCESS);
+	ni_assert(ni_ovs_bridge_exists("br0v10") == NI_PROCESS_SUCCESS);
+	ni_assert(ni_ovs_bridge_exists("eth1") == NI_PROCESS_FAILURE);
+	ni_assert(ni_ovs_bridge_exists("br1") == NI_PROCESS_FAILURE);
+
+	/* let the server remove the bridge */
+	ni_assert(write(ctl[1], "g", 1) == 1);
+	for (i = 0; i < 50 && ni_ovs_bridge_exists("br0") == NI_PROCESS_SUCCESS; ++i)
+		ni_socket_wait(100);
+
+	ni_assert(ni_ovs_bridge_exists("br0") == NI_PROCESS_FAILURE);
+	ni_assert(ni_ovs_bridge_exists("br0v10") == NI_PROCESS_FAILURE);
+
+	close(ctl[1]);
+	ni_assert(waitpid(pid, &status, 0) == pid);
+	ni_assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	ni_ovsdb_monitor_close();
+	ni_assert(!ni_ovsdb_monitor_active());
+
+	unlink(path);
+	if (argc <= 1)
+		rmdir(tmpdir);
+
+	printf("ALL TEST SUCCESSFUL!\n");
+	return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * Benchmark of the fsm policy lookup, comparing the indexed lookup
+ * of the fsm policy list to the linear evaluation of all policies.
+ *
+ * Usage: policy-test [#workers [#policies [#rounds]]]
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <wicked/util.h>
+#include <wicked/netinfo.h>
+#include <wicked/logging.h>
+#include <wicked/xml.h>
+#include <wicked/fsm.h>
+#include "client/ifconfig.h"
+
+#define MAX_POLICIES	16
+
+/* just non-NULL, makes the workers look like factory devices */
+static ni_dbus_service_t	factory_service;
+static ni_dbus_method_t		factory_method;
+
+static double
+elapsed(const struct timespec *begin)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - begin->tv_sec) * 1000.0 +
+		(now.tv_nsec - begin->tv_nsec) / 1000000.0;
+}
+
+static ni_bool_t
+add_policy(ni_fsm_t *fsm, const char *ifname)
+{
+	xml_node_t *node, *match;
+	ni_fsm_policy_t *policy;
+	char *name;
+
+	if (!(name = ni_ifpolicy_name_from_ifname(ifname)))
+		return FALSE;
+
+	node = xml_node_new(NI_NANNY_IFPOLICY, NULL);
+	xml_node_add_attr(node, NI_NANNY_IFPOLICY_NAME, name);
+	match = xml_node_new(NI_NANNY_IFPOLICY_MATCH, node);
+	xml_node_new_element("device", match, ifname);
+
+	policy = ni_fsm_policy_new(fsm, name, node);
+	xml_node_free(node);
+	ni_string_free(&name);
+	return policy != NULL;
+}
+
+int
+main(int argc, char **argv)
+{
+	unsigned int nworkers = 1000, npolicies = 2000, rounds = 10;
+	unsigned int i, r, indexed = 0, linear = 0;
+	const ni_fsm_policy_t *result[MAX_POLICIES];
+	struct timespec begin;
+	char ifname[32];
+	ni_fsm_t *fsm;
+	double t;
+
+	if (argc > 1)
+		nworkers = strtoul(argv[1], NULL, 0);
+	if (argc > 2)
+		npolicies = strtoul(argv[2], NULL, 0);
+	if (argc > 3)
+		rounds = strtoul(argv[3], NULL, 0);
+
+	if (ni_init("policy-test") < 0)
+		return 1;
+	ni_log_level_set("error");
+
+	fsm = ni_fsm_new();
+	for (i = 0; i < nworkers; ++i) {
+		ni_ifworker_t *w;
+
+		snprintf(ifname, sizeof(ifname), "eth%u", i);
+		if (!(w = ni_fsm_ifworker_new(fsm, NI_IFWORKER_TYPE_NETDEV, ifname)))
+			return 1;
+		w->device_api.factory_service = &factory_service;
+		w->device_api.factory_method = &factory_method;
+	}
+	for (i = 0; i < npolicies; ++i) {
+		snprintf(ifname, sizeof(ifname), "eth%u", i);
+		if (!add_policy(fsm, ifname)) {
+			fprintf(stderr, "Unable to create policy for %s\n", ifname);
+			return 1;
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	for (r = 0; r < rounds; ++r) {
+		for (i = 0; i < fsm->workers.count; ++i) {
+			ni_ifworker_t *w = fsm->workers.data[i];
+
+			if (ni_fsm_exists_applicable_policy(fsm, fsm->policies, w))
+				indexed++;
+		}
+	}
+	t = elapsed(&begin);
+	printf("indexed: %u workers, %u policies, %u rounds: %u matches in %.3f ms\n",
+			nworkers, npolicies, rounds, indexed, t);
+
+	/* without a fsm, the policy list is evaluated linearly */
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	for (r = 0; r < rounds; ++r) {
+		for (i = 0; i < fsm->workers.count; ++i) {
+			ni_ifworker_t *w = fsm->workers.data[i];
+
+			if (ni_fsm_exists_applicable_policy(NULL, fsm->policies, w))
+				linear++;
+		}
+	}
+	t = elapsed(&begin);
+	printf("linear:  %u workers, %u policies, %u rounds: %u matches in %.3f ms\n",
+			nworkers, npolicies, rounds, linear, t);
+
+	for (i = 0; i < fsm->workers.count; ++i) {
+		ni_ifworker_t *w = fsm->workers.data[i];
+		unsigned int count;
+
+		count = ni_fsm_policy_get_applicable_policies(fsm, w, result, MAX_POLICIES);
+		if (count != (i < npolicies ? 1 : 0)) {
+			fprintf(stderr, "%s: unexpected number of applicable policies: %u\n",
+					w->name, count);
+			return 1;
+		}
+	}
+
+	ni_fsm_free(fsm);
+	return indexed == linear ? 0 : 1;
+}
@@ -0,0 +1,290 @@
+/**
+ *	Copyright (C) 2026 SUSE LLC
+ *
+ *	This program is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation; either version 2 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *	Description:
+ *		Test for the route table prefix index, comparing the
+ *		indexed lookups to a linear scan of the table routes
+ *		after adding, replacing and removing routes:
+ *		* ni_route_tables_find_match()
+ *		* ni_route_tables_lookup()
+ *		* ni_address_can_reach()
+ *
+ *	Usage: route-test [#routes]
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <linux/rtnetlink.h>
+
+#include <wicked/util.h>
+#include <wicked/netinfo.h>
+#include <wicked/logging.h>
+#include <wicked/address.h>
+#include <wicked/route.h>
+
+static void
+random_addr(ni_sockaddr_t *addr, unsigned int n)
+{
+	memset(addr, 0, sizeof(*addr));
+	if (n % 4) {
+		addr->sin.sin_family = AF_INET;
+		addr->sin.sin_addr.s_addr = htonl((uint32_t)random());
+	} else {
+		addr->six.sin6_family = AF_INET6;
+		addr->six.sin6_addr.s6_addr[0] = 0x20;
+		addr->six.sin6_addr.s6_addr[1] = 0x01;
+		addr->six.sin6_addr.s6_addr[4] = random() & 0xff;
+		addr->six.sin6_addr.s6_addr[5] = random() & 0xff;
+		addr->six.sin6_addr.s6_addr[6] = random() & 0xff;
+		addr->six.sin6_addr.s6_addr[7] = random() & 0xff;
+		addr->six.sin6_addr.s6_addr[15] = random() & 0xff;
+	}
+}
+
+static ni_route_t *
+create_route(ni_route_table_t **tables, unsigned int n)
+{
+	ni_sockaddr_t dst, gw;
+	unsigned int plen, i;
+	ni_route_t *rp;
+
+	random_addr(&dst, n);
+	memset(&gw, 0, sizeof(gw));
+	if (dst.ss_family == AF_INET) {
+		plen = 8 + n % 25;
+		gw.sin.sin_family = AF_INET;
+		gw.sin.sin_addr.s_addr = htonl(0x0a000001);
+	} else {
+		plen = 48 + n % 17;
+		gw.six.sin6_family = AF_INET6;
+		gw.six.sin6_addr.s6_addr[0] = 0xfe;
+		gw.six.sin6_addr.s6_addr[1] = 0x80;
+		gw.six.sin6_addr.s6_addr[15] = 1;
+	}
+
+	/* clear the host bits */
+	for (i = plen; i < ni_af_address_length(dst.ss_family) * 8; ++i) {
+		if (dst.ss_family == AF_INET)
+			dst.sin.sin_addr.s_addr &= ~htonl(1U << (31 - i));
+		else
+			dst.six.sin6_addr.s6_addr[i / 8] &= ~(0x80 >> (i % 8));
+	}
+
+	if ((rp = ni_route_create(plen, &dst, &gw, RT_TABLE_MAIN, tables)))
+		rp->priority = random() % 4;
+	return rp;
+}
+
+/*
+ * The indexed find has to agree with the linear one for each route
+ */
+static void
+verify_find_match(ni_route_table_t *tables, ni_route_table_t *tab)
+{
+	ni_route_t *rp, *probe;
+	unsigned int i;
+
+	for (i = 0; i < tab->routes.count; ++i) {
+		if (!(rp = tab->routes.data[i]))
+			continue;
+
+		probe = ni_route_clone(rp);
+		ni_assert(ni_route_tables_find_match(tables, probe, ni_route_equal) ==
+			ni_route_array_find_match(&tab->routes, probe, ni_route_equal));
+		ni_assert(ni_route_tables_find_match(tables, probe, ni_route_equal_destination) ==
+			ni_route_array_find_match(&tab->routes, probe, ni_route_equal_destination));
+		ni_route_free(probe);
+	}
+}
+
+/*
+ * Longest prefix match by a linear scan of the table routes
+ */
+static ni_route_t *
+linear_lookup(ni_route_table_t *tab, const ni_sockaddr_t *addr)
+{
+	ni_route_t *rp, *best = NULL;
+	unsigned int i;
+
+	for (i = 0; i < tab->routes.count; ++i) {
+		if (!(rp = tab->routes.data[i]) || rp->family != addr->ss_family)
+			continue;
+		if (!ni_sockaddr_prefix_match(rp->prefixlen, &rp->destination, addr))
+			continue;
+		if (!best || rp->prefixlen > best->prefixlen ||
+		    (rp->prefixlen == best->prefixlen && rp->priority < best->priority))
+			best = rp;
+	}
+	return best;
+}
+
+static void
+verify_lookup(ni_route_table_t *tables, ni_route_table_t *tab, const ni_sockaddr_t *addr)
+{
+	ni_route_t *found, *best;
+
+	found = ni_route_tables_lookup(tables, RT_TABLE_MAIN, addr);
+	best = linear_lookup(tab, addr);
+
+	/* same prefix and metric, but maybe another route among equals */
+	ni_assert(!found == !best);
+	ni_assert(!found || found->prefixlen == best->prefixlen);
+	ni_assert(!found || found->priority == best->priority);
+	ni_assert(!found || ni_sockaddr_prefix_match(found->prefixlen, &found->destination, addr));
+}
+
+static void
+verify_lookups(ni_route_table_t *tables, ni_route_table_t *tab, unsigned int count)
+{
+	ni_sockaddr_t addr;
+	ni_route_t *rp;
+	unsigned int i;
+
+	for (i = 0; i < tab->routes.count; ++i) {
+		if (!(rp = tab->routes.data[i]))
+			continue;
+
+		/* a host in the route destination prefix */
+		addr = rp->destination;
+		if (addr.ss_family == AF_INET && rp->prefixlen < 32)
+			addr.sin.sin_addr.s_addr |= htonl((uint32_t)random() >> rp->prefixlen);
+		else
+		if (addr.ss_family == AF_INET6)
+			addr.six.sin6_addr.s6_addr[15] = random() & 0xff;
+		verify_lookup(tables, tab, &addr);
+	}
+
+	for (i = 0; i < count; ++i) {
+		random_addr(&addr, i);
+		verify_lookup(tables, tab, &addr);
+	}
+}
+
+static void
+verify(ni_route_table_t *tables, unsigned int count)
+{
+	ni_route_table_t *tab;
+
+	ni_assert((tab = ni_route_tables_find(tables, RT_TABLE_MAIN)) != NULL);
+	verify_find_match(tables, tab);
+	verify_lookups(tables, tab, count);
+}
+
+static void
+test_can_reach(void)
+{
+	ni_route_table_t *tables = NULL;
+	ni_address_t *ap;
+	ni_sockaddr_t addr, gw;
+
+	ni_sockaddr_parse(&addr, "10.0.0.5", AF_INET);
+	ap = ni_address_new(AF_INET, 8, &addr, NULL);
+
+	ni_sockaddr_parse(&addr, "192.168.0.0", AF_INET);
+	ni_route_create(16, &addr, NULL, RT_TABLE_MAIN, &tables);
+	ni_sockaddr_parse(&addr, "192.168.1.0", AF_INET);
+	ni_sockaddr_parse(&gw, "10.0.0.1", AF_INET);
+	ni_route_create(24, &addr, &gw, RT_TABLE_MAIN, &tables);
+
+	/* in the prefix of the address */
+	ni_sockaddr_parse(&gw, "10.1.2.3", AF_INET);
+	ni_assert(ni_address_can_reach(ap, &gw, NULL));
+	ni_assert(ni_address_can_reach(ap, &gw, tables));
+	ni_assert(!ni_address_can_reach(NULL, &gw, tables));
+
+	/* covered by the device route */
+	ni_sockaddr_parse(&gw, "192.168.2.1", AF_INET);
+	ni_assert(!ni_address_can_reach(ap, &gw, NULL));
+	ni_assert(ni_address_can_reach(ap, &gw, tables));
+	ni_assert(ni_address_can_reach(NULL, &gw, tables));
+
+	/* the longest match is the route with a gateway */
+	ni_sockaddr_parse(&gw, "192.168.1.1", AF_INET);
+	ni_assert(!ni_address_can_reach(ap, &gw, tables));
+
+	ni_sockaddr_parse(&gw, "172.16.0.1", AF_INET);
+	ni_assert(!ni_address_can_reach(ap, &gw, tables));
+	ni_sockaddr_parse(&gw, "2001:db8::1", AF_INET6);
+	ni_assert(!ni_address_can_reach(ap, &gw, tables));
+
+	ni_route_tables_destroy(&tables);
+	ni_address_free(ap);
+}
+
+int
+main(int argc, char **argv)
+{
+	ni_route_table_t *tables = NULL, *tab;
+	ni_route_array_t orig = NI_ROUTE_ARRAY_INIT;
+	ni_route_array_t gone = NI_ROUTE_ARRAY_INIT;
+	unsigned int count = 1000, i;
+	ni_route_t *rp, *nrp;
+
+	if (argc > 1)
+		count = strtoul(argv[1], NULL, 0);
+
+	ni_init("route-test");
+	srandom(count);
+
+	for (i = 0; i < count; ++i)
+		create_route(&tables, i);
+	verify(tables, count);
+
+	/* replace each third route by one with another gateway */
+	tab = ni_route_tables_find(tables, RT_TABLE_MAIN);
+	for (i = 0; i < tab->routes.count; ++i)
+		ni_route_array_append(&orig, ni_route_ref(tab->routes.data[i]));
+	for (i = 0; i < orig.count; i += 3) {
+		rp = orig.data[i];
+		ni_assert(ni_route_tables_del_route(tables, rp));
+
+		nrp = ni_route_clone(rp);
+		if (nrp->family == AF_INET)
+			nrp->nh.gateway.sin.sin_addr.s_addr = htonl(0x0a000002);
+		else
+			nrp->nh.gateway.six.sin6_addr.s6_addr[15] = 2;
+		ni_assert(ni_route_tables_add_route(&tables, nrp));
+		ni_route_array_append(&gone, ni_route_ref(rp));
+	}
+	ni_route_array_destroy(&orig);
+	verify(tables, count);
+
+	/* the replaced routes must not be found in the index any longer */
+	for (i = 0; i < gone.count; ++i) {
+		rp = gone.data[i];
+		ni_assert(ni_route_tables_find_match(tables, rp, ni_route_equal) ==
+			ni_route_array_find_match(&tab->routes, rp, ni_route_equal));
+	}
+	ni_route_array_destroy(&gone);
+
+	/* remove every other route by index */
+	for (i = 0; i < tab->routes.count; ++i)
+		ni_route_table_delete(tab, i);
+	verify(tables, count);
+
+	ni_route_tables_destroy(&tables);
+
+	test_can_reach();
+
+	printf("ALL TEST SUCCESSFUL!\n");
+	return 0;
+}
@@ -0,0 +1,221 @@
+/**
+ *	Copyright (C) 2026 SUSE LLC
+ *
+ *	This program is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation; either version 2 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *	Description:
+ *		Test for the xml document cache, writing a cache file
+ *		for a document, then making the cache or the source file
+ *		invalid in various ways; the source has to be parsed again
+ *		and the cache file rewritten, while a valid cache file is
+ *		used as is:
+ *		* xml_document_read_cached()
+ *
+ *	Usage: xml-cache-test [directory]
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <wicked/util.h>
+#include <wicked/netinfo.h>
+#include <wicked/logging.h>
+#include <wicked/xml.h>
+
+static char		source[PATH_MAX];
+static char		srclink[PATH_MAX];
+static char		cache[PATH_MAX];
+
+static ni_bool_t
+cache_test_write(const char *path, const char *data)
+{
+	FILE *fp;
+
+	if (!(fp = fopen(path, "w")))
+		return FALSE;
+	fputs(data, fp);
+	return fclose(fp) == 0;
+}
+
+static ino_t
+cache_test_inode(void)
+{
+	struct stat stb;
+
+	return stat(cache, &stb) < 0 ? 0 : stb.st_ino;
+}
+
+/*
+ * Read @filename through the cache and compare it to the parsed source;
+ * @rewrite tells whether the cache is expected to be replaced.
+ */
+static void
+cache_test_read(const char *filename, ni_bool_t rewrite)
+{
+	xml_document_t *doc, *ref;
+	char *got = NULL, *exp = NULL;
+	ino_t before, after;
+
+	before = cache_test_inode();
+	doc = xml_document_read_cached(filename, cache);
+	after = cache_test_inode();
+	ref = xml_document_read(filename);
+
+	ni_assert(doc != NULL && ref != NULL);
+	got = xml_document_sprint(doc);
+	exp = xml_document_sprint(ref);
+	ni_assert(ni_string_eq(got, exp));
+
+	/* the cache file is written, replaced when invalid */
+	ni_assert(after != 0);
+	ni_assert(rewrite ? before != after : before == after);
+
+	ni_string_free(&got);
+	ni_string_free(&exp);
+	xml_document_free(doc);
+	xml_document_free(ref);
+}
+
+/*
+ * Overwrite @len bytes at @offset (from the end when negative)
+ */
+static void
+cache_test_patch(off_t offset, const char *data, size_t len)
+{
+	struct stat stb;
+	int fd;
+
+	ni_assert((fd = open(cache, O_WRONLY)) >= 0);
+	if (offset < 0) {
+		ni_assert(fstat(fd, &stb) == 0);
+		offset += stb.st_size;
+	}
+	ni_assert(pwrite(fd, data, len, offset) == (ssize_t)len);
+	close(fd);
+}
+
+static void
+cache_test_truncate(void)
+{
+	struct stat stb;
+
+	ni_assert(stat(cache, &stb) == 0);
+	ni_assert(truncate(cache, stb.st_size / 2) == 0);
+}
+
+int
+main(int argc, char **argv)
+{
+	static const char *doc1 =
+		"<schema>\n"
+		"  <define name=\"a\" class=\"dict\">\n"
+		"    <b type=\"uint32\"/>\n"
+		"    <c type=\"string\">text</c>\n"
+		"  </define>\n"
+		"</schema>\n";
+	static const char *doc2 =
+		"<schema>\n"
+		"  <define name=\"a\" class=\"dict\">\n"
+		"    <b type=\"uint32\"/>\n"
+		"    <c type=\"string\">TEXT</c>\n"
+		"  </define>\n"
+		"</schema>\n";
+	char tmpdir[] = "/tmp/xml-cache-test.XXXXXX";
+	const char *dir;
+	struct timespec ts[2];
+	ni_stringbuf_t deep = NI_STRINGBUF_INIT_DYNAMIC;
+	unsigned int i;
+
+	ni_init("xml-cache-test");
+	ni_log_level_set("error");
+
+	if (argc > 1)
+		dir = argv[1];
+	else if (!(dir = mkdtemp(tmpdir))) {
+		perror("mkdtemp");
+		return 1;
+	}
+
+	snprintf(source, sizeof(source), "%s/source.xml", dir);
+	snprintf(srclink, sizeof(srclink), "%s/linked.xml", dir);
+	snprintf(cache, sizeof(cache), "%s/source.cache", dir);
+	unlink(source);
+	unlink(srclink);
+	unlink(cache);
+
+	if (!cache_test_write(source, doc1)) {
+		perror(source);
+		return 1;
+	}
+
+	/* written by the first read, used as is by the next */
+	cache_test_read(source, TRUE);
+	cache_test_read(source, FALSE);
+
+	/* truncated and corrupt */
+	cache_test_truncate();
+	cache_test_read(source, TRUE);
+
+	cache_test_patch(-8, "\xff\xff\xff\xff\xff\xff\xff\xff", 8);
+	cache_test_read(source, TRUE);
+
+	/* magic and version */
+	cache_test_patch(0, "wickedxd", 8);
+	cache_test_read(source, TRUE);
+
+	cache_test_patch(8, "\xff", 1);
+	cache_test_read(source, TRUE);
+
+	/* same file, other path of the same length: only the path differs */
+	ni_assert(link(source, srclink) == 0);
+	cache_test_read(srclink, TRUE);
+	cache_test_read(source, TRUE);
+	unlink(srclink);
+
+	/* same size, other content and mtime */
+	ni_assert(cache_test_write(source, doc2));
+	ts[0].tv_sec = ts[1].tv_sec = 1;
+	ts[0].tv_nsec = ts[1].tv_nsec = 0;
+	utimensat(AT_FDCWD, source, ts, 0);
+	cache_test_read(source, TRUE);
+	cache_test_read(source, FALSE);
+
+	/* too deeply nested documents are not cached */
+	for (i = 0; i < 300; ++i)
+		ni_stringbuf_puts(&deep, "<a>");
+	for (i = 0; i < 300; ++i)
+		ni_stringbuf_puts(&deep, "</a>");
+	ni_stringbuf_puts(&deep, "\n");
+	ni_assert(cache_test_write(source, deep.string));
+	ni_stringbuf_destroy(&deep);
+	unlink(cache);
+	xml_document_free(xml_document_read_cached(source, cache));
+	ni_assert(cache_test_inode() == 0);
+
+	unlink(source);
+	unlink(cache);
+	if (dir == tmpdir)
+		rmdir(dir);
+
+	printf("ALL TEST SUCCESSFUL!\n");
+	return 0;
+}
@@ -1,23 +1,310 @@
 /*
  * Small test app for our XML routines
  *
+ * Without arguments, it checks the xml node model:
+ *  - arena documents recycle released nodes and stay alive while
+ *    any of their nodes is referenced from another tree
+ *  - interned element names are shared and refcounted
+ *  - the last child pointer, the child count and the child name
+ *    index stay consistent when the children are changed
+ *
  * Copyright (C) 2009-2010 Olaf Kirch <okir@suse.de>
  */
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <wicked/util.h>
+#include <wicked/logging.h>
 #include <wicked/xml.h>
 
+static void
+xml_test_arena(void)
+{
+	xml_document_t *doc;
+	xml_node_t *root, *node, *heap, *child;
+	const void *released;
+
+	doc = xml_document_new_arena();
+	root = xml_document_root(doc);
+	ni_assert(root->arena != NULL);
+
+	/* nodes below an arena node come from the arena */
+	node = xml_node_new("a", root);
+	ni_assert(node->arena == root->arena);
+
+	/* a released node is reused by the next one */
+	released = node;
+	ni_assert(xml_node_delete_child_node(root, node));
+	node = xml_node_new("b", root);
+	ni_assert((const void *)node == released);
+	ni_assert(node->arena == root->arena);
+
+	/* reparented into a heap tree, the node keeps the arena alive */
+	heap = xml_node_new("heap", NULL);
+	ni_assert(heap->arena == NULL);
+	xml_node_reparent(heap, node);
+	ni_assert(node->parent == heap && root->children == NULL);
+
+	child = xml_node_new("c", node);
+	ni_assert(child->arena == root->arena);
+	xml_document_free(doc);
+
+	ni_assert(xml_node_get_child(heap, "b") == node);
+	ni_assert(xml_node_get_child(node, "c") == child);
+	ni_assert(ni_string_eq(child->name, "c"));
+
+	child = xml_node_new("d", heap);
+	ni_assert(child->arena == NULL);
+
+	/* releases the arena with its last node */
+	xml_node_free(heap);
+}
+
+static void
+xml_test_names(void)
+{
+	xml_node_t *a, *b, *c;
+
+	a = xml_node_new("xml-test-name", NULL);
+	b = xml_node_new("xml-test-name", NULL);
+	ni_assert(a->name == b->name);
+
+	/* the name stays while other nodes use it */
+	xml_node_free(a);
+	ni_assert(ni_string_eq(b->name, "xml-test-name"));
+	c = xml_node_new("xml-test-name", NULL);
+	ni_assert(c->name == b->name);
+
+	xml_node_set_name(b, "xml-test-other");
+	ni_assert(ni_string_eq(b->name, "xml-test-other"));
+	ni_assert(ni_string_eq(c->name, "xml-test-name"));
+	xml_node_set_name(c, "xml-test-other");
+	ni_assert(c->name == b->name);
+
+	/* renaming the last user to its own name must not release it */
+	xml_node_free(b);
+	xml_node_set_name(c, c->name);
+	ni_assert(ni_string_eq(c->name, "xml-test-other"));
+	xml_node_free(c);
+
+	/* last user gone, a new node gets a valid name again */
+	a = xml_node_new("xml-test-other", NULL);
+	ni_assert(ni_string_eq(a->name, "xml-test-other"));
+	xml_node_free(a);
+}
+
+/*
+ * Compare the children to what xml.c keeps about them, and the
+ * (maybe indexed) lookups to a scan of the children
+ */
+static void
+xml_test_verify_children(const xml_node_t *node)
+{
+	const xml_node_t *child, *scan, *last = NULL;
+	unsigned int count = 0;
+
+	for (child = node->children; child; child = child->next) {
+		ni_assert(child->parent == node);
+		last = child;
+		count++;
+	}
+	ni_assert(node->nchildren == count);
+	ni_assert(node->last == last);
+
+	for (child = node->children; child; child = child->next) {
+		for (scan = node->children; scan; scan = scan->next) {
+			if (ni_string_eq(scan->name, child->name))
+				break;
+		}
+		ni_assert(xml_node_get_child(node, child->name) == scan);
+	}
+	ni_assert(xml_node_get_child(node, "xml-test-none") == NULL);
+}
+
+static void
+xml_test_children(unsigned int count)
+{
+	xml_node_t *parent, *other, *merge, *node, *child;
+	char name[32];
+	unsigned int i;
+
+	parent = xml_node_new("parent", NULL);
+	other = xml_node_new("other", NULL);
+	for (i = 0; i < count; ++i) {
+		snprintf(name, sizeof(name), "c%u", i % 5);
+		xml_node_new(name, parent);
+	}
+	xml_test_verify_children(parent);
+
+	/* appending keeps the index built by the lookups */
+	node = xml_node_new("appended", parent);
+	ni_assert(xml_node_get_child(parent, "appended") == node);
+	xml_test_verify_children(parent);
+
+	/* replaced children are removed, the new one is appended */
+	node = xml_node_new("c1", NULL);
+	ni_assert(xml_node_replace_child(parent, node));
+	ni_assert(parent->last == node);
+	xml_test_verify_children(parent);
+
+	node = xml_node_new("after-replace", parent);
+	ni_assert(parent->last == node);
+	xml_test_verify_children(parent);
+
+	ni_assert(xml_node_delete_child(parent, "c2"));
+	ni_assert(xml_node_get_child(parent, "c2") == NULL);
+	xml_test_verify_children(parent);
+
+	/* detach the first and the last child */
+	node = parent->children;
+	xml_node_detach(node);
+	xml_test_verify_children(parent);
+	xml_node_free(node);
+
+	node = parent->last;
+	xml_node_detach(node);
+	xml_test_verify_children(parent);
+	xml_node_free(node);
+
+	/* move a child away and back again */
+	node = xml_node_get_child(parent, "c3");
+	xml_node_reparent(other, node);
+	xml_test_verify_children(parent);
+	xml_test_verify_children(other);
+	xml_node_reparent(parent, node);
+	ni_assert(parent->last == node);
+	xml_test_verify_children(parent);
+	xml_test_verify_children(other);
+
+	/* merge adds the children of names not present yet */
+	merge = xml_node_new("merge", NULL);
+	xml_node_new("c0", merge);
+	xml_node_new("c2", merge);
+	xml_node_merge(parent, merge);
+	xml_node_free(merge);
+	ni_assert(xml_node_get_child(parent, "c2") == parent->last);
+	xml_test_verify_children(parent);
+
+	/* rename a child in the middle */
+	for (node = parent->children, i = 0; i < parent->nchildren / 2; ++i)
+		node = node->next;
+	xml_node_set_name(node, "renamed");
+	ni_assert(xml_node_get_child(parent, "renamed") == node);
+	xml_test_verify_children(parent);
+
+	/* and iterate over all children of a name */
+	for (i = 0, child = NULL; (child = xml_node_get_next_child(parent, "c0", child)); ++i)
+		ni_assert(ni_string_eq(child->name, "c0"));
+	for (node = parent->children; node; node = node->next)
+		i -= ni_string_eq(node->name, "c0");
+	ni_assert(i == 0);
+
+	xml_node_free(parent);
+	xml_node_free(other);
+}
+
+/*
+ * Append @count children to a node and look up each of them
+ */
+static int
+xml_test_children_benchmark(unsigned int count)
+{
+	struct timespec begin, end;
+	xml_node_t *parent;
+	char name[32];
+	unsigned int i, found = 0;
+	double ms;
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	parent = xml_node_new("parent", NULL);
+	for (i = 0; i < count; ++i) {
+		snprintf(name, sizeof(name), "child%u", i);
+		xml_node_new(name, parent);
+	}
+	for (i = 0; i < count; ++i) {
+		snprintf(name, sizeof(name), "child%u", i);
+		if (xml_node_get_child(parent, name))
+			found++;
+	}
+	xml_node_free(parent);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	ms = (end.tv_sec - begin.tv_sec) * 1000.0 +
+		(end.tv_nsec - begin.tv_nsec) / 1000000.0;
+	printf("appended and looked up %u children in %.3f ms\n", count, ms);
+	return found == count ? 0 : 1;
+}
+
+/*
+ * Parse the files @rounds times and report the parser throughput
+ */
+static int
+xml_test_benchmark(unsigned int rounds, int argc, char **argv)
+{
+	unsigned long long bytes = 0;
+	struct timespec begin, end;
+	unsigned int r;
+	double ms;
+	int i;
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	for (r = 0; r < rounds; ++r) {
+		for (i = 0; i < argc; ++i) {
+			xml_document_t *doc;
+			struct stat stb;
+
+			if (!(doc = xml_document_read(argv[i]))) {
+				fprintf(stderr, "Error parsing %s\n", argv[i]);
+				return 1;
+			}
+			xml_document_free(doc);
+
+			if (stat(argv[i], &stb) == 0)
+				bytes += stb.st_size;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	ms = (end.tv_sec - begin.tv_sec) * 1000.0 +
+		(end.tv_nsec - begin.tv_nsec) / 1000000.0;
+	printf("parsed %u files %u times, %llu bytes in %.3f ms: %.2f MB/s\n",
+			argc, rounds, bytes, ms,
+			ms > 0 ? bytes / ms / 1000.0 : 0.0);
+	return 0;
+}
+
 int
 main(int argc, char **argv)
 {
 	const char *filename;
 	xml_document_t *doc;
 
+	if (argc > 3 && !strcmp(argv[1], "--bench"))
+		return xml_test_benchmark(strtoul(argv[2], NULL, 0), argc - 3, argv + 3);
+
+	if (argc == 3 && !strcmp(argv[1], "--bench-children"))
+		return xml_test_children_benchmark(strtoul(argv[2], NULL, 0));
+
+	if (argc == 1) {
+		xml_test_arena();
+		xml_test_names();
+		/* below and above the size nodes get a child index at */
+		xml_test_children(8);
+		xml_test_children(100);
+		printf("ALL TEST SUCCESSFUL!\n");
+		return 0;
+	}
+
 	if (argc != 2) {
-		fprintf(stderr, "Usage: xml-test filename\n");
+		fprintf(stderr, "Usage: xml-test [filename]\n"
+				"       xml-test --bench rounds filename...\n"
+				"       xml-test --bench-children count\n");
 		return 1;
 	}
 	filename = argv[1];
@@ -32,4 +319,3 @@ main(int argc, char **argv)
 	xml_document_free(doc);
 	return 0;
 }
-